@@ -1,37 +1,71 @@
 #version 330 core
-
-in vec2 TexCoord;
+// Screen-space light shafts (drawn with fullscreen.vert at 1/2 or 1/4 resolution): marches
+// from each pixel toward uLightScreenPos through volumetric_source.frag's output. The sample
+// count follows the length of the ray in target pixels, the start is dithered per pixel and
+// per frame, and the result is blended with the reprojected history, so a handful of samples
+// converge to a smooth result. Alpha carries linear depth for the history test and the
+// bilateral upsample in tonemap_fxaa.frag.
+in vec2 vUV;
 out vec4 FragColor;
 
-uniform sampler2D uSceneTexture;
-uniform sampler2D uDepthTexture;
+uniform sampler2D uSource;
+uniform sampler2D uHistory;
+uniform sampler2D uDepthTexture;    // full resolution
 uniform vec2 uLightScreenPos;
 uniform float uExposure;
-uniform float uDecay;
+uniform float uDecay;               // per step of the reference 100-sample march
 uniform float uDensity;
-uniform float uWeight;
+uniform float uWeight;              // per step of the reference 100-sample march
+uniform vec2 uTargetSize;
+uniform vec2 uDepthParams;          // near, far
+uniform mat4 uReproject;            // this frame's clip space to last frame's
+uniform float uFrame;
+uniform float uHistoryWeight;       // 0 when there is no usable history
+
+const float REFERENCE_SAMPLES = 100.0;
+const float MIN_SAMPLES = 4.0;
+const float MAX_SAMPLES = 16.0;
+const float PIXELS_PER_SAMPLE = 6.0;
 
-const int NUM_SAMPLES = 100;
+float InterleavedGradientNoise(vec2 pixel) {
+    return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+float LinearDepth(float depth) {
+    return uDepthParams.x * uDepthParams.y / (uDepthParams.y - depth * (uDepthParams.y - uDepthParams.x));
+}
 
 void main() {
-    vec2 deltaTexCoord = (TexCoord - uLightScreenPos);
-    deltaTexCoord *= 1.0 / float(NUM_SAMPLES) * uDensity;
-    
-    vec2 texCoord = TexCoord;
+    vec2 ray = (vUV - uLightScreenPos) * uDensity;
+    float samples = clamp(ceil(length(ray * uTargetSize) / PIXELS_PER_SAMPLE), MIN_SAMPLES, MAX_SAMPLES);
+    vec2 deltaTexCoord = ray / samples;
+
+    // Fewer, longer steps: decay and weight are rescaled so the total matches the reference
+    float stepScale = REFERENCE_SAMPLES / samples;
+    float stepDecay = pow(uDecay, stepScale);
+    float dither = fract(InterleavedGradientNoise(gl_FragCoord.xy) + uFrame * 0.618034);
+
+    vec2 texCoord = vUV - deltaTexCoord * dither;
     float illuminationDecay = 1.0;
     vec3 color = vec3(0.0);
-    
-    for(int i = 0; i < NUM_SAMPLES; i++) {
+    for (int i = 0; i < int(samples); i++) {
+        color += texture(uSource, texCoord).rgb * illuminationDecay;
+        illuminationDecay *= stepDecay;
         texCoord -= deltaTexCoord;
-        vec3 sample = texture(uSceneTexture, texCoord).rgb;
-        
-        sample *= illuminationDecay * uWeight;
-        color += sample;
-        illuminationDecay *= uDecay;
     }
-    
-    color *= uExposure;
-    
-    vec3 sceneColor = texture(uSceneTexture, TexCoord).rgb;
-    FragColor = vec4(sceneColor + color, 1.0);
-}
\ No newline at end of file
+    color *= uWeight * stepScale * uExposure;
+
+    // Temporal accumulation; history that reprojects off screen or onto a different surface
+    // is dropped
+    float depth = texture(uDepthTexture, vUV).r;
+    float linearDepth = LinearDepth(depth);
+    vec4 previous = uReproject * vec4(vec3(vUV, depth) * 2.0 - 1.0, 1.0);
+    vec2 previousUV = previous.xy / previous.w * 0.5 + 0.5;
+    vec4 history = texture(uHistory, previousUV);
+    float historyWeight = uHistoryWeight;
+    if (any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0))) ||
+        abs(history.a - previous.w) > 0.1 * previous.w) {
+        historyWeight = 0.0;
+    }
+    FragColor = vec4(mix(color, history.rgb, historyWeight), linearDepth);
+}
@@ -2,53 +2,105 @@
 in vec3 vPos;
 in vec3 vNormal;
 in vec2 vTexCoord;
+flat in vec4 vInstColor;
+flat in vec2 vInstSurface;
+in vec4 vLightSpacePos;
 
 out vec4 FragColor;
 
-uniform sampler2D uTexture;
-uniform bool uUseTexture;
-uniform vec3 uBaseColor;
-uniform float uEmissive;
-uniform vec3 uViewPos;
+uniform sampler2DArray uTextures;      // surface textures, see TextureArray
+uniform sampler2DShadow uShadowMap;     // light 0, see ShadowMap
 
-// Light structure
-struct Light {
-    vec3 position;
-    vec3 color;
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
 };
 
-uniform Light uL1;
-uniform Light uL2;
+// Blinn-Phong material table (RenderMaterial in UniformBlocks.h, binding 1);
+// each row is (ambient, diffuse, specular coefficient, shininess)
+layout(std140) uniform MaterialTable {
+    vec4 uMaterials[64];
+};
+
+// Clustered point lights (LightClusters): per-cluster ranges into an index list of lights
+layout(std140) uniform ClusterData {
+    ivec4 uClusterGrid;     // xyz = clusters per axis, w = lights (0 = none)
+    vec4 uClusterParams;    // xy = depth slice scale/bias on log(view depth), zw = tile size in pixels
+};
+uniform samplerBuffer uClusterLights;       // two texels per light: position + radius, color
+uniform usamplerBuffer uClusterRanges;      // per cluster: first index, count
+uniform usamplerBuffer uClusterIndices;
 
-// Blinn-Phong material properties
-uniform float uKa;  // Ambient coefficient
-uniform float uKd;  // Diffuse coefficient
-uniform float uKs;  // Specular coefficient
-uniform float uShine;  // Shininess/specular exponent
+// Fraction of light 0 reaching the fragment: four hardware-filtered taps
+float ShadowFactor(vec3 normal, vec3 lightDir) {
+    vec3 p = vLightSpacePos.xyz / vLightSpacePos.w * 0.5 + 0.5;
+    if (p.z > 1.0) return 1.0;
 
-// Blinn-Phong lighting calculation
-vec3 CalculateBlinnPhong(vec3 lightPos, vec3 lightColor, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor) {
+    float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
+    vec2 texel = 1.0 / vec2(textureSize(uShadowMap, 0));
+    float lit = texture(uShadowMap, vec3(p.xy + vec2(-1.0, -1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(1.0, -1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(-1.0, 1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(1.0, 1.0) * texel, p.z - bias));
+    return lit * 0.25;
+}
+
+// Blinn-Phong lighting calculation; shadow scales the diffuse and specular terms
+vec3 CalculateBlinnPhong(vec3 lightPos, vec3 lightColor, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, vec4 material, float shadow) {
     // Ambient component (constant)
-    vec3 ambient = uKa * lightColor * baseColor;
+    vec3 ambient = material.x * lightColor * baseColor;
     
     // Direction from fragment to light
     vec3 lightDir = normalize(lightPos - fragPos);
     
     // Diffuse component (Lambertian reflectance)
     float diff = max(dot(normal, lightDir), 0.0);
-    vec3 diffuse = uKd * diff * lightColor * baseColor;
+    vec3 diffuse = material.y * diff * lightColor * baseColor;
     
     // Specular component (Blinn-Phong)
     // Use halfway vector instead of reflection vector (more efficient)
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(normal, halfwayDir), 0.0), uShine);
-    vec3 specular = uKs * spec * lightColor;
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.w);
+    vec3 specular = material.z * spec * lightColor;
     
     // Attenuation (distance falloff)
     float distance = length(lightPos - fragPos);
     float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
     
-    return (ambient + diffuse + specular) * attenuation;
+    return (ambient + shadow * (diffuse + specular)) * attenuation;
+}
+
+// Point lights of this fragment's cluster, with the same windowed falloff as light_volume.frag
+vec3 ClusteredLights(vec3 normal, vec3 viewDir, vec3 baseColor, vec4 material) {
+    float depth = -(uView * vec4(vPos, 1.0)).z;
+    int slice = clamp(int(log(max(depth, 1e-4)) * uClusterParams.x + uClusterParams.y), 0, uClusterGrid.z - 1);
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / uClusterParams.zw), uClusterGrid.xy - 1);
+    uvec2 range = texelFetch(uClusterRanges, (slice * uClusterGrid.y + tile.y) * uClusterGrid.x + tile.x).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; ++i) {
+        int light = int(texelFetch(uClusterIndices, int(range.x + i)).r);
+        vec4 posRadius = texelFetch(uClusterLights, light * 2);
+        vec3 color = texelFetch(uClusterLights, light * 2 + 1).rgb;
+
+        vec3 toLight = posRadius.xyz - vPos;
+        float distance = length(toLight);
+        if (distance >= posRadius.w) continue;
+        vec3 lightDir = toLight / distance;
+        float diff = max(dot(normal, lightDir), 0.0);
+        float spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), material.w);
+        float x = distance / posRadius.w;
+        float window = clamp(1.0 - x * x * x * x, 0.0, 1.0);
+        float attenuation = window * window / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+        result += (material.y * diff * baseColor + material.z * spec) * color * attenuation;
+    }
+    return result;
 }
 
 void main() {
@@ -56,28 +108,37 @@ void main() {
     vec3 norm = normalize(vNormal);
     
     // View direction (from fragment to camera)
-    vec3 viewDir = normalize(uViewPos - vPos);
+    vec3 viewDir = normalize(uViewPos.xyz - vPos);
     
-    // Get base color (from texture or uniform)
+    // Get base color (from the instance's texture layer or color)
+    float layer = vInstSurface.x;
     vec3 baseColor;
-    if (uUseTexture) {
-        vec3 texColor = texture(uTexture, vTexCoord).rgb;
+    if (layer >= 0.0) {
+        vec3 texColor = texture(uTextures, vec3(vTexCoord, layer)).rgb;
         baseColor = texColor;
     } else {
-        baseColor = uBaseColor;
+        baseColor = vInstColor.rgb;
     }
     
-    // Calculate lighting from both lights using Blinn-Phong model
+    // Calculate lighting from the frame's lights using Blinn-Phong model
+    vec4 material = uMaterials[int(vInstSurface.y)];
     vec3 result = vec3(0.0);
-    result += CalculateBlinnPhong(uL1.position, uL1.color, norm, vPos, viewDir, baseColor);
-    result += CalculateBlinnPhong(uL2.position, uL2.color, norm, vPos, viewDir, baseColor);
+    for (int i = 0; i < uLightCount.x; ++i) {
+        float shadow = 1.0;
+        if (i == 0 && uLightCount.y != 0) {
+            shadow = ShadowFactor(norm, normalize(uLightPosition[0].xyz - vPos));
+        }
+        result += CalculateBlinnPhong(uLightPosition[i].xyz, uLightColor[i].rgb, norm, vPos, viewDir, baseColor, material, shadow);
+    }
+    if (uClusterGrid.w > 0) result += ClusteredLights(norm, viewDir, baseColor, material);
     
     // Add emissive component (for glowing objects like power-ups)
-    vec3 emissive = uEmissive * baseColor;
+    vec3 emissive = vInstColor.a * baseColor;
     result += emissive;
     
-    // Gamma correction for better visual quality
-    result = pow(result, vec3(1.0/2.2));
+    // Gamma correction for better visual quality (deferred frames draw into a linear target
+    // and apply it in resolve.frag)
+    if (uLightCount.z == 0) result = pow(result, vec3(1.0/2.2));
     
     FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -2,19 +2,59 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 
-uniform mat4 uModel, uView, uProj;
+// Every scene draw is instanced (RenderQueue): model matrix, color/emissive, texture layer
+// and material come per instance
+layout(location=2) in mat4 aInstModel;
+layout(location=6) in vec4 aInstColor;
+layout(location=7) in vec4 aInstSurface;   // x = texture array layer (< 0 = none), y = material row
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
+
+// Packed meshes store snorm16 positions relative to their bounds and
+// octahedral normals in aNormal.xy; float meshes keep the defaults
+uniform vec3 uPosScale = vec3(1.0);
+uniform vec3 uPosOffset = vec3(0.0);
+uniform bool uOctNormals = false;
 
 out vec3 vPos;
 out vec3 vNormal;
 out vec2 vTexCoord;
+flat out vec4 vInstColor;
+flat out vec2 vInstSurface;
+out vec4 vLightSpacePos;
+
+vec3 octDecode(vec2 e){
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main(){
-    vec4 worldPos = uModel * vec4(aPos, 1.0);
+    vec3 pos = aPos * uPosScale + uPosOffset;
+    vec3 normal = uOctNormals ? octDecode(aNormal.xy) : aNormal;
+
+    mat4 model = aInstModel;
+    vInstColor = aInstColor;
+    vInstSurface = aInstSurface.xy;
+
+    vec4 worldPos = model * vec4(pos, 1.0);
     vPos = worldPos.xyz;
+    vLightSpacePos = uLightSpace * worldPos;
     
     // Proper normal transformation (handles non-uniform scaling)
-    mat3 normalMatrix = mat3(transpose(inverse(uModel)));
-    vNormal = normalize(normalMatrix * aNormal);
+    mat3 normalMatrix = mat3(transpose(inverse(model)));
+    vNormal = normalize(normalMatrix * normal);
     
     // Generate better texture coordinates based on position
     // For walls and floor, use world-space XZ coordinates
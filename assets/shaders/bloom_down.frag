@@ -0,0 +1,31 @@
+#version 330 core
+// One step of the bloom downsample chain (drawn with fullscreen.vert into a target half the
+// size of the source). Four bilinear taps one source texel off the center average a 4x4
+// block, which is enough to keep small highlights from flickering between levels.
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uTexel;            // 1 / source size
+uniform vec4 uThreshold;        // x = threshold, y = knee, z != 0 = apply (first level only)
+
+// Soft-knee threshold: below threshold - knee nothing passes, above threshold everything over
+// it does, with a quadratic blend in between
+vec3 Prefilter(vec3 color) {
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - uThreshold.x + uThreshold.y, 0.0, 2.0 * uThreshold.y);
+    soft = soft * soft / (4.0 * uThreshold.y + 1e-4);
+    float contribution = max(soft, brightness - uThreshold.x) / max(brightness, 1e-4);
+    return color * contribution;
+}
+
+void main() {
+    vec3 color = texture(uSource, vUV + uTexel * vec2(-1.0, -1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(1.0, -1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(-1.0, 1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(1.0, 1.0)).rgb;
+    color *= 0.25;
+    if (uThreshold.z != 0.0) color = Prefilter(color);
+    FragColor = vec4(color, 1.0);
+}
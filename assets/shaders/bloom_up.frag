@@ -0,0 +1,22 @@
+#version 330 core
+// One step of the bloom upsample chain: a 3x3 tent of the smaller level, blended additively
+// (GL_ONE, GL_ONE) onto the next larger one
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uTexel;            // 1 / source size
+
+void main() {
+    vec3 color = texture(uSource, vUV).rgb * 4.0;
+    color += texture(uSource, vUV + uTexel * vec2(-1.0, 0.0)).rgb * 2.0;
+    color += texture(uSource, vUV + uTexel * vec2(1.0, 0.0)).rgb * 2.0;
+    color += texture(uSource, vUV + uTexel * vec2(0.0, -1.0)).rgb * 2.0;
+    color += texture(uSource, vUV + uTexel * vec2(0.0, 1.0)).rgb * 2.0;
+    color += texture(uSource, vUV + uTexel * vec2(-1.0, -1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(1.0, -1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(-1.0, 1.0)).rgb;
+    color += texture(uSource, vUV + uTexel * vec2(1.0, 1.0)).rgb;
+    FragColor = vec4(color / 16.0, 1.0);
+}
@@ -0,0 +1,92 @@
+#version 330 core
+// Deferred pass for the FrameData lights (drawn with fullscreen.vert): the same Blinn-Phong
+// and light 0 shadow as basic.frag, evaluated once per pixel from the G-buffer, plus emissive.
+// Output is linear; resolve.frag applies the gamma.
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uGAlbedo;
+uniform sampler2D uGNormal;
+uniform sampler2D uGDepth;
+uniform sampler2DShadow uShadowMap;     // light 0, see ShadowMap
+uniform mat4 uInvViewProj;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
+
+// Blinn-Phong material table (RenderMaterial in UniformBlocks.h, binding 1)
+layout(std140) uniform MaterialTable {
+    vec4 uMaterials[64];
+};
+
+// World position from the depth buffer
+vec3 WorldPosition(vec2 uv, float depth) {
+    vec4 p = uInvViewProj * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return p.xyz / p.w;
+}
+
+// Fraction of light 0 reaching the point: four hardware-filtered taps
+float ShadowFactor(vec3 pos, vec3 normal, vec3 lightDir) {
+    vec4 lightSpacePos = uLightSpace * vec4(pos, 1.0);
+    vec3 p = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+    if (p.z > 1.0) return 1.0;
+
+    float bias = max(0.002 * (1.0 - dot(normal, lightDir)), 0.0005);
+    vec2 texel = 1.0 / vec2(textureSize(uShadowMap, 0));
+    float lit = texture(uShadowMap, vec3(p.xy + vec2(-1.0, -1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(1.0, -1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(-1.0, 1.0) * texel, p.z - bias));
+    lit += texture(uShadowMap, vec3(p.xy + vec2(1.0, 1.0) * texel, p.z - bias));
+    return lit * 0.25;
+}
+
+vec3 CalculateBlinnPhong(vec3 lightPos, vec3 lightColor, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor, vec4 material, float shadow) {
+    vec3 ambient = material.x * lightColor * baseColor;
+
+    vec3 lightDir = normalize(lightPos - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = material.y * diff * lightColor * baseColor;
+
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.w);
+    vec3 specular = material.z * spec * lightColor;
+
+    float distance = length(lightPos - fragPos);
+    float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+
+    return (ambient + shadow * (diffuse + specular)) * attenuation;
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(uGDepth, pixel, 0).r;
+    if (depth >= 1.0) discard;      // background keeps the clear color
+
+    vec4 albedo = texelFetch(uGAlbedo, pixel, 0);
+    vec4 normalEmissive = texelFetch(uGNormal, pixel, 0);
+    vec3 norm = normalize(normalEmissive.xyz);
+    vec3 pos = WorldPosition(vUV, depth);
+    vec3 viewDir = normalize(uViewPos.xyz - pos);
+    vec4 material = uMaterials[int(albedo.a * 255.0 + 0.5)];
+
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < uLightCount.x; ++i) {
+        float shadow = 1.0;
+        if (i == 0 && uLightCount.y != 0) {
+            shadow = ShadowFactor(pos, norm, normalize(uLightPosition[0].xyz - pos));
+        }
+        result += CalculateBlinnPhong(uLightPosition[i].xyz, uLightColor[i].rgb, norm, pos, viewDir, albedo.rgb, material, shadow);
+    }
+    result += normalEmissive.w * albedo.rgb;
+
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+// G-buffer fill for the deferred path; takes basic.vert's outputs like basic.frag, but stores the surface instead of lighting it (see GBuffer in PostProcess.h)
+in vec3 vPos;
+in vec3 vNormal;
+in vec2 vTexCoord;
+flat in vec4 vInstColor;
+flat in vec2 vInstSurface;
+
+layout(location=0) out vec4 gAlbedo;    // rgb base color, a = material row / 255
+layout(location=1) out vec4 gNormal;    // xyz world normal, w = emissive
+
+uniform sampler2DArray uTextures;
+
+void main() {
+    float layer = vInstSurface.x;
+    int materialRow = int(vInstSurface.y);
+    vec3 baseColor;
+    if (layer >= 0.0) {
+        baseColor = texture(uTextures, vec3(vTexCoord, layer)).rgb;
+    } else {
+        baseColor = vInstColor.rgb;
+    }
+
+    // Double-sided draws light their back faces like front faces
+    vec3 normal = normalize(vNormal);
+    if (!gl_FrontFacing) normal = -normal;
+
+    gAlbedo = vec4(baseColor, float(materialRow) / 255.0);
+    gNormal = vec4(normal, vInstColor.a);
+}
@@ -0,0 +1,58 @@
+#version 330 core
+// Adds one point light to the pixels its volume covers (blended GL_ONE, GL_ONE)
+flat in vec4 vLightPosRadius;
+flat in vec3 vLightColor;
+
+out vec4 FragColor;
+
+uniform sampler2D uGAlbedo;
+uniform sampler2D uGNormal;
+uniform sampler2D uGDepth;
+uniform mat4 uInvViewProj;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
+
+// Blinn-Phong material table (RenderMaterial in UniformBlocks.h, binding 1)
+layout(std140) uniform MaterialTable {
+    vec4 uMaterials[64];
+};
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(uGDepth, pixel, 0).r;
+    if (depth >= 1.0) discard;
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(uGDepth, 0));
+    vec4 p = uInvViewProj * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 pos = p.xyz / p.w;
+
+    vec3 toLight = vLightPosRadius.xyz - pos;
+    float distance = length(toLight);
+    if (distance >= vLightPosRadius.w) discard;
+
+    vec4 albedo = texelFetch(uGAlbedo, pixel, 0);
+    vec3 normal = normalize(texelFetch(uGNormal, pixel, 0).xyz);
+    vec4 material = uMaterials[int(albedo.a * 255.0 + 0.5)];
+
+    vec3 lightDir = toLight / distance;
+    vec3 viewDir = normalize(uViewPos.xyz - pos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    float spec = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), material.w);
+
+    // The frame lights' falloff, windowed so it reaches zero at the radius
+    float x = distance / vLightPosRadius.w;
+    float window = clamp(1.0 - x * x * x * x, 0.0, 1.0);
+    float attenuation = window * window / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+
+    vec3 color = (material.y * diff * albedo.rgb + material.z * spec) * vLightColor * attenuation;
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+// One instance per deferred point light: a unit sphere scaled to the light's radius
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec4 aLightPosRadius;
+layout(location=2) in vec4 aLightColor;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
+
+flat out vec4 vLightPosRadius;
+flat out vec3 vLightColor;
+
+void main() {
+    vLightPosRadius = aLightPosRadius;
+    vLightColor = aLightColor.rgb;
+    vec3 worldPos = aLightPosRadius.xyz + aPos * aLightPosRadius.w;
+    gl_Position = uProj * uView * vec4(worldPos, 1.0);
+}
@@ -27,10 +27,16 @@ uniform bool uUseRoughnessMap;
 uniform bool uUseAOMap;
 
 // Lighting
-uniform vec3 uCamPos;
-uniform vec3 uLightPositions[4];
-uniform vec3 uLightColors[4];
-uniform int uNumLights;
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
 
 // Normal Distribution Function (GGX/Trowbridge-Reitz)
 float DistributionGGX(vec3 N, vec3 H, float roughness) {
@@ -95,7 +101,7 @@ void main() {
         N = normalize(fs_in.TBN[2]);
     }
     
-    vec3 V = normalize(uCamPos - fs_in.FragPos);
+    vec3 V = normalize(uViewPos.xyz - fs_in.FragPos);
     
     // Calculate reflectance at normal incidence
     vec3 F0 = vec3(0.04);
@@ -103,12 +109,12 @@ void main() {
     
     // Reflectance equation
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < uNumLights; ++i) {
-        vec3 L = normalize(uLightPositions[i] - fs_in.FragPos);
+    for(int i = 0; i < uLightCount.x; ++i) {
+        vec3 L = normalize(uLightPosition[i].xyz - fs_in.FragPos);
         vec3 H = normalize(V + L);
-        float distance = length(uLightPositions[i] - fs_in.FragPos);
+        float distance = length(uLightPosition[i].xyz - fs_in.FragPos);
         float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = uLightColors[i] * attenuation;
+        vec3 radiance = uLightColor[i].rgb * attenuation;
         
         // Cook-Torrance BRDF
         float NDF = DistributionGGX(N, H, roughness);
@@ -13,8 +13,17 @@ out VS_OUT {
 } vs_out;
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
 
 void main() {
     vec4 worldPos = uModel * vec4(aPos, 1.0);
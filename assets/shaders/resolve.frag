@@ -0,0 +1,12 @@
+#version 330 core
+// Writes the deferred light target to the screen with the gamma basic.frag applies itself
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uLight;
+
+void main() {
+    vec3 color = texture(uLight, vUV).rgb;
+    FragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
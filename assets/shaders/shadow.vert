@@ -2,9 +2,23 @@
 
 layout(location = 0) in vec3 aPos;
 
-uniform mat4 uLightSpaceMatrix;
-uniform mat4 uModel;
+// Instanced like the scene draws (RenderQueue), with the same packed-position decode
+layout(location = 2) in mat4 aInstModel;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
+
+uniform vec3 uPosScale = vec3(1.0);
+uniform vec3 uPosOffset = vec3(0.0);
 
 void main() {
-    gl_Position = uLightSpaceMatrix * uModel * vec4(aPos, 1.0);
+    gl_Position = uLightSpace * aInstModel * vec4(aPos * uPosScale + uPosOffset, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#version 330 core
+// Final post pass (drawn with fullscreen.vert into the default framebuffer): adds the bloom
+// and light shafts, tonemaps, runs a reduced FXAA on the tonemapped taps and applies the
+// gamma, so the HDR scene is read once per tap and no LDR intermediate target is needed.
+// When the scene was rendered below the output size the taps are bilinear upscales, and a
+// contrast-limited sharpen restores some of the lost detail.
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uScene;       // linear HDR
+uniform sampler2D uBloom;       // half resolution, bilinear
+uniform vec2 uTexel;            // 1 / scene size (may be smaller than the output)
+uniform float uExposure;
+uniform float uBloomStrength;
+uniform sampler2D uDepth;
+uniform sampler2D uShafts;      // VolumetricLight.frag output, a = linear depth
+uniform vec2 uShaftSize;        // 0 = no shafts this frame
+uniform vec2 uDepthParams;      // near, far
+uniform float uSharpness;       // 0 at native resolution
+
+const float kReduceMin = 1.0 / 128.0;
+const float kReduceMul = 1.0 / 8.0;
+const float kSpanMax = 8.0;
+const vec3 kLuma = vec3(0.299, 0.587, 0.114);
+
+// ACES filmic fit (Narkowicz), then gamma
+vec3 Tonemap(vec3 color) {
+    color *= uExposure;
+    color = clamp((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14), 0.0, 1.0);
+    return pow(color, vec3(1.0 / 2.2));
+}
+
+// Depth-aware upsample of the low-resolution shafts: bilinear weights, scaled down for texels
+// whose depth differs from this pixel's so shafts do not bleed across silhouettes
+vec3 Shafts() {
+    if (uShaftSize.x == 0.0) return vec3(0.0);
+    float n = uDepthParams.x, f = uDepthParams.y;
+    float depth = n * f / (f - texture(uDepth, vUV).r * (f - n));
+    vec2 p = vUV * uShaftSize - 0.5;
+    vec2 t = fract(p);
+    ivec2 base = ivec2(floor(p));
+    ivec2 maxTexel = ivec2(uShaftSize) - 1;
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        vec4 s = texelFetch(uShafts, clamp(base + offset, ivec2(0), maxTexel), 0);
+        vec2 bilinear = mix(1.0 - t, t, vec2(offset));
+        float weight = bilinear.x * bilinear.y / (0.01 + abs(s.a - depth) / depth);
+        sum += s.rgb * weight;
+        weightSum += weight;
+    }
+    return sum / max(weightSum, 1e-5);
+}
+
+// The shafts are smooth, so the center's value serves every FXAA tap
+vec3 Tap(vec2 uv, vec3 shafts) {
+    return Tonemap(texture(uScene, uv).rgb + texture(uBloom, uv).rgb * uBloomStrength + shafts);
+}
+
+// FXAA on the five taps already fetched; flat areas (most of the screen) return the center
+vec3 Fxaa(vec3 rgbM, vec3 rgbNW, vec3 rgbNE, vec3 rgbSW, vec3 rgbSE, vec3 shafts) {
+    float lumaNW = dot(rgbNW, kLuma);
+    float lumaNE = dot(rgbNE, kLuma);
+    float lumaSW = dot(rgbSW, kLuma);
+    float lumaSE = dot(rgbSE, kLuma);
+    float lumaM = dot(rgbM, kLuma);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+    if (lumaMax - lumaMin < max(0.0312, lumaMax * 0.125)) return rgbM;
+
+    vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * kReduceMul, kReduceMin);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-kSpanMax), vec2(kSpanMax)) * uTexel;
+
+    vec3 rgbA = 0.5 * (Tap(vUV + dir * (1.0 / 3.0 - 0.5), shafts) + Tap(vUV + dir * (2.0 / 3.0 - 0.5), shafts));
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (Tap(vUV + dir * -0.5, shafts) + Tap(vUV + dir * 0.5, shafts));
+    float lumaB = dot(rgbB, kLuma);
+    return (lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB;
+}
+
+void main() {
+    vec3 shafts = Shafts();
+    vec3 rgbM = Tap(vUV, shafts);
+    vec3 rgbNW = Tap(vUV + uTexel * vec2(-1.0, -1.0), shafts);
+    vec3 rgbNE = Tap(vUV + uTexel * vec2(1.0, -1.0), shafts);
+    vec3 rgbSW = Tap(vUV + uTexel * vec2(-1.0, 1.0), shafts);
+    vec3 rgbSE = Tap(vUV + uTexel * vec2(1.0, 1.0), shafts);
+    vec3 color = Fxaa(rgbM, rgbNW, rgbNE, rgbSW, rgbSE, shafts);
+
+    // Unsharp mask against the diagonal taps, clamped to their range so edges cannot ring
+    if (uSharpness > 0.0) {
+        vec3 blur = 0.25 * (rgbNW + rgbNE + rgbSW + rgbSE);
+        vec3 lo = min(rgbM, min(min(rgbNW, rgbNE), min(rgbSW, rgbSE)));
+        vec3 hi = max(rgbM, max(max(rgbNW, rgbNE), max(rgbSW, rgbSE)));
+        color = clamp(color + (color - blur) * uSharpness, lo, hi);
+    }
+    FragColor = vec4(color, 1.0);
+}
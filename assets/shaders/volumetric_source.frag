@@ -0,0 +1,26 @@
+#version 330 core
+// Light shaft source at the shaft resolution (drawn with fullscreen.vert): what the shafts
+// radiate from. Unoccluded sky, HDR highlights and the light's own disc where nothing in
+// front of it covers it; everything else is an occluder and stays black.
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D uSceneTexture;    // linear HDR, bilinear
+uniform sampler2D uDepthTexture;
+uniform vec2 uLightScreenPos;
+uniform vec4 uLightColor;           // rgb, a = disc radius in screen heights
+uniform float uLightDepth;          // window-space depth of the light
+uniform float uAspect;
+
+void main() {
+    float depth = texture(uDepthTexture, vUV).r;
+    vec3 scene = texture(uSceneTexture, vUV).rgb;
+    vec3 source = depth >= 1.0 ? scene : max(scene - 1.0, 0.0);
+
+    vec2 toLight = (vUV - uLightScreenPos) * vec2(uAspect, 1.0);
+    if (depth > uLightDepth) {
+        source += uLightColor.rgb * (1.0 - smoothstep(0.0, uLightColor.a, length(toLight)));
+    }
+    FragColor = vec4(source, 1.0);
+}
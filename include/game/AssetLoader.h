@@ -0,0 +1,60 @@
+#pragma once
+#include "game/MeshCache.h"
+#include "game/JobSystem.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace game {
+
+    typedef int MeshHandle;
+
+    // Loads meshes in the background: cache mapping / OBJ parsing / optimization run on the
+    // job system, GL uploads are queued and drained on the GL thread under a time budget.
+    // A handle resolves to its placeholder until the real mesh has been uploaded.
+    class AssetLoader {
+    public:
+        AssetLoader(JobSystem& jobs, MeshCache& cache);
+        ~AssetLoader();
+
+        AssetLoader(const AssetLoader&) = delete;
+        AssetLoader& operator=(const AssetLoader&) = delete;
+
+        MeshHandle LoadMesh(const std::string& name, const std::string& sourcePath,
+            const std::string& generatorParams, std::function<MeshData()> build,
+            VertexFormat format, const Mesh& placeholder);
+
+        // GL thread, once per frame. Always uploads at least one mesh so loading cannot stall.
+        void PumpUploads(double budgetMs);
+
+        const Mesh& Get(MeshHandle handle) const { return slots_[handle].mesh; }
+        bool IsReady(MeshHandle handle) const { return slots_[handle].ready; }
+        int Pending() const { return pending_; }
+
+    private:
+        struct Slot {
+            Mesh mesh;
+            bool ready = false;
+        };
+
+        struct Completed {
+            MeshHandle handle;
+            PreparedMesh prepared;
+            bool failed = false;        // Prepare threw; the handle keeps its placeholder
+        };
+
+        JobSystem& jobs_;
+        MeshCache& cache_;
+        std::vector<Slot> slots_;       // GL thread only
+        int pending_ = 0;               // GL thread only
+        size_t failed_ = 0;             // GL thread only
+        double firstRequestTime_ = 0.0;
+
+        std::mutex completedMutex_;
+        std::deque<Completed> completed_;
+    };
+
+} // namespace game
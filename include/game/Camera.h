@@ -2,6 +2,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "game/glm_minimal.h" 
+#include "game/Frustum.h"
 
 namespace game {
 
@@ -24,6 +25,7 @@ namespace game {
         glm::vec3 position() const { return pos_; }
         glm::mat4 view()     const { return glm::lookAt(pos_, target_, up_); }
         glm::mat4 proj()     const { return proj_; }
+        Frustum frustum()    const { return extractFrustum(proj_ * view()); }
 
         // Smooth hybrid top-down follow
         void updateTracking(const glm::vec3& p1, const glm::vec3& p2, float smooth = 0.1f) {
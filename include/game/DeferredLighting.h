@@ -0,0 +1,64 @@
+#pragma once
+#include "game/PostProcess.h"
+#include "game/Frustum.h"
+#include "game/FrameStats.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace game {
+
+    // Point light for the deferred path. Its influence ends at the radius, so a light only
+    // costs the pixels its sphere covers on screen.
+    struct PointLight {
+        glm::vec4 positionRadius;   // xyz world position, w = radius
+        glm::vec4 color;            // rgb with the intensity folded in
+    };
+
+    // Lighting and resolve passes over a filled GBuffer. The FrameData lights (light 0 with its
+    // shadow map) are one full-screen triangle; point lights are frustum-culled and drawn as a
+    // single instanced draw of low-poly spheres, blended additively into the light target.
+    class DeferredLighting {
+    public:
+        // Takes ownership of the programs:
+        //   directional = fullscreen.vert + deferred_light.frag
+        //   point       = light_volume.vert + light_volume.frag
+        //   resolve     = fullscreen.vert + resolve.frag
+        DeferredLighting(GLuint directionalProgram, GLuint pointProgram, GLuint resolveProgram);
+        ~DeferredLighting();
+
+        DeferredLighting(const DeferredLighting&) = delete;
+        DeferredLighting& operator=(const DeferredLighting&) = delete;
+
+        // Clears the light target to the (gamma-space) background color and accumulates the
+        // lighting of every covered pixel into it
+        void Light(GBuffer& gbuffer, const glm::mat4& viewProj, const Frustum& frustum,
+            const std::vector<PointLight>& lights, const glm::vec3& background, FrameStats& stats);
+
+        // Gamma-corrects the light target into the default framebuffer
+        void Resolve(GBuffer& gbuffer, FrameStats& stats);
+
+    private:
+        void UploadLights(const PointLight* lights, size_t count);
+
+        GLuint directionalProgram_ = 0;
+        GLuint pointProgram_ = 0;
+        GLuint resolveProgram_ = 0;
+        GLint directionalInvViewProj_ = -1;
+        GLint pointInvViewProj_ = -1;
+
+        GLuint emptyVao_ = 0;       // the full-screen triangle comes from gl_VertexID
+        GLuint sphereVao_ = 0;
+        GLuint sphereVbo_ = 0;
+        GLuint sphereEbo_ = 0;
+        GLsizei sphereIndexCount_ = 0;
+        GLuint lightVbo_ = 0;       // per-instance PointLight
+        size_t lightCapacity_ = 0;
+
+        std::vector<float> cullX_, cullY_, cullZ_, cullRadius_;
+        std::vector<uint8_t> cullVisible_;
+        std::vector<PointLight> visible_;
+    };
+
+} // namespace game
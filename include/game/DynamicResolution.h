@@ -0,0 +1,56 @@
+#pragma once
+#include "game/GpuTimer.h"
+#include <algorithm>
+
+namespace game {
+
+    // Render-scale controller for dynamic resolution. The 3D scene is drawn at Scale() times
+    // the framebuffer size and PostProcessor upscales it to the screen; the scale follows a
+    // smoothed frame time toward a target in kScaleStep steps, so the targets are only
+    // reallocated when it actually moves.
+    class DynamicResolution {
+    public:
+        static constexpr float kMinScale = 0.5f;
+        static constexpr float kMaxScale = 1.0f;
+        static constexpr float kScaleStep = 0.05f;
+        static const int kSettleFrames = 30;        // frames the history gets after each change
+
+        explicit DynamicResolution(double targetMs = 14.5);
+
+        DynamicResolution(const DynamicResolution&) = delete;
+        DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+        // GL_TIMESTAMP queries around the frame's GPU work, read GpuTimer::kFrames frames late.
+        // Timestamps rather than GL_TIME_ELAPSED, which cannot enclose the post chain's own
+        // timer queries.
+        void BeginFrame();
+        void EndFrame();
+
+        // Feeds one frame; returns true when Scale() changed. The GPU time drives the scale
+        // since only GPU cost shrinks with it; cpuMs (the frame's work without the swap) stands
+        // in until the first timestamps come back.
+        bool Update(double cpuMs);
+
+        // Disabled means a fixed scale of 1
+        void SetEnabled(bool enabled) { enabled_ = enabled; }
+        bool Enabled() const { return enabled_; }
+
+        float Scale() const { return scale_; }
+        int ScaledSize(int size) const { return std::max((int)((float)size * scale_ + 0.5f), 1); }
+        double GpuMs() const { return gpuMs_; }
+        double SmoothedMs() const { return smoothedMs_; }
+        double TargetMs() const { return targetMs_; }
+
+    private:
+        GpuTimer timer_{ 2 };                       // begin, end
+        bool gpuTimed_ = false;                     // a timestamp pair has been read back
+
+        double targetMs_;
+        double gpuMs_ = 0.0;
+        double smoothedMs_ = 0.0;
+        float scale_ = 1.0f;
+        int settle_ = 0;
+        bool enabled_ = true;
+    };
+
+} // namespace game
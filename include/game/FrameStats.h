@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+
+namespace game {
+
+    // Per-frame render counters, reset at the start of every frame
+    struct FrameStats {
+        int drawCalls = 0;
+        int programBinds = 0;
+        int textureBinds = 0;
+        int vaoBinds = 0;
+        size_t trianglesSubmitted = 0;   // after LOD selection
+        size_t trianglesFullDetail = 0;  // what LOD 0 everywhere would have cost
+        int objectsVisible = 0;          // after frustum culling
+        int objectsCulled = 0;
+        double cullMs = 0.0;
+        int objectsOccluded = 0;         // inside the frustum but behind walls/furniture
+        double occlusionMs = 0.0;        // occluder rasterization + sphere tests
+        int lightsVisible = 0;           // point lights after frustum culling
+        int lightsCulled = 0;
+        double clusterMs = 0.0;          // CPU froxel assignment for the forward path
+        double bloomDownGpuMs = 0.0;     // post stages on the GPU, a few frames old
+        double bloomUpGpuMs = 0.0;
+        double volumetricGpuMs = 0.0;    // shaft source + march at reduced resolution
+        double tonemapGpuMs = 0.0;       // bloom composite + tonemap + FXAA
+        double renderScale = 0.0;        // scene size / framebuffer size (dynamic resolution)
+        double frameGpuMs = 0.0;         // whole frame on the GPU, a few frames old
+        int stateCallsIssued = 0;        // GL state calls through glState() (debug builds only)
+        int stateCallsElided = 0;
+
+        void Reset() { *this = FrameStats(); }
+
+        void Accumulate(const FrameStats& o) {
+            drawCalls += o.drawCalls;
+            programBinds += o.programBinds;
+            textureBinds += o.textureBinds;
+            vaoBinds += o.vaoBinds;
+            trianglesSubmitted += o.trianglesSubmitted;
+            trianglesFullDetail += o.trianglesFullDetail;
+            objectsVisible += o.objectsVisible;
+            objectsCulled += o.objectsCulled;
+            cullMs += o.cullMs;
+            objectsOccluded += o.objectsOccluded;
+            occlusionMs += o.occlusionMs;
+            lightsVisible += o.lightsVisible;
+            lightsCulled += o.lightsCulled;
+            clusterMs += o.clusterMs;
+            bloomDownGpuMs += o.bloomDownGpuMs;
+            bloomUpGpuMs += o.bloomUpGpuMs;
+            volumetricGpuMs += o.volumetricGpuMs;
+            tonemapGpuMs += o.tonemapGpuMs;
+            renderScale += o.renderScale;
+            frameGpuMs += o.frameGpuMs;
+            stateCallsIssued += o.stateCallsIssued;
+            stateCallsElided += o.stateCallsElided;
+        }
+    };
+
+} // namespace game
@@ -0,0 +1,24 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace game {
+
+    // Six inward-facing planes (xyz = normal, w = distance), normalized so
+    // dot(plane.xyz, p) + plane.w is a signed distance in world units
+    struct Frustum {
+        enum { Left, Right, Bottom, Top, Near, Far };
+        glm::vec4 planes[6];
+    };
+
+    // Gribb/Hartmann extraction from a combined projection * view matrix
+    Frustum extractFrustum(const glm::mat4& viewProj);
+
+    // Tests 'count' spheres given as separate x/y/z/radius arrays, four at a time with SSE where
+    // available. visible[i] is set to 1 when sphere i is at least partly inside, 0 otherwise.
+    // Returns the number of visible spheres.
+    size_t cullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z,
+        const float* radius, size_t count, uint8_t* visible);
+
+} // namespace game
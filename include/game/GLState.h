@@ -0,0 +1,75 @@
+#pragma once
+#include <GL/glew.h>
+
+namespace game {
+
+    // Shadow copy of the GL binding and fixed-function state. Every subsystem changes state through
+    // glState() so calls that would not change anything are skipped. Anything not tracked here
+    // (or changed behind the cache's back) must be followed by Invalidate().
+    class GLStateCache {
+    public:
+        static const int kMaxTextureUnits = 16;
+
+        GLStateCache() { Invalidate(); }
+
+        void UseProgram(GLuint program);
+        void BindVertexArray(GLuint vao);
+
+        // GL_ELEMENT_ARRAY_BUFFER is VAO state and always passes through
+        void BindBuffer(GLenum target, GLuint buffer);
+        void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+        // Selects the unit only when the binding actually changes
+        void BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+        void SetEnabled(GLenum cap, bool enabled);
+        void Enable(GLenum cap) { SetEnabled(cap, true); }
+        void Disable(GLenum cap) { SetEnabled(cap, false); }
+        void BlendFunc(GLenum src, GLenum dst);
+        void DepthMask(bool write);
+        void DepthFunc(GLenum func);
+        void CullFace(GLenum face);
+
+        // Delete the object and drop it from the cache, since GL may hand the name out again
+        void DeleteProgram(GLuint& program);
+        void DeleteVertexArray(GLuint& vao);
+        void DeleteBuffer(GLuint& buffer);
+        void DeleteTexture(GLuint& texture);
+
+        // Forget everything; the next call of each kind is issued
+        void Invalidate();
+
+        // Calls issued vs skipped since the last TakeCounters(); only counted in debug builds
+        struct Counters {
+            int issued = 0;
+            int elided = 0;
+        };
+        Counters TakeCounters();
+
+    private:
+        static const GLuint kUnknown = ~0u;
+        enum { kBufferTargets = 6, kTextureTargets = 5, kCaps = 6 };
+
+        static int BufferSlot(GLenum target);
+        static int TextureSlot(GLenum target);
+        static int CapSlot(GLenum cap);
+
+        void Count(bool issued);
+
+        GLuint program_;
+        GLuint vao_;
+        GLuint buffers_[kBufferTargets];
+        GLuint activeUnit_;
+        GLuint textures_[kMaxTextureUnits][kTextureTargets];
+        int caps_[kCaps];               // -1 unknown, 0 disabled, 1 enabled
+        GLenum blendSrc_, blendDst_;
+        int depthMask_;
+        GLenum depthFunc_;
+        GLenum cullFace_;
+        Counters counters_;
+    };
+
+    // The cache for the (single) GL context
+    GLStateCache& glState();
+
+} // namespace game
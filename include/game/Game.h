@@ -1,10 +1,24 @@
-// Game.h - Enhanced with proper UI states and lightning effects
+﻿// Game.h - Enhanced with proper UI states and lightning effects
 #pragma once
 #include "game/pch.h"
 #include "game/glm_minimal.h"
 #include "game/Camera.h"
 #include "game/MeshUtils.h"
+#include "game/MeshCache.h"
+#include "game/GeometryArena.h"
+#include "game/JobSystem.h"
+#include "game/AssetLoader.h"
+#include "game/InstanceBuffer.h"
+#include "game/RenderQueue.h"
+#include "game/UniformBlocks.h"
+#include "game/FrameStats.h"
+#include "game/ShadowMap.h"
+#include "game/DeferredLighting.h"
+#include "game/LightClusters.h"
+#include "game/DynamicResolution.h"
+#include "game/PerfHud.h"
 #include "game/Texture.h"
+#include "game/TextureArray.h"
 #include "game/SoundSystem.h"
 #include "game/ParticleSystem.h"
 #include "game/LightningSystem.h"
@@ -91,23 +105,98 @@ namespace game {
 
         // Rendering
         GLuint prog_ = 0;
-        GLint uModel_ = -1, uView_ = -1, uProj_ = -1, uViewPos_ = -1;
-        GLint uBaseColor_ = -1, uEmissive_ = -1;
-        GLint uKa_ = -1, uKd_ = -1, uKs_ = -1, uShine_ = -1;
-        GLint uL1pos_ = -1, uL1col_ = -1, uL2pos_ = -1, uL2col_ = -1;
-        GLint uUseTexture_ = -1, uTexture_ = -1;
+        GLint uTexture_ = -1;
+        GLint uPosScale_ = -1, uPosOffset_ = -1, uOctNormals_ = -1;
+        SceneProgram sceneProgram_;
+
+        // Camera and lights, uploaded once per frame to frameUbo_
+        FrameBlock frameBlock_;
+        std::unique_ptr<UniformBuffer> frameUbo_;
+
+        // Lighting coefficients indexed by the material id in each draw's sort key,
+        // uploaded once to materialUbo_
+        enum SceneMaterial {
+            MatGround, MatWall, MatFurniture, MatCheese,
+            MatShield, MatSpeed, MatFreeze, MatParticle,
+            MatMouse, MatCat, MatEffect, MatCount
+        };
+        static_assert(MatCount <= kMaxMaterials, "material table overflows the MaterialTable block");
+        std::vector<RenderMaterial> materials_;
+        std::unique_ptr<UniformBuffer> materialUbo_;
 
         Camera cam_;
         float cameraAngle_ = 0.0f;
         float cameraHeight_ = 20.0f;
         float cameraDistance_ = 22.0f;
 
-        // Meshes
-        Mesh box_, sphere_, cyl_, cone_;
-        Mesh mouseModel_, catModel_, cheeseModel_;
+        // Background work (declared before its users so it is destroyed last)
+        std::unique_ptr<JobSystem> jobs_;
+
+        // Meshes (all suballocated from geometry_, drawn with one VAO). box_ and sphere_
+        // load up front and double as placeholders for the handles streamed in by assets_.
+        std::unique_ptr<GeometryArena> geometry_;
+        std::unique_ptr<MeshCache> meshCache_;
+        std::unique_ptr<AssetLoader> assets_;
+        Mesh box_, sphere_;
+        MeshHandle cylHandle_ = 0, coneHandle_ = 0;
+        MeshHandle mouseHandle_ = 0, catHandle_ = 0, cheeseHandle_ = 0;
+
+        // Scene draws are recorded into renderQueue_, sorted by state and drawn instanced
+        std::unique_ptr<InstanceBuffer> instances_;
+        std::unique_ptr<RenderQueue> renderQueue_;
+        std::vector<DrawList> drawLists_;      // per-chunk packets recorded on the workers
+
+        // Walls and large furniture rasterized on the CPU; whatever they hide is dropped
+        // before submission (F6 toggles)
+        std::unique_ptr<OcclusionCuller> occlusion_;
+        bool occlusionEnabled_ = true;
+
+        // Light 0 shadows: walls and furniture are cached in shadowMap_'s static layer, the
+        // mouse, cat and cheese are drawn through shadowQueue_ every frame
+        std::unique_ptr<ShadowMap> shadowMap_;
+        std::unique_ptr<RenderQueue> shadowQueue_;
+        GLuint shadowProg_ = 0;
+        SceneProgram shadowProgram_;
+
+        // Deferred path (F4 switches back to forward): opaque draws fill gbuffer_ through
+        // gbufferProgram_, deferred_ then lights them with the frame lights and pointLights_
+        std::unique_ptr<GBuffer> gbuffer_;
+        std::unique_ptr<DeferredLighting> deferred_;
+        GLuint gbufferProg_ = 0;
+        SceneProgram gbufferProgram_;
+        bool deferredEnabled_ = true;
+        std::vector<PointLight> lamps_;         // the level's themed lamps, built by resetWorld
+        std::vector<PointLight> pointLights_;   // lamps_ plus this frame's glowing pickups and bolts
+        static const size_t kMaxCheeseLights = 32;
+        std::vector<glm::vec4> cheeseLights_;   // xyz = position, w = squared distance to the camera
+
+        // Forward frames light pointLights_ per cluster instead; L adds 16/256/1024 benchmark lights
+        std::unique_ptr<LightClusters> clusters_;
+        int benchmarkLights_ = 0;
+
+        // HDR scene target, bloom and the tonemap/FXAA pass; also takes over deferred_'s resolve
+        std::unique_ptr<PostProcessor> post_;
+
+        // Scales post_'s targets (and the G-buffer) below the framebuffer size when frames run
+        // long; F5 pins native resolution
+        std::unique_ptr<DynamicResolution> dynamicResolution_;
+
+        // Render statistics (LOD selection uses lodPixelsPerUnit_, refreshed every frame)
+        FrameStats frameStats_;
+        FrameStats statsWindow_;
+        int statsWindowFrames_ = 0;
+        double statsWindowStart_ = 0.0;
+        float lodPixelsPerUnit_ = 1.0f;
+
+        // F3 overlay; phases are timed with PerfHud::Scope
+        PerfHud perfHud_;
+
+        // Values last shown in the window title, which is only rebuilt when they change
+        int shownTitle_[7] = { -1 };
 
         // Textures
-        std::unique_ptr<Texture> grassTex_, stoneTex_, metalTex_, woodTex_;
+        std::unique_ptr<TextureArray> surfaceTextures_;     // grass, stone, metal and wood layers
+        int grassLayer_ = -1, stoneLayer_ = -1, metalLayer_ = -1, woodLayer_ = -1;
 
         // Advanced Systems
         std::unique_ptr<SoundSystem> soundSystem_;
@@ -133,6 +222,7 @@ namespace game {
         int score_ = 0;
         int collected_ = 0;
         int totalCheese_ = 5;
+        bool stressTest_ = false;
         float gameTime_ = 0.0f;
         float levelTime_ = 0.0f;
         float levelTimeLimit_ = 120.0f;
@@ -173,15 +263,16 @@ namespace game {
         void initShaders();
         void initMeshes();
         void initTextures();
+        void initShadows();
+        void initDeferred();
+        void initPostProcessing();
+        void buildLamps();
         void resetWorld();
         void startGame();
         void renderLevelTransition();
         void triggerVictoryCelebration();
 
         // Utility
-        std::string loadText(const std::string& path);
-        GLuint compile(GLenum type, const std::string& src);
-        GLuint link(GLuint v, GLuint f);
         void printInstructions();
 
         // Update
@@ -214,7 +305,14 @@ namespace game {
 
         // Render
         void render();
-        void renderScene();
+        void renderScene(bool deferred, const glm::vec3& background);
+        void renderShadows();
+        void gatherPointLights();
+        int selectLod(const Mesh& mesh, const glm::mat4& model) const;
+        glm::mat4 mouseModel() const;
+        glm::mat4 catModel() const;
+        glm::mat4 cheeseModel(const Cheese& c) const;
+        void reportFrameStats(double now);
         void renderIntro();
         void renderMenu();
         void renderPauseMenu();
@@ -0,0 +1,46 @@
+#pragma once
+#include "game/MeshUtils.h"
+#include <cstddef>
+
+namespace game {
+
+    // One vertex buffer, one index buffer and one VAO shared by every static mesh.
+    // Meshes added here are plain records (baseVertex + firstIndex + LOD ranges) drawn with
+    // glDrawElementsBaseVertex, so switching meshes never rebinds a VAO. Buffers grow by
+    // copying on the GPU when full; previously returned records stay valid.
+    class GeometryArena {
+    public:
+        GeometryArena(const VertexLayout& layout, GLenum indexType,
+            size_t vertexCapacity = 64 * 1024, size_t indexCapacity = 256 * 1024);
+        ~GeometryArena();
+
+        GeometryArena(const GeometryArena&) = delete;
+        GeometryArena& operator=(const GeometryArena&) = delete;
+
+        // Only geometry encoded with the arena's layout and index type fits
+        bool Accepts(const VertexLayout& layout, GLenum indexType) const;
+
+        Mesh Add(const void* vertices, GLsizeiptr vertexBytes,
+            const void* indices, GLsizei indexCount,
+            const MeshLod* lods, int lodCount,
+            const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+        GLuint Vao() const { return vao_; }
+        size_t VertexBytes() const { return vertexUsed_; }
+        size_t IndexBytes() const { return indexUsed_; }
+        int MeshCount() const { return meshCount_; }
+
+    private:
+        void Grow(GLenum target, GLuint& buffer, size_t& capacity, size_t used, size_t needed);
+
+        VertexLayout layout_;
+        GLenum indexType_;
+        size_t indexSize_;
+
+        GLuint vao_ = 0, vbo_ = 0, ebo_ = 0;
+        size_t vertexCapacity_, indexCapacity_;     // bytes
+        size_t vertexUsed_ = 0, indexUsed_ = 0;     // bytes
+        int meshCount_ = 0;
+    };
+
+} // namespace game
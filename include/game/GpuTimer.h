@@ -0,0 +1,42 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+namespace game {
+
+    // Ring of GL queries read a few frames late, so reading never waits on the GPU. Each frame
+    // issues a slot of queriesPerFrame queries (GL_TIME_ELAPSED or GL_TIMESTAMP, the caller's
+    // choice) through RenderDevice; Collect() reads the slot the frame is about to reuse.
+    class GpuTimer {
+    public:
+        static const int kFrames = 3;       // results are read this many frames late
+
+        explicit GpuTimer(int queriesPerFrame);
+        ~GpuTimer();
+
+        GpuTimer(const GpuTimer&) = delete;
+        GpuTimer& operator=(const GpuTimer&) = delete;
+
+        // Start of a frame: reads the results of the frame that used the current slot last, if
+        // its last query has finished. True when Value() now holds them.
+        bool Collect();
+
+        // Query 'index' of the current frame's slot
+        GLuint Query(int index) const { return queries_[(size_t)slot_ * count_ + index]; }
+
+        // Result of query 'index' from the last successful Collect(), in nanoseconds
+        GLuint64 Value(int index) const { return values_[index]; }
+
+        // End of a frame: marks the slot as issued and moves on to the next one
+        void EndFrame();
+
+    private:
+        int count_;
+        std::vector<GLuint> queries_;       // kFrames slots of count_
+        std::vector<GLuint64> values_;
+        bool issued_[kFrames] = {};
+        int slot_ = 0;
+    };
+
+} // namespace game
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace game {
+
+    // 64-bit FNV-1a, used for cache keys (mesh/shader/texture caches)
+    const uint64_t kFnvOffset = 14695981039346656037ull;
+    const uint64_t kFnvPrime = 1099511628211ull;
+
+    inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = kFnvOffset) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t h = seed;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= kFnvPrime;
+        }
+        return h;
+    }
+
+    inline uint64_t hashString(const std::string& s, uint64_t seed = kFnvOffset) {
+        return hashBytes(s.data(), s.size(), seed);
+    }
+
+    // Same hash as hashString(), usable in constant expressions (see UniformName)
+    constexpr uint64_t hashLiteral(const char* s, uint64_t h = kFnvOffset) {
+        while (*s) {
+            h ^= (unsigned char)*s++;
+            h *= kFnvPrime;
+        }
+        return h;
+    }
+
+    inline std::string hashToHex(uint64_t h) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            out[i] = digits[h & 0xF];
+            h >>= 4;
+        }
+        return out;
+    }
+
+} // namespace game
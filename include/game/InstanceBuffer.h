@@ -0,0 +1,48 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <unordered_set>
+
+namespace game {
+
+    // Per-instance attributes of every RenderQueue draw (basic.vert, shadow.vert)
+    struct InstanceData {
+        glm::mat4 model;
+        glm::vec4 colorEmissive;    // rgb = base color, a = emissive
+        glm::vec4 surface;          // x = TextureArray layer (< 0 = untextured), y = MaterialTable row
+    };
+
+    // Locations 2..5 hold the model matrix columns, 6 the color/emissive, 7 the surface
+    const GLuint kInstanceModelLocation = 2;
+    const GLuint kInstanceColorLocation = 6;
+    const GLuint kInstanceSurfaceLocation = 7;
+
+    // Streamed vertex buffer of InstanceData. Every Upload() orphans the previous storage so
+    // several batches per frame never wait on draws still reading the last one.
+    class InstanceBuffer {
+    public:
+        InstanceBuffer();
+        ~InstanceBuffer();
+
+        InstanceBuffer(const InstanceBuffer&) = delete;
+        InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+        // Binds a VAO, adding the instance attributes (divisor 1) the first time it is seen.
+        // Meshes the GeometryArena rejects have VAOs of their own, so every VAO the queue
+        // draws from goes through here.
+        void BindVertexArray(GLuint vao);
+
+        void Upload(const InstanceData* instances, size_t count);
+
+        // Points the bound VAO's instance attributes at instance 'first' of the last upload.
+        // Stands in for a base-instance draw parameter, which GL 3.3 does not have.
+        void BindRange(size_t first);
+
+    private:
+        GLuint vbo_ = 0;
+        size_t capacity_ = 0;   // instances
+        std::unordered_set<GLuint> attached_;   // mesh VAOs live as long as the GL context
+    };
+
+} // namespace game
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+
+    // Fixed pool of worker threads pulling jobs from one FIFO queue
+    class JobSystem {
+    public:
+        // 0 = one worker per hardware thread, leaving one for the GL thread
+        explicit JobSystem(unsigned int workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        void Submit(std::function<void()> job);
+
+        // Splits [0, count) into chunks of 'grain' items and runs fn(chunk, begin, end) for each,
+        // on the workers and the calling thread. Returns once every chunk has finished; helper
+        // jobs jump the queue and never wait on unrelated work (e.g. mesh builds).
+        void ParallelFor(size_t count, size_t grain,
+            const std::function<void(size_t chunk, size_t begin, size_t end)>& fn);
+
+        // Blocks until the queue is empty and no job is running
+        void WaitIdle();
+
+        unsigned int WorkerCount() const { return (unsigned int)workers_.size(); }
+
+    private:
+        void WorkerMain();
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> queue_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        int running_ = 0;
+        bool quit_ = false;
+    };
+
+} // namespace game
@@ -0,0 +1,64 @@
+#pragma once
+#include "game/DeferredLighting.h"
+#include "game/UniformBlocks.h"
+#include "game/FrameStats.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace game {
+
+    // Clustered light assignment for forward shading. The view frustum is split into screen
+    // tiles and logarithmic depth slices (froxels); Build() lists the point lights touching each
+    // froxel on the CPU and Upload() streams the result into three texture buffers, so
+    // basic.frag only evaluates the lights of its own cluster.
+    class LightClusters {
+    public:
+        static const int kTilesX = 16;
+        static const int kTilesY = 9;
+        static const int kSlices = 24;
+        static const int kMaxLights = 65535;    // indices are 16 bit
+
+        // Units the buffers are bound to (2-4 belong to the G-buffer)
+        static const GLuint kLightUnit = 5;     // RGBA32F, two texels per light
+        static const GLuint kRangeUnit = 6;     // RG32UI per cluster: first index, count
+        static const GLuint kIndexUnit = 7;     // R16UI light indices
+
+        LightClusters();
+        ~LightClusters();
+
+        LightClusters(const LightClusters&) = delete;
+        LightClusters& operator=(const LightClusters&) = delete;
+
+        // Assigns each light to every froxel overlapped by its sphere's screen rectangle and
+        // depth range. CPU only; near/far and the tile grid come from proj and the target size.
+        void Build(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& proj,
+            int width, int height, FrameStats& stats);
+
+        // Uploads the last Build and binds the buffers on their units
+        void Upload();
+
+        // Turns the clustered loop off (w = 0 in ClusterData) until the next Upload
+        void Disable();
+
+        size_t IndexCount() const { return indices_.size(); }
+        uint32_t ClusterLightCount(int x, int y, int z) const {
+            return ranges_[2 * (((size_t)z * kTilesY + y) * kTilesX + x) + 1];
+        }
+
+    private:
+        ClusterBlock block_;
+        bool enabled_ = false;
+        std::unique_ptr<UniformBuffer> ubo_;
+        GLuint lightBuffer_ = 0, rangeBuffer_ = 0, indexBuffer_ = 0;
+        GLuint lightTexture_ = 0, rangeTexture_ = 0, indexTexture_ = 0;
+
+        std::vector<glm::vec4> lightData_;
+        std::vector<uint32_t> ranges_;          // offset, count per cluster
+        std::vector<uint16_t> indices_;
+        std::vector<uint8_t> lightBounds_;      // x0, x1, y0, y1, z0, z1 per light (z0 > z1 = none)
+    };
+
+} // namespace game
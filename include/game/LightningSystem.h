@@ -1,4 +1,6 @@
 #pragma once
+#include "game/DeferredLighting.h"
+#include "game/Shader.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <vector>
@@ -9,11 +11,20 @@ public:
     ~LightningSystem();
 
     void Init();
+
+    // Init without the lightning program (shader 0), for headless runs on RecordingRenderDevice
+    // where there is no GL context to compile it in
+    void InitHeadless();
     void Update(float dt);
     void Render(const glm::mat4& view, const glm::mat4& proj);
 
     void TriggerLightning(const glm::vec3& start, const glm::vec3& end);
 
+    int BoltCount() const { return (int)bolts_.size(); }
+
+    // One fading point light at the middle of every live bolt
+    void AppendLights(std::vector<game::PointLight>& lights) const;
+
 private:
     struct LightningBolt {
         std::vector<glm::vec3> points;
@@ -25,16 +36,12 @@ private:
     };
 
     void GenerateBolt(LightningBolt& bolt, const glm::vec3& start, const glm::vec3& end, int depth = 0);
-    void InitGL();
+    void InitShaders();
+    void InitBuffers();
 
     std::vector<LightningBolt> bolts_;
 
     GLuint vao_;
     GLuint vbo_;
-    GLuint shader_;
-
-    GLint uView_;
-    GLint uProj_;
-    GLint uColor_;
-    GLint uAlpha_;
+    Shader shader_;     // uniforms found by name hash; unchanged values are not re-sent
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+
+namespace game {
+
+    // Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::string& path);
+        void Close();
+
+        const unsigned char* Data() const { return data_; }
+        size_t Size() const { return size_; }
+        bool IsOpen() const { return data_ != nullptr; }
+
+    private:
+        const unsigned char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif
+    };
+
+    // One contiguous piece of a file written by writeFileAtomic
+    struct FileChunk {
+        const void* data;
+        size_t size;
+    };
+
+    // Writes the chunks to path + ".tmp", then renames that over path, so a crash never leaves
+    // a truncated file behind. On failure the temp file is removed and path is left as it was.
+    bool writeFileAtomic(const std::string& path, std::initializer_list<FileChunk> chunks);
+
+} // namespace game
@@ -0,0 +1,112 @@
+#pragma once
+#include "game/MeshUtils.h"
+#include "game/GeometryArena.h"
+#include "game/MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace game {
+
+    // On-disk container for built meshes (*.gmesh):
+    //   header | vertex layout | bounds | LOD ranges | vertex blob | index blob
+    // Blobs are 64-byte aligned so a mapped file can be handed to glBufferData as-is.
+    const uint32_t kMeshFileMagic = 0x48534D47; // "GMSH"
+    const uint32_t kMeshFileVersion = 3;
+    const uint32_t kMeshFileAlignment = 64;
+
+    struct MeshFileAttrib {
+        uint32_t location;
+        uint32_t components;
+        uint32_t type;
+        uint32_t normalized;
+        uint32_t offset;
+    };
+
+    struct MeshFileLod {
+        uint32_t indexOffset;
+        uint32_t indexCount;
+        float error;
+    };
+
+    struct MeshFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t vertexStride;
+        uint32_t attribCount;
+        MeshFileAttrib attribs[4];
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t lodCount;
+        uint32_t indexSize;     // 2 or 4 bytes
+        MeshFileLod lods[kMaxMeshLods];
+        uint64_t vertexOffset;
+        uint64_t vertexBytes;
+        uint64_t indexOffset;
+        uint64_t indexBytes;
+    };
+
+    // CPU half of a mesh load: either a mapped cache file or freshly encoded buffers.
+    // Produced on any thread, consumed by MeshCache::Upload on the GL thread.
+    struct PreparedMesh {
+        std::string name;
+        VertexLayout layout;
+        GLsizei indexCount = 0;
+        GLenum indexType = GL_UNSIGNED_INT;
+        MeshLod lods[kMaxMeshLods];
+        int lodCount = 0;
+        glm::vec3 boundsMin{ 0.0f }, boundsMax{ 0.0f };
+
+        // Cache hit: blobs live inside the mapping
+        std::unique_ptr<MappedFile> file;
+        uint64_t vertexOffset = 0, vertexBytes = 0, indexOffset = 0;
+
+        // Cache miss: blobs were encoded from the rebuilt MeshData
+        MeshBuffers buffers;
+    };
+
+    class MeshCache {
+    public:
+        // With an arena, meshes that match its format are suballocated there instead of
+        // getting buffers of their own
+        explicit MeshCache(const std::string& directory, GeometryArena* arena = nullptr);
+
+        // Uploads the cached mesh when its key still matches, otherwise builds, optimizes
+        // and generates LODs for it, writes a fresh cache file and uploads the result.
+        // Same as Upload(Prepare(...)).
+        Mesh Load(const std::string& name, const std::string& sourcePath,
+            const std::string& generatorParams, const std::function<MeshData()>& build,
+            VertexFormat format = VertexFormat::Float);
+
+        // Everything except the GL upload; safe to call from worker threads
+        PreparedMesh Prepare(const std::string& name, const std::string& sourcePath,
+            const std::string& generatorParams, const std::function<MeshData()>& build,
+            VertexFormat format = VertexFormat::Float);
+
+        // GL thread only
+        Mesh Upload(const PreparedMesh& prepared);
+
+        // Source file contents + generator parameters + vertex format + builder/format versions
+        static uint64_t ComputeKey(const std::string& sourcePath, const std::string& generatorParams,
+            VertexFormat format = VertexFormat::Float);
+
+        int Hits() const { return hits_; }
+        int Misses() const { return misses_; }
+
+    private:
+        bool TryMap(const std::string& path, uint64_t key, PreparedMesh& out);
+        bool Write(const std::string& path, uint64_t key, const MeshBuffers& buffers,
+            const MeshData& data);
+
+        std::string directory_;
+        GeometryArena* arena_;
+        std::atomic<int> hits_{ 0 };
+        std::atomic<int> misses_{ 0 };
+    };
+
+} // namespace game
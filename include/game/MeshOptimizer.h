@@ -0,0 +1,30 @@
+#pragma once
+#include "game/MeshUtils.h"
+#include <vector>
+
+namespace game {
+
+    // Post-transform vertex cache statistics for a FIFO cache of the given size.
+    // ACMR = transformed vertices per triangle (ideal ~0.5), ATVR = per unique vertex (ideal 1.0).
+    struct VertexCacheStats {
+        float acmr = 0.0f;
+        float atvr = 0.0f;
+    };
+
+    VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices,
+        size_t vertexCount, unsigned int cacheSize = 16);
+
+    // Merges vertices whose position/normal match within a small tolerance and drops
+    // triangles that became degenerate
+    void weldVertices(MeshData& data);
+
+    // Forsyth's linear-speed triangle reordering for the post-transform cache
+    void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+
+    // Renumbers vertices in first-use order so fetches walk the buffer linearly
+    void optimizeVertexFetch(MeshData& data);
+
+    // Runs all of the above and prints before/after statistics
+    void optimizeMesh(MeshData& data, const char* name = nullptr);
+
+} // namespace game
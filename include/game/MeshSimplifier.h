@@ -0,0 +1,21 @@
+#pragma once
+#include "game/MeshUtils.h"
+#include <vector>
+
+namespace game {
+
+    // Quadric-error-metric edge collapse (Garland & Heckbert). Vertices are only ever moved
+    // onto existing neighbours, so the result indexes the same vertex buffer as the input.
+    // Normal seams and open borders are locked. Stops at targetIndexCount or once the next
+    // collapse would exceed maxError. A collapse's error is the RMS distance (model units) of
+    // the merged vertex from its area-weighted quadric planes. outError receives the largest
+    // collapse error; it estimates the deviation but does not bound it.
+    std::vector<unsigned int> simplifyMesh(const std::vector<MeshVertex>& vertices,
+        const std::vector<unsigned int>& indices, size_t targetIndexCount,
+        float maxError, float* outError = nullptr);
+
+    // Fills data.lods with up to kMaxMeshLods levels. LOD 0 is the existing index list;
+    // coarser levels are appended to data.indices so every LOD shares one vertex/index buffer.
+    void buildMeshLods(MeshData& data, const char* name = nullptr);
+
+} // namespace game
@@ -1,21 +1,141 @@
 ﻿#pragma once
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace game {
 
+    // Bump whenever a builder below changes its output so cached meshes are rebuilt
+    const unsigned int kMeshBuilderVersion = 2;
+
+    const int kMaxMeshLods = 4;
+
+    struct MeshVertex { float x, y, z, nx, ny, nz; };
+
+    // Range of the index buffer drawn for one level of detail. error is the simplifier's
+    // estimate of the model-space deviation from LOD 0: the RMS plane distance of its most
+    // expensive collapse. It is not a bound; single points can move further.
+    struct MeshLod {
+        unsigned int indexOffset = 0;
+        unsigned int indexCount = 0;
+        float error = 0.0f;
+    };
+
+    // CPU-side geometry produced by the builders, before it is uploaded.
+    // An empty lods list means a single level covering all indices.
+    struct MeshData {
+        std::vector<MeshVertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<MeshLod> lods;
+    };
+
+    // Describes how one vertex is laid out in the vertex buffer
+    struct VertexAttrib {
+        GLuint location = 0;
+        GLint components = 0;
+        GLenum type = GL_FLOAT;
+        GLboolean normalized = GL_FALSE;
+        GLuint offset = 0;
+    };
+
+    struct VertexLayout {
+        GLsizei stride = 0;
+        int attribCount = 0;
+        VertexAttrib attribs[4];
+    };
+
+    // Float: MeshVertex as-is, 24 bytes, 32-bit indices.
+    // Packed: snorm16 positions relative to the bounds + octahedral snorm16 normals, 12 bytes,
+    // 16-bit indices whenever the vertex count fits. basic.vert dequantizes.
+    enum class VertexFormat { Float, Packed };
+
+    struct PackedVertex {
+        int16_t px, py, pz, pad;
+        int16_t nx, ny;
+    };
+
+    // GPU-ready vertex/index blobs for one format
+    struct MeshBuffers {
+        VertexLayout layout;
+        std::vector<unsigned char> vertices;
+        std::vector<unsigned char> indices;
+        GLsizei indexCount = 0;
+        GLenum indexType = GL_UNSIGNED_INT;
+    };
+
+    // A draw record. Standalone meshes own vao/vbo/ebo; meshes in a GeometryArena share the
+    // arena VAO, leave vbo/ebo at 0 and are located by baseVertex/firstIndex.
     struct Mesh {
         GLuint vao = 0, vbo = 0, ebo = 0;
-        GLsizei indexCount = 0;
+        GLint baseVertex = 0;
+        unsigned int firstIndex = 0;
+        GLsizei indexCount = 0;     // LOD 0
+        GLenum indexType = GL_UNSIGNED_INT;
+        glm::vec3 boundsMin{ 0.0f }, boundsMax{ 0.0f };
+        glm::vec3 boundsCenter{ 0.0f };     // sphere around the AABB, for culling
+        float boundsRadius = 0.0f;
+        int lodCount = 1;
+        MeshLod lods[kMaxMeshLods];
+
+        // Vertex shader dequantization: pos = aPos * posScale + posOffset
+        glm::vec3 posScale{ 1.0f }, posOffset{ 0.0f };
+        bool octNormals = false;
     };
 
+    // Layout of MeshVertex (position + normal, 6 floats) and of PackedVertex
+    VertexLayout meshVertexLayout();
+    VertexLayout packedVertexLayout();
+
+    MeshBuffers encodeMesh(const MeshData& data, VertexFormat format);
+    size_t indexTypeSize(GLenum indexType);
+
+    // Enables/points the layout's attributes on the bound VAO + GL_ARRAY_BUFFER
+    void setupVertexAttribs(const VertexLayout& layout);
+
+    // Fills in a Mesh record (LOD table, dequantization) without creating GL objects
+    Mesh describeMesh(const VertexLayout& layout, GLsizei indexCount, GLenum indexType,
+        const MeshLod* lods, int lodCount, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    // Upload helpers. createMesh() runs the mesh optimizer and LOD generation first;
+    // uploadMesh() sends the data as-is.
+    Mesh createMesh(MeshData data, const char* name = nullptr, VertexFormat format = VertexFormat::Float);
+    Mesh uploadMesh(const MeshData& data, VertexFormat format = VertexFormat::Float);
+    Mesh createMeshFromMemory(const VertexLayout& layout,
+        const void* vertices, GLsizeiptr vertexBytes,
+        const void* indices, GLsizei indexCount, GLenum indexType,
+        const MeshLod* lods, int lodCount,
+        const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    void computeBounds(const MeshData& data, glm::vec3& outMin, glm::vec3& outMax);
+
+    // CPU builders (no GL context needed)
+    MeshData buildBox();
+    MeshData buildSphere(int seg = 32, int rings = 16);
+    MeshData buildCylinder(int seg = 24);
+    MeshData buildCone(int seg = 24);
+    MeshData buildOBJ(const std::string& path);
+    MeshData buildDetailedMouse();
+    MeshData buildDetailedCat();
+    MeshData buildDetailedCheese();
+    MeshData buildQuad();
+
     // Basic primitives
     Mesh makeBox();
     Mesh makeSphere(int seg = 32, int rings = 16);
     Mesh makeCylinder(int seg = 24);
     Mesh makeCone(int seg = 24);
     void drawMesh(const Mesh& m);
+    void drawMeshLod(const Mesh& m, int lod);
+    // Issues the draw only; the caller keeps m.vao bound across consecutive draws
+    void drawMeshElements(const Mesh& m, int lod);
+    void drawMeshElementsInstanced(const Mesh& m, int lod, GLsizei instanceCount);
+
+    // Coarsest LOD whose projected MeshLod::error stays under maxPixelError. The error is an
+    // RMS estimate, so the default of half a pixel keeps the worst deviation near one pixel.
+    // pixelsPerUnit is proj[1][1] * 0.5 * viewport height, i.e. pixels per world unit at distance 1.
+    int selectMeshLod(const Mesh& m, float worldScale, float distance,
+        float pixelsPerUnit, float maxPixelError = 0.5f);
 
     // OBJ loader (with procedural fallbacks)
     Mesh loadOBJ(const std::string& path);
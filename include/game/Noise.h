@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+namespace game {
+
+    // Tileable 2D noise over the unit square. Lattices have a whole number of cells per axis
+    // and wrap at 1.0, so a texture filled from [0, 1) repeats without seams. The row functions
+    // fill one texel row (u = x / width, v fixed) four texels per SSE instruction, with the same
+    // steps (and results) as the scalar functions; they are what the texture generators use.
+
+    // One fractal: 'octaves' layers of noise, each with twice the cells and 'gain' times the
+    // amplitude of the one before
+    struct FractalParams {
+        int cellsX = 8;             // lattice cells across the tile in octave 0
+        int cellsY = 8;
+        int octaves = 5;
+        float gain = 0.5f;
+        uint32_t seed = 0;
+    };
+
+    // 32-bit integer hash of a lattice point; the same mix the SIMD paths use
+    uint32_t hashCell(uint32_t x, uint32_t y, uint32_t seed);
+
+    // Gradient (Perlin) noise in about [-1, 1]; x, y in lattice cells, wrapping at cellsX/cellsY
+    float gradientNoise(float x, float y, int cellsX, int cellsY, uint32_t seed);
+
+    // Sum of gradient noise octaves, normalized to about [-1, 1]
+    float fbm(float u, float v, const FractalParams& params);
+
+    // Ridged multifractal in [0, 1]: sharp creases where the noise crosses zero, with each
+    // octave weighted by the one before so detail gathers on the ridges
+    float ridged(float u, float v, const FractalParams& params);
+
+    // Cellular noise with one feature point per cell: distances (in cells) to the nearest and
+    // second nearest points. f2 - f1 is ~0 on the borders between cells.
+    void worley(float u, float v, int cells, uint32_t seed, float& f1, float& f2);
+
+    void fbmRow(float* out, int width, float v, const FractalParams& params);
+    void ridgedRow(float* out, int width, float v, const FractalParams& params);
+    void worleyRow(float* f1, float* f2, int width, float v, int cells, uint32_t seed);
+
+} // namespace game
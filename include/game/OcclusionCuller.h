@@ -0,0 +1,65 @@
+#pragma once
+#include "game/FrameStats.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace game {
+
+    class JobSystem;
+
+    // Software occlusion culling. A handful of large boxes (walls, big furniture) are
+    // rasterized into a small depth buffer on the CPU, four pixels per SSE instruction and one
+    // band of rows per worker, then a hierarchy keeping the farthest depth of each 2x2 block is
+    // built on top. IsVisible() tests a bounding sphere against it before the draw is submitted.
+    // No GL is involved, so it runs (and can be checked) without a GPU.
+    class OcclusionCuller {
+    public:
+        static constexpr int kWidth = 256;
+        static constexpr int kHeight = 128;
+        static const int kLevels = 6;           // 256x128 down to 8x4
+        static const int kBands = 8;            // 16 rows each
+
+        // Rasterizes on the calling thread alone when jobs is null
+        explicit OcclusionCuller(JobSystem* jobs = nullptr);
+
+        // Starts a frame: drops last frame's occluders and takes the camera (a standard
+        // perspective projection, as in LightClusters)
+        void Begin(const glm::mat4& view, const glm::mat4& proj);
+
+        // Adds the 12 triangles of an axis-aligned box
+        void AddOccluderBox(const glm::vec3& min, const glm::vec3& max);
+
+        // Rasterizes every occluder and builds the hierarchy; adds its time to stats.occlusionMs
+        void Rasterize(FrameStats& stats);
+
+        // False only when the sphere is certainly behind the occluders. Spheres reaching behind
+        // the near plane or off screen count as visible; frustum culling handles those.
+        bool IsVisible(const glm::vec3& center, float radius) const;
+
+        size_t OccluderTriangles() const { return triangles_.size(); }
+
+        // Window-space depth (0 near, 1 far), row 0 at the bottom; level 0 is full resolution
+        const float* Depth(int level) const { return levels_[level].data(); }
+
+    private:
+        // Window-space vertices: x, y in buffer pixels, z = depth
+        struct ScreenTriangle {
+            glm::vec3 v[3];
+        };
+
+        void AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+        void RasterizeBand(int band);
+        void BuildHierarchy();
+
+        JobSystem* jobs_;
+        glm::mat4 view_ = glm::mat4(1.0f);
+        glm::mat4 viewProj_ = glm::mat4(1.0f);
+        float projX_ = 1.0f, projY_ = 1.0f;     // proj[0][0], proj[1][1]
+        float projZ_ = -1.0f, projW_ = -0.2f;   // proj[2][2], proj[3][2]
+        float zNear_ = 0.1f;
+        std::vector<ScreenTriangle> triangles_;
+        std::vector<float> levels_[kLevels];
+    };
+
+} // namespace game
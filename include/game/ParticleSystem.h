@@ -10,12 +10,18 @@ public:
     ~ParticleSystem();
 
     void Init();
+
+    // Init without the particle program (shader 0), for headless runs on RecordingRenderDevice
+    // where there is no GL context to compile it in
+    void InitHeadless();
     void Update(float dt);
     void Render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& camPos);
 
     void CreateExplosion(const glm::vec3& position, const glm::vec4& color, int count = 30);
     void CreateTrail(const glm::vec3& position, const glm::vec4& color);
 
+    int AliveCount() const;
+
 private:
     struct Particle {
         glm::vec3 position;
@@ -27,7 +33,8 @@ private:
         Particle() : position(0), velocity(0), color(1), life(0), size(0.1f) {}
     };
 
-    void InitGL();
+    void InitShaders();
+    void InitBuffers();
     int FindUnusedParticle();
 
     std::vector<Particle> particles_;
@@ -0,0 +1,68 @@
+#pragma once
+#include "game/FrameStats.h"
+#include <chrono>
+#include <cstddef>
+
+namespace game {
+
+    class UIRenderer;
+
+    // CPU phases timed every frame. Update contains AI, Physics and Particles.
+    enum class PerfPhase {
+        Update, AI, Physics, Particles, Scene, UI, Count
+    };
+
+    // Heap allocations made through operator new since startup (all threads)
+    size_t heapAllocationCount();
+
+    // Toggleable overlay with the frame time graph, per-phase CPU times and render counters.
+    // Everything is drawn as one UIRenderer batch; the HUD times itself and shows that too.
+    class PerfHud {
+    public:
+        static const int kHistory = 120;
+
+        // Adds the enclosed scope to a phase of the current frame
+        class Scope {
+        public:
+            Scope(PerfHud& hud, PerfPhase phase)
+                : hud_(hud), phase_(phase), start_(std::chrono::steady_clock::now()) {}
+            ~Scope() {
+                std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start_;
+                hud_.phaseMs_[(int)phase_] += ms.count();
+            }
+
+        private:
+            PerfHud& hud_;
+            PerfPhase phase_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+        void Toggle() { visible_ = !visible_; }
+        bool Visible() const { return visible_; }
+
+        // Starts a frame: clears the phase times and snapshots the allocation counter
+        void BeginFrame();
+
+        // Closes the frame with its wall time and the counters gathered while it ran
+        void EndFrame(double frameMs, const FrameStats& stats, int particlesAlive, int boltsAlive);
+
+        void Render(UIRenderer& ui, float x, float y);
+
+    private:
+        bool visible_ = false;
+        double phaseMs_[(int)PerfPhase::Count] = {};
+        size_t allocationsAtBegin_ = 0;
+
+        // Last completed frame
+        double shownPhaseMs_[(int)PerfPhase::Count] = {};
+        FrameStats stats_;
+        int particles_ = 0;
+        int bolts_ = 0;
+        size_t allocations_ = 0;
+        double hudMs_ = 0.0;
+
+        double frameMs_[kHistory] = {};
+        int historyHead_ = 0;
+    };
+
+} // namespace game
@@ -1,40 +1,162 @@
 #pragma once
+#include "game/FrameStats.h"
+#include "game/GpuTimer.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
 namespace game {
 
+    // Deferred shading targets. There is no position target: the lighting pass rebuilds
+    // positions from depth. Lighting accumulates linear color into lightTexture, which shares
+    // the depth buffer so forward draws (blended, overlay, particles) can go on top of it.
     class GBuffer {
     public:
+        // Units the lighting pass samples the targets from (0 = scene textures, 1 = shadow map)
+        static const GLuint kAlbedoUnit = 2;
+        static const GLuint kNormalUnit = 3;
+        static const GLuint kDepthUnit = 4;
+
+        GBuffer() = default;
+        ~GBuffer();
+
+        GBuffer(const GBuffer&) = delete;
+        GBuffer& operator=(const GBuffer&) = delete;
+
+        // (Re)creates every target at the given size; throws std::runtime_error when the
+        // framebuffers are incomplete
         void Init(int width, int height);
+
+        // Fill pass: binds and clears the G-buffer
         void BindForWriting();
+
+        // Lighting pass: binds the light target alone and the G-buffer textures on their units
         void BindForReading();
 
-        GLuint positionTexture;
-        GLuint normalTexture;
-        GLuint albedoTexture;
-        GLuint metallicRoughnessTexture;
-        GLuint fbo;
+        // Forward passes: the light target with the G-buffer depth attached
+        void BindForForward();
+
+        int Width() const { return width_; }
+        int Height() const { return height_; }
+
+        GLuint albedoTexture = 0;   // RGBA8: rgb base color, a = MaterialTable row / 255
+        GLuint normalTexture = 0;   // RGBA16F: xyz world normal, w = emissive
+        GLuint depthTexture = 0;    // DEPTH_COMPONENT24
+        GLuint lightTexture = 0;    // RGBA16F: linear lit color
+        GLuint fbo = 0;
+        GLuint lightFbo = 0;
+        GLuint forwardFbo = 0;
+
+    private:
+        void Release();
+
+        int width_ = 0;
+        int height_ = 0;
     };
 
+    // GPU-timed stages of PostProcessor::Apply
+    enum class PostStage { BloomDown, BloomUp, Volumetric, Final, Count };
+
+    // HDR post chain: a bloom pyramid from half resolution down, light shafts at reduced
+    // resolution, then one full-screen pass that adds both, tonemaps, runs FXAA and
+    // gamma-corrects into the default framebuffer.
+    // Forward frames draw into the scene target; deferred frames pass their light target.
     class PostProcessor {
     public:
+        static const int kBloomLevels = 5;      // 1/2 .. 1/32 of the screen
+        static const int kVolumetricDivisor = 2;    // light shafts at 1/2 (or 4 for 1/4) resolution
+
+        // Takes ownership of the programs, all drawn with fullscreen.vert: bloom_down.frag,
+        // bloom_up.frag, volumetric_source.frag, VolumetricLight.frag and tonemap_fxaa.frag
+        PostProcessor(GLuint downsampleProgram, GLuint upsampleProgram, GLuint shaftSourceProgram,
+            GLuint shaftProgram, GLuint finalProgram);
+        ~PostProcessor();
+
+        PostProcessor(const PostProcessor&) = delete;
+        PostProcessor& operator=(const PostProcessor&) = delete;
+
+        // (Re)creates the scene target and the bloom chain; throws std::runtime_error when the
+        // framebuffers are incomplete
         void Init(int width, int height);
 
+        // Size of the default framebuffer the final pass writes. The targets may be smaller
+        // (dynamic resolution); the final pass then upscales them and sharpens the result.
+        // 0 x 0, the default, means the targets' own size.
+        void SetOutputSize(int width, int height);
+
+        // Binds the RGBA16F scene target and clears it to the (gamma-space) background
+        void BeginScene(const glm::vec3& background);
+
+        // Light shafts for this frame's Apply from a world-space light; no shafts are drawn in
+        // frames without a call. Lights behind the camera are skipped, lights off screen fade out.
+        void SetVolumetricLight(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& position,
+            const glm::vec3& color);
+
         // Effects
-        void ApplyBloom(GLuint sourceTexture);
-        void ApplyToneMapping(GLuint hdrTexture, float exposure);
-        void ApplyFXAA(GLuint sourceTexture);
+        // Thresholded downsample chain, then tent-filtered upsamples accumulated back into
+        // the half-resolution level
+        void ApplyBloom(GLuint hdrTexture);
+        // Screen-space shafts from the SetVolumetricLight light: the sky, highlights and the
+        // light's own disc are blurred radially at kVolumetricDivisor resolution, with a dithered
+        // adaptive sample count and a reprojected history to hide the low sample count
+        void ApplyVolumetricLight(GLuint hdrTexture, GLuint depthTexture);
+        // Bloom and shaft composite, ACES tonemap, FXAA and gamma in one pass to the default
+        // framebuffer. FXAA works on tonemapped taps, so it cannot run as a separate pass without
+        // another full-screen LDR target. The shafts are upsampled against depthTexture.
+        void ApplyToneMappingFXAA(GLuint hdrTexture, GLuint depthTexture, float exposure);
+
+        // All three effects, each stage timed on the GPU
+        void Apply(GLuint hdrTexture, GLuint depthTexture, float exposure, FrameStats& stats);
 
-        GLuint GetFinalTexture() const { return finalTexture_; }
+        GLuint SceneTexture() const { return sceneTexture_; }
+        GLuint SceneDepth() const { return sceneDepth_; }
+        int Width() const { return width_; }
+        int Height() const { return height_; }
 
     private:
-        void CreateFramebuffer();
-        void CreateBloomBuffers();
+        void Release();
+        void BeginStage(PostStage stage);
+        void EndStage();
+
+        GLuint downsampleProgram_ = 0, upsampleProgram_ = 0, finalProgram_ = 0;
+        GLint downTexel_ = -1, downThreshold_ = -1, upTexel_ = -1;
+        GLint finalTexel_ = -1, finalExposure_ = -1, finalBloomStrength_ = -1;
+        GLint finalShaftSize_ = -1, finalDepthParams_ = -1, finalSharpness_ = -1;
+        GLuint shaftSourceProgram_ = 0, shaftProgram_ = 0;
+        GLint sourceLightPos_ = -1, sourceLightColor_ = -1, sourceLightDepth_ = -1, sourceAspect_ = -1;
+        GLint shaftLightPos_ = -1, shaftTargetSize_ = -1, shaftDepthParams_ = -1;
+        GLint shaftReproject_ = -1, shaftFrame_ = -1, shaftHistoryWeight_ = -1;
+        GLuint emptyVao_ = 0;
+
+        GLuint sceneTexture_ = 0, sceneDepth_ = 0, sceneFbo_ = 0;
+        GLuint bloomTextures_[kBloomLevels] = {};
+        GLuint bloomFbos_[kBloomLevels] = {};
+        int bloomWidth_[kBloomLevels] = {};
+        int bloomHeight_[kBloomLevels] = {};
+        GLuint shaftSourceTexture_ = 0, shaftSourceFbo_ = 0;
+        GLuint shaftTextures_[2] = {};          // rgb shafts, a = linear depth; current and history
+        GLuint shaftFbos_[2] = {};
+        int shaftWidth_ = 0, shaftHeight_ = 0;
+        int shaftCurrent_ = 0;
+        int width_ = 0;
+        int height_ = 0;
+        int outputWidth_ = 0;
+        int outputHeight_ = 0;
+
+        GpuTimer timer_{ (int)PostStage::Count };  // GL_TIME_ELAPSED per stage
+        bool timing_ = false;                   // only Apply() wraps the stages in queries
+        double stageMs_[(int)PostStage::Count] = {};
 
-        GLuint finalTexture_;
-        GLuint bloomTexture_;
-        // ... more buffers
+        // Set by SetVolumetricLight, consumed by the next Apply
+        bool shaftsActive_ = false;
+        bool shaftsDrawn_ = false;              // this frame's shafts exist for the final pass
+        bool historyValid_ = false;
+        glm::mat4 viewProj_ = glm::mat4(1.0f);
+        glm::mat4 prevViewProj_ = glm::mat4(1.0f);
+        glm::vec2 depthParams_ = glm::vec2(0.1f, 100.0f);   // near, far
+        glm::vec2 lightScreenPos_ = glm::vec2(0.0f);
+        glm::vec4 lightColor_ = glm::vec4(0.0f);            // rgb, a = disc radius in screen heights
+        float lightDepth_ = 1.0f;
+        unsigned frameIndex_ = 0;
     };
 
 } // namespace game
\ No newline at end of file
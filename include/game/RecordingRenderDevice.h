@@ -0,0 +1,139 @@
+#pragma once
+#include "game/RenderDevice.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace game {
+
+    enum class RenderOp : uint8_t {
+        GenBuffer, GenVertexArray, GenQuery, DeleteBuffer, DeleteVertexArray, DeleteTexture, DeleteProgram,
+        DeleteQuery,
+        UseProgram, BindVertexArray, BindBuffer, BindBufferBase, ActiveTexture, BindTexture,
+        Enable, Disable, BlendFunc, DepthMask, DepthFunc, CullFace, LineWidth, Viewport,
+        BufferData, BufferSubData, CopyBufferSubData,
+        EnableVertexAttrib, VertexAttribPointer, VertexAttribDivisor,
+        Uniform, BindFramebuffer, BlitFramebuffer, ClearColor, Clear,
+        DrawArrays, DrawElements, DrawElementsInstanced, BeginQuery, EndQuery, QueryCounter,
+        QueryResultAvailable
+    };
+
+    // One logged call. Arguments are the GL names/enums/counts; uniform values and buffer
+    // contents are not copied, only their sizes.
+    struct RenderCommand {
+        RenderOp op;
+        uint32_t a, b, c;
+    };
+
+    // Null backend: no GPU work, every call is counted and (optionally) appended to a log.
+    // Meant for headless perf regression runs, so each call is a counter bump and a push_back.
+    class RecordingRenderDevice : public RenderDevice {
+    public:
+        struct Counters {
+            int drawCalls = 0;
+            size_t instances = 0;           // 1 per non-instanced draw
+            size_t vertices = 0;            // indices or array vertices, times instances
+            int stateChanges = 0;           // bindings + fixed-function state
+            int uniformCalls = 0;
+            size_t uploadedBytes = 0;       // BufferData with data + BufferSubData
+            int bufferAllocations = 0;      // BufferData calls (including orphaning)
+        };
+
+        explicit RecordingRenderDevice(bool keepLog = true);
+
+        // Clears the log and counters; call once per frame
+        void BeginFrame();
+
+        const Counters& FrameCounters() const { return counters_; }
+        const std::vector<RenderCommand>& Log() const { return log_; }
+        size_t Count(RenderOp op) const;
+
+        GLuint GenBuffer() override;
+        GLuint GenVertexArray() override;
+        GLuint GenQuery() override;
+        void DeleteBuffer(GLuint buffer) override { Record(RenderOp::DeleteBuffer, buffer); }
+        void DeleteVertexArray(GLuint vao) override { Record(RenderOp::DeleteVertexArray, vao); }
+        void DeleteTexture(GLuint texture) override { Record(RenderOp::DeleteTexture, texture); }
+        void DeleteProgram(GLuint program) override { Record(RenderOp::DeleteProgram, program); }
+        void DeleteQuery(GLuint query) override { Record(RenderOp::DeleteQuery, query); }
+
+        void UseProgram(GLuint program) override { State(RenderOp::UseProgram, program); }
+        void BindVertexArray(GLuint vao) override { State(RenderOp::BindVertexArray, vao); }
+        void BindBuffer(GLenum target, GLuint buffer) override { State(RenderOp::BindBuffer, target, buffer); }
+        void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override {
+            State(RenderOp::BindBufferBase, target, index, buffer);
+        }
+        void ActiveTexture(GLuint unit) override { State(RenderOp::ActiveTexture, unit); }
+        void BindTexture(GLenum target, GLuint texture) override { State(RenderOp::BindTexture, target, texture); }
+        void SetEnabled(GLenum cap, bool enabled) override { State(enabled ? RenderOp::Enable : RenderOp::Disable, cap); }
+        void BlendFunc(GLenum src, GLenum dst) override { State(RenderOp::BlendFunc, src, dst); }
+        void DepthMask(bool write) override { State(RenderOp::DepthMask, write ? 1u : 0u); }
+        void DepthFunc(GLenum func) override { State(RenderOp::DepthFunc, func); }
+        void CullFace(GLenum face) override { State(RenderOp::CullFace, face); }
+        void LineWidth(float width) override { State(RenderOp::LineWidth, (uint32_t)width); }
+        void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) override {
+            (void)x; (void)y;
+            State(RenderOp::Viewport, (uint32_t)width, (uint32_t)height);
+        }
+
+        void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+        void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+        void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+            GLintptr writeOffset, GLsizeiptr size) override;
+        void EnableVertexAttrib(GLuint index) override { Record(RenderOp::EnableVertexAttrib, index); }
+        void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+            GLsizei stride, const void* offset) override;
+        void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
+            const void* offset) override;
+        void VertexAttribDivisor(GLuint index, GLuint divisor) override { Record(RenderOp::VertexAttribDivisor, index, divisor); }
+
+        void Uniform1i(GLint location, GLint) override { Uniform(location, 1); }
+        void Uniform1f(GLint location, GLfloat) override { Uniform(location, 1); }
+        void Uniform2fv(GLint location, GLsizei count, const GLfloat*) override { Uniform(location, count); }
+        void Uniform3fv(GLint location, GLsizei count, const GLfloat*) override { Uniform(location, count); }
+        void Uniform4fv(GLint location, GLsizei count, const GLfloat*) override { Uniform(location, count); }
+        void UniformMatrix4fv(GLint location, GLsizei count, GLboolean, const GLfloat*) override { Uniform(location, count); }
+
+        void BeginQuery(GLenum target, GLuint query) override { Record(RenderOp::BeginQuery, target, query); }
+        void EndQuery(GLenum target) override { Record(RenderOp::EndQuery, target); }
+        void QueryCounter(GLuint query, GLenum target) override { Record(RenderOp::QueryCounter, target, query); }
+        // Nothing runs on a GPU, so no result ever arrives and callers keep their CPU timings
+        bool QueryResultAvailable(GLuint query) override {
+            Record(RenderOp::QueryResultAvailable, query);
+            return false;
+        }
+        GLuint64 GetQueryResult64(GLuint) override { return 0; }
+
+        void BindFramebuffer(GLenum target, GLuint fbo) override { State(RenderOp::BindFramebuffer, target, fbo); }
+        void BlitFramebuffer(GLint, GLint, GLint srcX1, GLint srcY1, GLint, GLint, GLint, GLint,
+            GLbitfield mask, GLenum) override {
+            Record(RenderOp::BlitFramebuffer, (uint32_t)srcX1, (uint32_t)srcY1, mask);
+        }
+        void ClearColor(GLfloat, GLfloat, GLfloat, GLfloat) override { Record(RenderOp::ClearColor); }
+        void Clear(GLbitfield mask) override { Record(RenderOp::Clear, mask); }
+        void DrawArrays(GLenum mode, GLint first, GLsizei count) override;
+        void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLint baseVertex) override;
+        void DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLsizei instanceCount, GLint baseVertex) override;
+
+    private:
+        void Record(RenderOp op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+            if (keepLog_) log_.push_back({ op, a, b, c });
+        }
+        void State(RenderOp op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+            counters_.stateChanges++;
+            Record(op, a, b, c);
+        }
+        void Uniform(GLint location, GLsizei count) {
+            counters_.uniformCalls++;
+            Record(RenderOp::Uniform, (uint32_t)location, (uint32_t)count);
+        }
+
+        bool keepLog_;
+        std::vector<RenderCommand> log_;
+        Counters counters_;
+        GLuint nextName_ = 1;
+    };
+
+} // namespace game
@@ -0,0 +1,90 @@
+#pragma once
+#include <GL/glew.h>
+
+namespace game {
+
+    // Every GL call a frame makes, behind one interface so the same render code can run on the
+    // OpenGL backend or on a recording backend (RecordingRenderDevice) without a GPU.
+    // State calls arrive here after GLStateCache has dropped the redundant ones.
+    // Not covered: shader compilation, texture uploads and render-target creation (textures,
+    // framebuffers). Most of that runs once at init, but Game re-runs GBuffer::Init and
+    // PostProcessor::Init on window resizes and dynamic-resolution scale changes, so those
+    // reallocations issue raw GL mid-frame, outside the device.
+    class RenderDevice {
+    public:
+        virtual ~RenderDevice() = default;
+
+        // Objects
+        virtual GLuint GenBuffer() = 0;
+        virtual GLuint GenVertexArray() = 0;
+        virtual GLuint GenQuery() = 0;
+        virtual void DeleteBuffer(GLuint buffer) = 0;
+        virtual void DeleteVertexArray(GLuint vao) = 0;
+        virtual void DeleteTexture(GLuint texture) = 0;
+        virtual void DeleteProgram(GLuint program) = 0;
+        virtual void DeleteQuery(GLuint query) = 0;
+
+        // Bindings and fixed-function state
+        virtual void UseProgram(GLuint program) = 0;
+        virtual void BindVertexArray(GLuint vao) = 0;
+        virtual void BindBuffer(GLenum target, GLuint buffer) = 0;
+        virtual void BindBufferBase(GLenum target, GLuint index, GLuint buffer) = 0;
+        virtual void ActiveTexture(GLuint unit) = 0;
+        virtual void BindTexture(GLenum target, GLuint texture) = 0;
+        virtual void SetEnabled(GLenum cap, bool enabled) = 0;
+        virtual void BlendFunc(GLenum src, GLenum dst) = 0;
+        virtual void DepthMask(bool write) = 0;
+        virtual void DepthFunc(GLenum func) = 0;
+        virtual void CullFace(GLenum face) = 0;
+        virtual void LineWidth(float width) = 0;
+        virtual void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+
+        // Buffer contents and vertex layout (on the bound buffer / VAO)
+        virtual void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) = 0;
+        virtual void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+        virtual void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+            GLintptr writeOffset, GLsizeiptr size) = 0;
+        virtual void EnableVertexAttrib(GLuint index) = 0;
+        virtual void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+            GLsizei stride, const void* offset) = 0;
+        virtual void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
+            const void* offset) = 0;
+        virtual void VertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+        // Uniforms of the bound program
+        virtual void Uniform1i(GLint location, GLint value) = 0;
+        virtual void Uniform1f(GLint location, GLfloat value) = 0;
+        virtual void Uniform2fv(GLint location, GLsizei count, const GLfloat* value) = 0;
+        virtual void Uniform3fv(GLint location, GLsizei count, const GLfloat* value) = 0;
+        virtual void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) = 0;
+        virtual void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
+
+        // GPU timer queries (GL_TIME_ELAPSED, GL_TIMESTAMP). Results are polled, never waited
+        // for: GetQueryResult64 is only valid once QueryResultAvailable has returned true.
+        virtual void BeginQuery(GLenum target, GLuint query) = 0;
+        virtual void EndQuery(GLenum target) = 0;
+        virtual void QueryCounter(GLuint query, GLenum target) = 0;
+        virtual bool QueryResultAvailable(GLuint query) = 0;
+        virtual GLuint64 GetQueryResult64(GLuint query) = 0;
+
+        // Framebuffer and draws
+        virtual void BindFramebuffer(GLenum target, GLuint fbo) = 0;
+        virtual void BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+            GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) = 0;
+        virtual void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) = 0;
+        virtual void Clear(GLbitfield mask) = 0;
+        virtual void DrawArrays(GLenum mode, GLint first, GLsizei count) = 0;
+        virtual void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLint baseVertex) = 0;
+        virtual void DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLsizei instanceCount, GLint baseVertex) = 0;
+    };
+
+    // The active backend; the OpenGL one unless another was installed
+    RenderDevice& renderDevice();
+
+    // Installs a backend (nullptr restores OpenGL). The caller keeps ownership. Switch between
+    // frames only, and call glState().Invalidate() afterwards.
+    void setRenderDevice(RenderDevice* device);
+
+} // namespace game
@@ -0,0 +1,116 @@
+#pragma once
+#include "game/MeshUtils.h"
+#include "game/InstanceBuffer.h"
+#include "game/FrameStats.h"
+#include "game/Frustum.h"
+#include "game/OcclusionCuller.h"
+#include <cstdint>
+#include <vector>
+
+namespace game {
+
+    // Fixed-function state bucket, also the most significant part of the sort key
+    enum class RenderPass : uint8_t {
+        Opaque = 0,         // back faces culled, depth write
+        DoubleSided = 1,    // no culling
+        NoDepthWrite = 2,   // no culling, depth tested but not written
+        Overlay = 3         // back faces culled, no depth test, drawn last
+    };
+
+    // Uniform locations of a program the queue can draw with (basic.vert/basic.frag). Every
+    // draw is instanced: model matrix, color, texture layer and material come from InstanceData.
+    struct SceneProgram {
+        GLuint program = 0;
+        GLint posScale = -1, posOffset = -1, octNormals = -1;
+    };
+
+    // Texture of a draw: a layer of a TextureArray, or none. Only the array is bound; the
+    // layer travels with the instance, so draws on different layers still batch.
+    struct SurfaceTexture {
+        GLuint array = 0;
+        int layer = -1;
+    };
+
+    // One recorded draw. Key layout, most significant first:
+    //   pass:2 | program:4 | texture:6 | mesh:8 | lod:2 | material:10 | view depth:32
+    // so state changes are grouped and each group is drawn front to back. The material
+    // (MaterialTable row) is per instance and only orders draws within a batch.
+    struct DrawPacket {
+        uint64_t key;
+        const SceneProgram* program;
+        const Mesh* mesh;
+        GLuint texture;             // texture array, 0 = none
+        uint8_t lod;
+        RenderPass pass;
+        glm::vec4 sphere;           // world-space bounds, xyz = center, w = radius
+        InstanceData instance;
+    };
+
+    // Packets recorded off the GL thread (one list per worker chunk). Touches no GL and no shared
+    // state, so lists can be filled in parallel; RenderQueue::Append merges them.
+    class DrawList {
+    public:
+        void Clear() { packets_.clear(); }
+
+        void Add(RenderPass pass, const SceneProgram& program, SurfaceTexture texture,
+            const Mesh& mesh, int lod, uint16_t material,
+            const glm::mat4& model, const glm::vec4& colorEmissive, float viewDepth);
+
+        size_t Size() const { return packets_.size(); }
+
+    private:
+        friend class RenderQueue;
+        std::vector<DrawPacket> packets_;
+    };
+
+    class RenderQueue {
+    public:
+        explicit RenderQueue(InstanceBuffer& instances);
+
+        void Clear();
+
+        void Submit(RenderPass pass, const SceneProgram& program, SurfaceTexture texture,
+            const Mesh& mesh, int lod, uint16_t material,
+            const glm::mat4& model, const glm::vec4& colorEmissive, float viewDepth);
+
+        // Copies a recorded list in and assigns its state ids; GL thread only
+        void Append(const DrawList& list);
+
+        // Drops packets whose bounding sphere is outside the frustum (SIMD, see cullSpheres),
+        // then, given an occlusion buffer, those hidden behind its occluders. Overlay packets
+        // ignore depth and are never occlusion culled.
+        void Cull(const Frustum& frustum, const OcclusionCuller* occlusion, FrameStats& stats);
+
+        // LSD radix sort on the keys, 8 bits per pass; passes where every key shares the digit are skipped
+        void Sort();
+
+        // Uploads all instance data once, then issues one instanced draw per run of packets that
+        // share pass, program, texture array, mesh and LOD. Program/texture/VAO/pass state is
+        // only touched when its key segment changes.
+        void Execute(FrameStats& stats) { Execute(stats, RenderPass::Opaque, RenderPass::Overlay); }
+
+        // Draws only the packets whose pass lies in [first, last]; passes are the top key bits, so
+        // the range is contiguous. Instances are still uploaded once per Sort.
+        void Execute(FrameStats& stats, RenderPass first, RenderPass last);
+
+        size_t Size() const { return packets_.size(); }
+
+    private:
+        static uint32_t SmallId(std::vector<uintptr_t>& table, uintptr_t value);
+        static void ApplyPass(RenderPass pass);
+        void AssignIds(DrawPacket& p);
+
+        InstanceBuffer& instances_;
+        std::vector<DrawPacket> packets_;
+        std::vector<uint32_t> order_, orderScratch_;
+        std::vector<uint64_t> keys_, keysScratch_;
+        std::vector<InstanceData> instanceData_;
+        bool instancesUploaded_ = false;
+        std::vector<float> cullX_, cullY_, cullZ_, cullRadius_;
+        std::vector<uint8_t> cullVisible_;
+
+        // Per-frame dense ids for the key segments
+        std::vector<uintptr_t> programIds_, textureIds_, meshIds_;
+    };
+
+} // namespace game
@@ -2,21 +2,38 @@
 #define SHADER_H
 
 #include <GL/glew.h>
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include "game/ShaderManager.h"
+#include "game/Hash.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// A uniform name and its hash. Declared constexpr, the hash is computed by the compiler:
+//     static constexpr UniformName kModel("uModel");
+// String literals convert implicitly too; those hash at the call site but never query the GL.
+struct UniformName {
+    constexpr UniformName(const char* n) : hash(game::hashLiteral(n)), name(n) {}
+
+    uint64_t hash;
+    const char* name;
+};
+
 class Shader {
 public:
     GLuint ID;
 
-    Shader() : ID(0) {}
+    Shader() : ID(0), table_(1, -1) {}
 
     ~Shader() {
-        if (ID) glDeleteProgram(ID);
+        game::glState().DeleteProgram(ID);
     }
 
     // Load shaders from file paths
@@ -37,32 +54,47 @@ public:
     }
 
     void Use() const {
-        glUseProgram(ID);
+        game::glState().UseProgram(ID);
     }
 
-    // Utility uniform functions
-    void SetBool(const std::string& name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    // Uniform setters. Names are found through the table built at link time (one hash probe,
+    // no glGetUniformLocation), and a value equal to the last one set is not uploaded again.
+    // The program must be bound, as with glUniform*; setting this program's uniforms any other
+    // way leaves the cached values stale.
+    void SetBool(const UniformName& name, bool value) { Set(Find(name), value); }
+    void SetInt(const UniformName& name, int value) { Set(Find(name), value); }
+    void SetFloat(const UniformName& name, float value) { Set(Find(name), value); }
+    void SetVec3(const UniformName& name, const glm::vec3& value) { Set(Find(name), value); }
+    void SetVec4(const UniformName& name, const glm::vec4& value) { Set(Find(name), value); }
+    void SetMat4(const UniformName& name, const glm::mat4& value) { Set(Find(name), value); }
+
+    // Index of an active uniform for the Set(int, ...) overloads, or -1 (inactive or unknown,
+    // which the setters ignore). Arrays are found by their plain name.
+    int Find(const UniformName& name) const {
+        size_t mask = table_.size() - 1;
+        for (size_t s = (size_t)name.hash & mask;; s = (s + 1) & mask) {
+            int i = table_[s];
+            if (i < 0 || uniforms_[(size_t)i].hash == name.hash) return i;
+        }
     }
 
-    void SetInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    void Set(int slot, bool value) { Set(slot, (int)value); }
+    void Set(int slot, int value) {
+        if (Changed(slot, value)) game::renderDevice().Uniform1i(uniforms_[(size_t)slot].location, value);
     }
-
-    void SetFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void Set(int slot, float value) {
+        if (Changed(slot, value)) game::renderDevice().Uniform1f(uniforms_[(size_t)slot].location, value);
     }
-
-    void SetVec3(const std::string& name, const glm::vec3& value) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    void Set(int slot, const glm::vec3& value) {
+        if (Changed(slot, value)) game::renderDevice().Uniform3fv(uniforms_[(size_t)slot].location, 1, glm::value_ptr(value));
     }
-
-    void SetVec4(const std::string& name, const glm::vec4& value) const {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    void Set(int slot, const glm::vec4& value) {
+        if (Changed(slot, value)) game::renderDevice().Uniform4fv(uniforms_[(size_t)slot].location, 1, glm::value_ptr(value));
     }
-
-    void SetMat4(const std::string& name, const glm::mat4& mat) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    void Set(int slot, const glm::mat4& value) {
+        if (Changed(slot, value)) {
+            game::renderDevice().UniformMatrix4fv(uniforms_[(size_t)slot].location, 1, GL_FALSE, glm::value_ptr(value));
+        }
     }
 
 private:
@@ -78,56 +110,76 @@ private:
         return buffer.str();
     }
 
+    // Goes through the program cache, keyed by the sources since a Shader has no name
     bool CompileAndLink(const char* vertexSource, const char* fragmentSource) {
-        GLuint vertex = CompileShader(GL_VERTEX_SHADER, vertexSource);
-        if (vertex == 0) return false;
-
-        GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
-        if (fragment == 0) {
-            glDeleteShader(vertex);
-            return false;
+        try {
+            GLuint program = game::shaderManager().Build("", vertexSource, fragmentSource);
+            game::glState().DeleteProgram(ID);
+            ID = program;
+            Reflect();
+            return true;
         }
-
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-
-        GLint success;
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetProgramInfoLog(ID, 512, NULL, infoLog);
-            std::cerr << "ERROR: Shader program linking failed\n" << infoLog << std::endl;
-            glDeleteShader(vertex);
-            glDeleteShader(fragment);
+        catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
             return false;
         }
-
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        return true;
     }
 
-    GLuint CompileShader(GLenum type, const char* source) {
-        GLuint shader = glCreateShader(type);
-        glShaderSource(shader, 1, &source, NULL);
-        glCompileShader(shader);
-
-        GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char infoLog[512];
-            glGetShaderInfoLog(shader, 512, NULL, infoLog);
-            std::cerr << "ERROR: Shader compilation failed ("
-                << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
-                << ")\n" << infoLog << std::endl;
-            glDeleteShader(shader);
-            return 0;
+    // Active uniforms from the last link, with the value last uploaded to each
+    struct Uniform {
+        uint64_t hash;
+        GLint location;
+        bool valid;
+        unsigned char value[sizeof(glm::mat4)];
+    };
+
+    // Enumerates the active uniforms once and builds an open-addressed table over their name
+    // hashes, at most half full so Find() always reaches an empty slot
+    void Reflect() {
+        uniforms_.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer((size_t)std::max(maxLength, 1));
+        for (GLint i = 0; i < count; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), (size_t)length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0) continue;     // uniform block members
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) name.resize(name.size() - 3);
+
+            Uniform u = {};
+            u.hash = game::hashString(name);
+            u.location = location;
+            uniforms_.push_back(u);
         }
 
-        return shader;
+        size_t capacity = 1;
+        while (capacity < uniforms_.size() * 2) capacity <<= 1;
+        table_.assign(capacity, -1);
+        for (size_t i = 0; i < uniforms_.size(); ++i) {
+            size_t s = (size_t)uniforms_[i].hash & (capacity - 1);
+            while (table_[s] >= 0) s = (s + 1) & (capacity - 1);
+            table_[s] = (int)i;
+        }
     }
+
+    template <typename T>
+    bool Changed(int slot, const T& value) {
+        if (slot < 0) return false;
+        Uniform& u = uniforms_[(size_t)slot];
+        static_assert(sizeof(T) <= sizeof(u.value), "uniform value too large for the cache");
+        if (u.valid && std::memcmp(u.value, &value, sizeof(T)) == 0) return false;
+        std::memcpy(u.value, &value, sizeof(T));
+        u.valid = true;
+        return true;
+    }
+
+    std::vector<Uniform> uniforms_;
+    std::vector<int> table_;
 };
 
 #endif // SHADER_H
\ No newline at end of file
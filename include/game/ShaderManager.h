@@ -0,0 +1,95 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace game {
+
+    // On-disk program binaries (*.gprog): header | driver string | binary blob. The key hashes
+    // both sources; the driver string (vendor, renderer, version) is stored and compared on its
+    // own, so a driver update recompiles instead of handing the GL a binary it may reject.
+    const uint32_t kProgramFileMagic = 0x47525047; // "GPRG"
+    const uint32_t kProgramFileVersion = 1;
+
+    struct ProgramFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t driverLength;
+        uint32_t binaryFormat;
+        uint64_t binarySize;
+    };
+
+    // Builds every vertex + fragment program. Linked programs are cached with
+    // glGetProgramBinary and reloaded on the next launch; a missing, stale or rejected binary
+    // falls back to compiling the sources. Request() only issues the GL calls, so programs
+    // requested together compile side by side on drivers with KHR_parallel_shader_compile
+    // and Take() waits for just the one it returns.
+    class ShaderManager {
+    public:
+        explicit ShaderManager(const std::string& directory);
+
+        ShaderManager(const ShaderManager&) = delete;
+        ShaderManager& operator=(const ShaderManager&) = delete;
+
+        // Starts building a program without waiting for it and returns the name to Take() it
+        // by; an empty name is replaced by the key in hex. A name that is still pending keeps
+        // its build when the sources match, otherwise the old build is deleted and replaced.
+        std::string Request(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource);
+
+        // Request() from two files; a file that cannot be read fails the program at Take()
+        void RequestFiles(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath);
+
+        // Waits for a requested program and hands it over (the caller deletes it). Throws
+        // std::runtime_error with the compile or link log when it failed to build.
+        GLuint Take(const std::string& name);
+
+        // Request + Take
+        GLuint Build(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource);
+
+        // Throws std::runtime_error when the file cannot be opened
+        static std::string LoadText(const std::string& path);
+
+        // Startup report: wall time spent on each path, including waits in Take()
+        int CacheHits() const { return cacheHits_; }
+        int Compiled() const { return compiled_; }
+        double CacheMs() const { return cacheMs_; }
+        double CompileMs() const { return compileMs_; }
+        bool ParallelCompile() const { return parallel_; }
+        bool BinaryCache() const { return binaries_; }
+
+    private:
+        struct Pending {
+            uint64_t key = 0;
+            std::string error;          // set instead of the GL objects when loading failed
+            GLuint program = 0;
+            GLuint vertex = 0, fragment = 0;    // 0 when the program came from the cache
+            double ms = 0.0;            // time spent issuing it so far
+        };
+
+        void InitCapabilities();
+        std::string Path(const std::string& name) const;
+        bool TryLoadBinary(const std::string& name, uint64_t key, Pending& out);
+        void WriteBinary(const std::string& name, uint64_t key, GLuint program);
+        // Removes a pending entry and deletes its GL objects
+        void Discard(const std::string& name);
+        static std::string ShaderLog(GLuint shader);
+
+        std::string directory_;
+        std::string driver_;
+        bool initialized_ = false;
+        bool parallel_ = false;
+        bool binaries_ = false;
+        std::unordered_map<std::string, Pending> pending_;
+
+        int cacheHits_ = 0;
+        int compiled_ = 0;
+        double cacheMs_ = 0.0;
+        double compileMs_ = 0.0;
+    };
+
+    // Process-wide manager caching into cache/shaders (GL thread only)
+    ShaderManager& shaderManager();
+
+} // namespace game
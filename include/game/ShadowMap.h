@@ -4,22 +4,44 @@
 
 namespace game {
 
+    // Directional shadow map with a cached layer for static casters. The static map is only
+    // redrawn when invalidated (or the light moves); every frame it is blitted into the sampled
+    // map and the dynamic casters are drawn on top, so a frame pays for a depth copy plus the
+    // few moving objects instead of the whole scene.
     class ShadowMap {
     public:
         ShadowMap(int width = 2048, int height = 2048);
         ~ShadowMap();
 
+        ShadowMap(const ShadowMap&) = delete;
+        ShadowMap& operator=(const ShadowMap&) = delete;
+
+        // Static casters: draw between BeginStaticPass and EndShadowPass when this returns true
+        bool StaticDirty(const glm::mat4& lightSpaceMatrix) const;
+        void InvalidateStatic() { staticDirty_ = true; }
+        void BeginStaticPass(const glm::mat4& lightSpaceMatrix);
+
+        // Dynamic casters: the cached static depth is already in place when this returns
         void BeginShadowPass(const glm::mat4& lightSpaceMatrix);
+
+        // Back to the default framebuffer; the caller restores its viewport
         void EndShadowPass();
         void BindForReading(int textureUnit);
 
         glm::mat4 GetLightSpaceMatrix(const glm::vec3& lightPos,
-            const glm::vec3& targetPos);
+            const glm::vec3& targetPos, float radius = 12.0f);
 
     private:
+        void BeginPass(GLuint fbo);
+
         GLuint fbo_;
         GLuint depthMap_;
+        GLuint staticFbo_;
+        GLuint staticDepthMap_;
         int width_, height_;
+
+        bool staticDirty_ = true;
+        glm::mat4 staticMatrix_{ 0.0f };
     };
 
 } // namespace game
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace game {
+
+    // Surface textures packed into one GL_TEXTURE_2D_ARRAY. Draws that differ only in their
+    // texture then share a binding, and an instanced batch, with the layer going per instance
+    // (InstanceData::surface). Every layer has the array's size and its own mip chain,
+    // box-filtered on the CPU so adding a layer never touches the others.
+    class TextureArray {
+    public:
+        // Storage for initialCapacity layers; Add() doubles it when full
+        TextureArray(int width, int height, int initialCapacity = 4);
+        ~TextureArray();
+
+        TextureArray(const TextureArray&) = delete;
+        TextureArray& operator=(const TextureArray&) = delete;
+
+        // Uploads a width x height RGB8 image and returns its layer. A name that is already
+        // present has its layer overwritten.
+        int Add(const std::string& name, const unsigned char* rgb);
+
+        // -1 for a name that was never added
+        int Layer(const std::string& name) const;
+
+        void Bind(GLuint unit) const;
+
+        // Changes when the array grows; fetch it where it is bound, not once at startup
+        GLuint Id() const { return id_; }
+        int Layers() const { return layers_; }
+        int Capacity() const { return capacity_; }
+
+    private:
+        // New storage for 'capacity' layers; the existing layers are copied over on the GPU
+        void Allocate(int capacity);
+        void Upload(int layer, const unsigned char* rgb);
+
+        GLuint id_ = 0;
+        int width_;
+        int height_;
+        int levels_;
+        int layers_ = 0;
+        int capacity_ = 0;
+        std::unordered_map<std::string, int> names_;
+        std::vector<unsigned char> mips_[2];    // RGBA scratch, current and next level
+    };
+
+} // namespace game
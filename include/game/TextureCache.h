@@ -0,0 +1,51 @@
+#pragma once
+#include "game/TextureGenerator.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace game {
+
+    // On-disk container for generated textures (*.gtex): header | RGB8 pixels
+    const uint32_t kTextureFileMagic = 0x58455447; // "GTEX"
+    const uint32_t kTextureFileVersion = 1;
+
+    struct TextureFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels;
+        uint32_t reserved;
+    };
+
+    // Procedural surfaces keyed by their generator parameters, so startup only pays for
+    // generation the first time a recipe or size is used
+    class TextureCache {
+    public:
+        // Misses generate on jobs (see generateSurface)
+        explicit TextureCache(const std::string& directory, JobSystem* jobs = nullptr);
+
+        // RGB8 pixels from the cache file when its key still matches, otherwise generated
+        // and written to a fresh cache file
+        std::vector<unsigned char> Load(const std::string& name, const SurfaceParams& params);
+
+        // Generator parameters + generator/file versions
+        static uint64_t ComputeKey(const SurfaceParams& params);
+
+        int Hits() const { return hits_; }
+        int Misses() const { return misses_; }
+
+    private:
+        bool TryRead(const std::string& path, uint64_t key, int size, std::vector<unsigned char>& out);
+        bool Write(const std::string& path, uint64_t key, int size, const std::vector<unsigned char>& pixels);
+
+        std::string directory_;
+        JobSystem* jobs_;
+        std::atomic<int> hits_{ 0 };
+        std::atomic<int> misses_{ 0 };
+    };
+
+} // namespace game
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace game {
+
+    class JobSystem;
+
+    // Bump when a surface recipe changes so cached textures are regenerated
+    const unsigned int kTextureGeneratorVersion = 1;
+
+    enum class Surface {
+        Grass,
+        Stone,
+        Metal,
+        Wood
+    };
+
+    struct SurfaceParams {
+        Surface surface = Surface::Grass;
+        int size = 256;
+        uint32_t seed = 1;
+    };
+
+    // "grass size=1024 seed=1"; part of the texture cache key
+    std::string describeSurface(const SurfaceParams& params);
+
+    // Tileable size x size RGB8 pixels built from the noise in Noise.h. Bands of rows run on
+    // the job system, or on the calling thread alone when jobs is null.
+    std::vector<unsigned char> generateSurface(const SurfaceParams& params, JobSystem* jobs = nullptr);
+
+} // namespace game
@@ -2,7 +2,9 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace game {
 
@@ -12,10 +14,17 @@ namespace game {
         ~UIRenderer();
 
         void Init(int screenWidth, int screenHeight);
+
+        // Init without the UI program (shader 0), for headless runs on RecordingRenderDevice
+        // where there is no GL context to compile it in
+        void InitHeadless(int screenWidth, int screenHeight);
         void SetScreenSize(int width, int height);
 
+        // Everything between BeginUI and EndUI is collected into one vertex batch and drawn
+        // with a single call in EndUI (or earlier, when the batch fills up)
         void BeginUI();
         void EndUI();
+        void Flush();
 
         // Basic shapes
         void RenderRect(float x, float y, float width, float height, const glm::vec4& color);
@@ -24,7 +33,12 @@ namespace game {
 
         // Simple bitmap text rendering
         void RenderText(const std::string& text, float x, float y, float scale, const glm::vec3& color);
+        void RenderText(const char* text, float x, float y, float scale, const glm::vec4& color);
         void RenderCenteredText(const std::string& text, float y, float scale, const glm::vec3& color);
+        static float TextWidth(size_t length, float scale) { return length * 7.0f * scale - 2.0f * scale; }
+
+        // Quads drawn by the last Flush calls since BeginUI
+        int QuadsThisPass() const { return quadsThisPass_; }
 
     private:
         void InitShaders();
@@ -34,9 +48,17 @@ namespace game {
         // Render a single character
         void RenderChar(char c, float x, float y, float scale, const glm::vec4& color);
 
+        struct Vertex {
+            float x, y;
+            uint8_t rgba[4];
+        };
+        static const int kMaxQuads = 16384;    // 4 vertices each, so indices fit in 16 bits
+
         GLuint shader_;
-        GLuint vao_, vbo_;
-        GLint uProjection_, uModel_, uColor_;
+        GLuint vao_, vbo_, ebo_;
+        GLint uProjection_;
+        std::vector<Vertex> batch_;
+        int quadsThisPass_;
 
         glm::mat4 projection_;
         int screenWidth_, screenHeight_;
@@ -0,0 +1,66 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+namespace game {
+
+    // Fixed binding points shared by every program that declares the blocks
+    const GLuint kFrameBlockBinding = 0;
+    const GLuint kMaterialBlockBinding = 1;
+    const GLuint kClusterBlockBinding = 2;
+
+    const int kMaxFrameLights = 4;
+    const int kMaxMaterials = 64;
+
+    // std140 mirror of "uniform FrameData" (basic.vert/basic.frag, pbr.vert/pbr.frag).
+    // Only vec4/mat4 members so the C++ and std140 layouts agree without manual padding.
+    struct FrameBlock {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::vec4 viewPos;                          // xyz
+        glm::vec4 lightPosition[kMaxFrameLights];   // xyz
+        glm::vec4 lightColor[kMaxFrameLights];      // rgb
+        glm::ivec4 lightCount;                      // x = lights, y != 0 when light 0 casts shadows,
+                                                    // z != 0 when drawing into the linear deferred target
+        glm::mat4 lightSpace;                       // world to light 0 shadow map clip space
+    };
+    static_assert(sizeof(FrameBlock) == 352, "FrameBlock must match the std140 layout");
+
+    // std140 mirror of "uniform ClusterData" (basic.frag); see LightClusters
+    struct ClusterBlock {
+        glm::ivec4 grid;        // xyz = clusters per axis, w = lights (0 skips the clustered loop)
+        glm::vec4 params;       // x, y = depth slice scale/bias on log(view depth), zw = tile size in pixels
+    };
+    static_assert(sizeof(ClusterBlock) == 32, "ClusterBlock must match the std140 layout");
+
+    // One entry of "uniform MaterialTable"; a draw selects its row with InstanceData::surface.y
+    struct RenderMaterial {
+        float ka, kd, ks, shine;
+    };
+    static_assert(sizeof(RenderMaterial) == 16, "RenderMaterial must be one std140 vec4");
+
+    // A uniform buffer bound to a fixed binding point for its whole lifetime
+    class UniformBuffer {
+    public:
+        UniformBuffer(GLuint binding, size_t size);
+        ~UniformBuffer();
+
+        UniformBuffer(const UniformBuffer&) = delete;
+        UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+        // Orphans and refills the whole buffer; size must not exceed the constructed size
+        void Update(const void* data, size_t size);
+
+        GLuint Binding() const { return binding_; }
+
+    private:
+        GLuint ubo_ = 0;
+        GLuint binding_ = 0;
+        size_t size_ = 0;
+    };
+
+    // Points a program's FrameData/MaterialTable/ClusterData blocks (if present) at the fixed bindings
+    void bindUniformBlocks(GLuint program);
+
+} // namespace game
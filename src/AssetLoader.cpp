@@ -0,0 +1,84 @@
+#include "game/AssetLoader.h"
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+namespace game {
+
+    static double nowMs() {
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    AssetLoader::AssetLoader(JobSystem& jobs, MeshCache& cache)
+        : jobs_(jobs), cache_(cache) {
+    }
+
+    AssetLoader::~AssetLoader() {
+        // Jobs push into completed_, so none may outlive the loader
+        jobs_.WaitIdle();
+    }
+
+    MeshHandle AssetLoader::LoadMesh(const std::string& name, const std::string& sourcePath,
+        const std::string& generatorParams, std::function<MeshData()> build,
+        VertexFormat format, const Mesh& placeholder) {
+        MeshHandle handle = (MeshHandle)slots_.size();
+        Slot slot;
+        slot.mesh = placeholder;
+        slots_.push_back(slot);
+
+        if (pending_++ == 0) firstRequestTime_ = nowMs();
+
+        jobs_.Submit([this, handle, name, sourcePath, generatorParams, build, format] {
+            Completed done;
+            done.handle = handle;
+            // A failed mesh still reports back, so pending_ drains and the handle keeps its placeholder
+            try {
+                done.prepared = cache_.Prepare(name, sourcePath, generatorParams, build, format);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "  Asset loader: " << name << " ("
+                    << (sourcePath.empty() ? "generated" : sourcePath) << ") failed: " << e.what() << "\n";
+                done.failed = true;
+            }
+
+            std::lock_guard<std::mutex> lock(completedMutex_);
+            completed_.push_back(std::move(done));
+        });
+        return handle;
+    }
+
+    void AssetLoader::PumpUploads(double budgetMs) {
+        if (pending_ == 0) return;
+
+        double start = nowMs();
+        for (;;) {
+            Completed done;
+            {
+                std::lock_guard<std::mutex> lock(completedMutex_);
+                if (completed_.empty()) break;
+                done = std::move(completed_.front());
+                completed_.pop_front();
+            }
+
+            if (done.failed) {
+                failed_++;
+            }
+            else {
+                slots_[done.handle].mesh = cache_.Upload(done.prepared);
+                slots_[done.handle].ready = true;
+            }
+            pending_--;
+
+            if (nowMs() - start >= budgetMs) break;
+        }
+
+        if (pending_ == 0) {
+            std::cout << "  Asset loader: " << slots_.size() - failed_ << " meshes ready";
+            if (failed_) std::cout << " (" << failed_ << " failed, left as placeholders)";
+            std::cout << " after " << (int)(nowMs() - firstRequestTime_) << " ms (mesh cache: "
+                << cache_.Hits() << " hits, " << cache_.Misses() << " rebuilt)\n";
+        }
+    }
+
+} // namespace game
@@ -0,0 +1,185 @@
+#include "game/DeferredLighting.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include "game/UniformBlocks.h"
+#include <cmath>
+#include <cstddef>
+
+namespace game {
+
+    // Light volume tessellation; the mesh is scaled out so its flat faces still enclose the
+    // unit sphere, otherwise pixels near the radius would be missed
+    static const int kSphereSegments = 12;
+    static const int kSphereRings = 8;
+
+    static void setSamplers(GLuint program) {
+        glState().UseProgram(program);
+        renderDevice().Uniform1i(glGetUniformLocation(program, "uGAlbedo"), (GLint)GBuffer::kAlbedoUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(program, "uGNormal"), (GLint)GBuffer::kNormalUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(program, "uGDepth"), (GLint)GBuffer::kDepthUnit);
+        bindUniformBlocks(program);
+    }
+
+    DeferredLighting::DeferredLighting(GLuint directionalProgram, GLuint pointProgram, GLuint resolveProgram)
+        : directionalProgram_(directionalProgram), pointProgram_(pointProgram), resolveProgram_(resolveProgram) {
+        setSamplers(directionalProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(directionalProgram_, "uShadowMap"), 1);
+        directionalInvViewProj_ = glGetUniformLocation(directionalProgram_, "uInvViewProj");
+        setSamplers(pointProgram_);
+        pointInvViewProj_ = glGetUniformLocation(pointProgram_, "uInvViewProj");
+        glState().UseProgram(resolveProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(resolveProgram_, "uLight"), (GLint)GBuffer::kAlbedoUnit);
+
+        emptyVao_ = renderDevice().GenVertexArray();
+
+        std::vector<glm::vec3> positions;
+        const float pi = 3.14159265f;
+        const float enclose = 1.0f / (std::cos(pi / kSphereSegments) * std::cos(pi / (2.0f * kSphereRings)));
+        for (int r = 0; r <= kSphereRings; ++r) {
+            float theta = pi * (float)r / kSphereRings;
+            for (int s = 0; s <= kSphereSegments; ++s) {
+                float phi = 2.0f * pi * (float)s / kSphereSegments;
+                positions.push_back(enclose * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                    std::sin(theta) * std::sin(phi)));
+            }
+        }
+        std::vector<uint16_t> indices;
+        const int row = kSphereSegments + 1;
+        for (int r = 0; r < kSphereRings; ++r) {
+            for (int s = 0; s < kSphereSegments; ++s) {
+                uint16_t a = (uint16_t)(r * row + s), b = (uint16_t)((r + 1) * row + s);
+                uint16_t c = (uint16_t)(b + 1), d = (uint16_t)(a + 1);
+                // Counter-clockwise seen from outside, so culling GL_FRONT keeps the far side
+                indices.insert(indices.end(), { a, c, b, a, d, c });
+            }
+        }
+        sphereIndexCount_ = (GLsizei)indices.size();
+
+        sphereVao_ = renderDevice().GenVertexArray();
+        glState().BindVertexArray(sphereVao_);
+        sphereVbo_ = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_ARRAY_BUFFER, sphereVbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(positions.size() * sizeof(glm::vec3)),
+            positions.data(), GL_STATIC_DRAW);
+        renderDevice().EnableVertexAttrib(0);
+        renderDevice().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        sphereEbo_ = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEbo_);
+        renderDevice().BufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint16_t)),
+            indices.data(), GL_STATIC_DRAW);
+
+        lightCapacity_ = 256;
+        lightVbo_ = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_ARRAY_BUFFER, lightVbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(lightCapacity_ * sizeof(PointLight)), nullptr, GL_STREAM_DRAW);
+        renderDevice().EnableVertexAttrib(1);
+        renderDevice().VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(PointLight),
+            (void*)offsetof(PointLight, positionRadius));
+        renderDevice().VertexAttribDivisor(1, 1);
+        renderDevice().EnableVertexAttrib(2);
+        renderDevice().VertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(PointLight),
+            (void*)offsetof(PointLight, color));
+        renderDevice().VertexAttribDivisor(2, 1);
+        glState().BindVertexArray(0);
+    }
+
+    DeferredLighting::~DeferredLighting() {
+        glState().DeleteVertexArray(emptyVao_);
+        glState().DeleteVertexArray(sphereVao_);
+        glState().DeleteBuffer(sphereVbo_);
+        glState().DeleteBuffer(sphereEbo_);
+        glState().DeleteBuffer(lightVbo_);
+        glState().DeleteProgram(directionalProgram_);
+        glState().DeleteProgram(pointProgram_);
+        glState().DeleteProgram(resolveProgram_);
+    }
+
+    void DeferredLighting::UploadLights(const PointLight* lights, size_t count) {
+        while (lightCapacity_ < count) lightCapacity_ *= 2;
+        glState().BindBuffer(GL_ARRAY_BUFFER, lightVbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(lightCapacity_ * sizeof(PointLight)), nullptr, GL_STREAM_DRAW);
+        renderDevice().BufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(count * sizeof(PointLight)), lights);
+    }
+
+    void DeferredLighting::Light(GBuffer& gbuffer, const glm::mat4& viewProj, const Frustum& frustum,
+        const std::vector<PointLight>& lights, const glm::vec3& background, FrameStats& stats) {
+        // Same SoA sphere test as the draw packets
+        size_t n = lights.size();
+        cullX_.resize(n);
+        cullY_.resize(n);
+        cullZ_.resize(n);
+        cullRadius_.resize(n);
+        cullVisible_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            cullX_[i] = lights[i].positionRadius.x;
+            cullY_[i] = lights[i].positionRadius.y;
+            cullZ_[i] = lights[i].positionRadius.z;
+            cullRadius_[i] = lights[i].positionRadius.w;
+        }
+        size_t visible = cullSpheres(frustum, cullX_.data(), cullY_.data(), cullZ_.data(),
+            cullRadius_.data(), n, cullVisible_.data());
+        visible_.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (cullVisible_[i]) visible_.push_back(lights[i]);
+        }
+        stats.lightsVisible += (int)visible;
+        stats.lightsCulled += (int)(n - visible);
+
+        glm::mat4 invViewProj = glm::inverse(viewProj);
+        GLStateCache& gl = glState();
+
+        // The light target is linear; Resolve converts back, so the background survives unchanged
+        gbuffer.BindForReading();
+        renderDevice().ClearColor(std::pow(background.r, 2.2f), std::pow(background.g, 2.2f),
+            std::pow(background.b, 2.2f), 1.0f);
+        renderDevice().Clear(GL_COLOR_BUFFER_BIT);
+
+        gl.Disable(GL_DEPTH_TEST);
+        gl.Disable(GL_CULL_FACE);
+        gl.Disable(GL_BLEND);
+        gl.UseProgram(directionalProgram_);
+        renderDevice().UniformMatrix4fv(directionalInvViewProj_, 1, GL_FALSE, &invViewProj[0][0]);
+        gl.BindVertexArray(emptyVao_);
+        renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+        stats.drawCalls++;
+
+        // Back faces only, without depth testing: the camera may be inside a volume, and the
+        // shader rejects pixels outside the radius anyway
+        if (!visible_.empty()) {
+            UploadLights(visible_.data(), visible_.size());
+            gl.Enable(GL_BLEND);
+            gl.BlendFunc(GL_ONE, GL_ONE);
+            gl.Enable(GL_CULL_FACE);
+            gl.CullFace(GL_FRONT);
+            gl.UseProgram(pointProgram_);
+            renderDevice().UniformMatrix4fv(pointInvViewProj_, 1, GL_FALSE, &invViewProj[0][0]);
+            gl.BindVertexArray(sphereVao_);
+            renderDevice().DrawElementsInstancedBaseVertex(GL_TRIANGLES, sphereIndexCount_, GL_UNSIGNED_SHORT,
+                nullptr, (GLsizei)visible_.size(), 0);
+            stats.drawCalls++;
+            gl.CullFace(GL_BACK);
+            gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            gl.Disable(GL_BLEND);
+        }
+
+        gl.Enable(GL_DEPTH_TEST);
+        gl.Enable(GL_CULL_FACE);
+    }
+
+    void DeferredLighting::Resolve(GBuffer& gbuffer, FrameStats& stats) {
+        GLStateCache& gl = glState();
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, 0);
+        renderDevice().Viewport(0, 0, gbuffer.Width(), gbuffer.Height());
+        gl.Disable(GL_DEPTH_TEST);
+        gl.Disable(GL_CULL_FACE);
+        gl.Disable(GL_BLEND);
+        gl.UseProgram(resolveProgram_);
+        gl.BindTexture(GBuffer::kAlbedoUnit, GL_TEXTURE_2D, gbuffer.lightTexture);
+        gl.BindVertexArray(emptyVao_);
+        renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+        stats.drawCalls++;
+        gl.Enable(GL_DEPTH_TEST);
+        gl.Enable(GL_CULL_FACE);
+    }
+
+} // namespace game
@@ -0,0 +1,62 @@
+#include "game/DynamicResolution.h"
+#include "game/RenderDevice.h"
+#include <cmath>
+
+namespace game {
+
+    // Exponential moving average over roughly the last 10 frames
+    static const double kSmoothing = 0.1;
+    // Steps up only below this fraction of the target, so a scale that just fits stays put
+    static const double kHeadroom = 0.8;
+
+    static float quantize(float scale) {
+        scale = std::round(scale / DynamicResolution::kScaleStep) * DynamicResolution::kScaleStep;
+        return std::min(std::max(scale, DynamicResolution::kMinScale), DynamicResolution::kMaxScale);
+    }
+
+    DynamicResolution::DynamicResolution(double targetMs)
+        : targetMs_(targetMs) {
+    }
+
+    void DynamicResolution::BeginFrame() {
+        if (timer_.Collect()) {
+            gpuMs_ = (double)(timer_.Value(1) - timer_.Value(0)) * 1e-6;
+            gpuTimed_ = true;
+        }
+        renderDevice().QueryCounter(timer_.Query(0), GL_TIMESTAMP);
+    }
+
+    void DynamicResolution::EndFrame() {
+        renderDevice().QueryCounter(timer_.Query(1), GL_TIMESTAMP);
+        timer_.EndFrame();
+    }
+
+    bool DynamicResolution::Update(double cpuMs) {
+        double frameMs = gpuTimed_ ? gpuMs_ : cpuMs;
+        smoothedMs_ = smoothedMs_ > 0.0 ? smoothedMs_ + (frameMs - smoothedMs_) * kSmoothing : frameMs;
+
+        float scale = scale_;
+        if (!enabled_) {
+            scale = 1.0f;
+        }
+        else if (settle_ > 0) {
+            settle_--;
+            return false;
+        }
+        else if (smoothedMs_ > targetMs_) {
+            // Scene cost goes with the pixel count, the square of the scale; aiming a little
+            // under the target keeps the next step up from overshooting straight back
+            float wanted = scale_ * (float)std::sqrt(targetMs_ * 0.9 / smoothedMs_);
+            scale = std::min(quantize(wanted), quantize(scale_ - kScaleStep));
+        }
+        else if (smoothedMs_ < targetMs_ * kHeadroom) {
+            scale = quantize(scale_ + kScaleStep);
+        }
+
+        if (std::abs(scale - scale_) < kScaleStep * 0.5f) return false;
+        scale_ = scale;
+        settle_ = kSettleFrames;
+        return true;
+    }
+
+} // namespace game
@@ -0,0 +1,80 @@
+#include "game/Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define GAME_FRUSTUM_SSE 1
+#endif
+
+namespace game {
+
+    Frustum extractFrustum(const glm::mat4& m) {
+        // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        Frustum f;
+        f.planes[Frustum::Left] = row3 + row0;
+        f.planes[Frustum::Right] = row3 - row0;
+        f.planes[Frustum::Bottom] = row3 + row1;
+        f.planes[Frustum::Top] = row3 - row1;
+        f.planes[Frustum::Near] = row3 + row2;
+        f.planes[Frustum::Far] = row3 - row2;
+        for (glm::vec4& p : f.planes) {
+            float len = glm::length(glm::vec3(p));
+            if (len > 0.0f) p /= len;
+        }
+        return f;
+    }
+
+    size_t cullSpheres(const Frustum& frustum, const float* x, const float* y, const float* z,
+        const float* radius, size_t count, uint8_t* visible) {
+        size_t visibleCount = 0;
+        size_t i = 0;
+
+#ifdef GAME_FRUSTUM_SSE
+        __m128 px[6], py[6], pz[6], pw[6];
+        for (int p = 0; p < 6; ++p) {
+            px[p] = _mm_set1_ps(frustum.planes[p].x);
+            py[p] = _mm_set1_ps(frustum.planes[p].y);
+            pz[p] = _mm_set1_ps(frustum.planes[p].z);
+            pw[p] = _mm_set1_ps(frustum.planes[p].w);
+        }
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 cx = _mm_loadu_ps(x + i);
+            __m128 cy = _mm_loadu_ps(y + i);
+            __m128 cz = _mm_loadu_ps(z + i);
+            __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+            // A sphere is outside once it is entirely behind any one plane
+            __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+            for (int p = 0; p < 6; ++p) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)),
+                    _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            for (int k = 0; k < 4; ++k) {
+                uint8_t v = (uint8_t)((mask >> k) & 1);
+                visible[i + k] = v;
+                visibleCount += v;
+            }
+        }
+#endif
+
+        for (; i < count; ++i) {
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p) {
+                const glm::vec4& pl = frustum.planes[p];
+                inside = pl.x * x[i] + pl.y * y[i] + pl.z * z[i] + pl.w >= -radius[i];
+            }
+            visible[i] = inside ? 1 : 0;
+            visibleCount += inside ? 1 : 0;
+        }
+        return visibleCount;
+    }
+
+} // namespace game
@@ -0,0 +1,210 @@
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+
+namespace game {
+
+    GLStateCache& glState() {
+        static GLStateCache cache;
+        return cache;
+    }
+
+    int GLStateCache::BufferSlot(GLenum target) {
+        switch (target) {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_UNIFORM_BUFFER: return 1;
+        case GL_COPY_READ_BUFFER: return 2;
+        case GL_COPY_WRITE_BUFFER: return 3;
+        case GL_TEXTURE_BUFFER: return 4;
+        case GL_PIXEL_UNPACK_BUFFER: return 5;
+        default: return -1;
+        }
+    }
+
+    int GLStateCache::TextureSlot(GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_3D: return 2;
+        case GL_TEXTURE_CUBE_MAP: return 3;
+        case GL_TEXTURE_BUFFER: return 4;
+        default: return -1;
+        }
+    }
+
+    int GLStateCache::CapSlot(GLenum cap) {
+        switch (cap) {
+        case GL_BLEND: return 0;
+        case GL_DEPTH_TEST: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_PROGRAM_POINT_SIZE: return 3;
+        case GL_SCISSOR_TEST: return 4;
+        case GL_STENCIL_TEST: return 5;
+        default: return -1;
+        }
+    }
+
+    void GLStateCache::Count(bool issued) {
+#ifndef NDEBUG
+        if (issued) counters_.issued++;
+        else counters_.elided++;
+#else
+        (void)issued;
+#endif
+    }
+
+    void GLStateCache::Invalidate() {
+        program_ = kUnknown;
+        vao_ = kUnknown;
+        for (GLuint& b : buffers_) b = kUnknown;
+        activeUnit_ = kUnknown;
+        for (auto& unit : textures_) {
+            for (GLuint& t : unit) t = kUnknown;
+        }
+        for (int& c : caps_) c = -1;
+        blendSrc_ = blendDst_ = kUnknown;
+        depthMask_ = -1;
+        depthFunc_ = kUnknown;
+        cullFace_ = kUnknown;
+    }
+
+    GLStateCache::Counters GLStateCache::TakeCounters() {
+        Counters c = counters_;
+        counters_ = Counters();
+        return c;
+    }
+
+    void GLStateCache::UseProgram(GLuint program) {
+        bool issue = program != program_;
+        if (issue) {
+            renderDevice().UseProgram(program);
+            program_ = program;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::BindVertexArray(GLuint vao) {
+        bool issue = vao != vao_;
+        if (issue) {
+            renderDevice().BindVertexArray(vao);
+            vao_ = vao;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::BindBuffer(GLenum target, GLuint buffer) {
+        int slot = BufferSlot(target);
+        bool issue = slot < 0 || buffers_[slot] != buffer;
+        if (issue) {
+            renderDevice().BindBuffer(target, buffer);
+            if (slot >= 0) buffers_[slot] = buffer;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        // Indexed bindings are not tracked, but the call also sets the generic binding
+        renderDevice().BindBufferBase(target, index, buffer);
+        int slot = BufferSlot(target);
+        if (slot >= 0) buffers_[slot] = buffer;
+        Count(true);
+    }
+
+    void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+        int slot = TextureSlot(target);
+        if (slot >= 0 && unit < (GLuint)kMaxTextureUnits && textures_[unit][slot] == texture) {
+            Count(false);
+            return;
+        }
+
+        if (unit != activeUnit_) {
+            renderDevice().ActiveTexture(unit);
+            activeUnit_ = unit;
+            Count(true);
+        }
+        renderDevice().BindTexture(target, texture);
+        if (slot >= 0 && unit < (GLuint)kMaxTextureUnits) textures_[unit][slot] = texture;
+        Count(true);
+    }
+
+    void GLStateCache::SetEnabled(GLenum cap, bool enabled) {
+        int slot = CapSlot(cap);
+        bool issue = slot < 0 || caps_[slot] != (enabled ? 1 : 0);
+        if (issue) {
+            renderDevice().SetEnabled(cap, enabled);
+            if (slot >= 0) caps_[slot] = enabled ? 1 : 0;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::BlendFunc(GLenum src, GLenum dst) {
+        bool issue = src != blendSrc_ || dst != blendDst_;
+        if (issue) {
+            renderDevice().BlendFunc(src, dst);
+            blendSrc_ = src;
+            blendDst_ = dst;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::DepthMask(bool write) {
+        bool issue = depthMask_ != (write ? 1 : 0);
+        if (issue) {
+            renderDevice().DepthMask(write);
+            depthMask_ = write ? 1 : 0;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::DepthFunc(GLenum func) {
+        bool issue = func != depthFunc_;
+        if (issue) {
+            renderDevice().DepthFunc(func);
+            depthFunc_ = func;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::CullFace(GLenum face) {
+        bool issue = face != cullFace_;
+        if (issue) {
+            renderDevice().CullFace(face);
+            cullFace_ = face;
+        }
+        Count(issue);
+    }
+
+    void GLStateCache::DeleteProgram(GLuint& program) {
+        if (!program) return;
+        renderDevice().DeleteProgram(program);
+        if (program_ == program) program_ = kUnknown;
+        program = 0;
+    }
+
+    void GLStateCache::DeleteVertexArray(GLuint& vao) {
+        if (!vao) return;
+        renderDevice().DeleteVertexArray(vao);
+        if (vao_ == vao) vao_ = kUnknown;
+        vao = 0;
+    }
+
+    void GLStateCache::DeleteBuffer(GLuint& buffer) {
+        if (!buffer) return;
+        renderDevice().DeleteBuffer(buffer);
+        for (GLuint& b : buffers_) {
+            if (b == buffer) b = kUnknown;
+        }
+        buffer = 0;
+    }
+
+    void GLStateCache::DeleteTexture(GLuint& texture) {
+        if (!texture) return;
+        renderDevice().DeleteTexture(texture);
+        for (auto& unit : textures_) {
+            for (GLuint& t : unit) {
+                if (t == texture) t = kUnknown;
+            }
+        }
+        texture = 0;
+    }
+
+} // namespace game
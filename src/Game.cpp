@@ -1,5 +1,9 @@
 ﻿    // Game.cpp - PART 1 OF 4: Initialization and Setup
     #include "game/Game.h"
+    #include "game/GLState.h"
+    #include "game/RenderDevice.h"
+    #include "game/ShaderManager.h"
+    #include "game/TextureCache.h"
     #include <glm/gtc/matrix_transform.hpp>
     #include <glm/gtc/type_ptr.hpp>
     #include <cstdio>
@@ -30,57 +34,29 @@
     // UTILITY FUNCTIONS
     // ============================================================================
 
-    std::string Game::loadText(const std::string& path) {
-        std::ifstream f(path);
-        if (!f) {
-            std::fprintf(stderr, "Failed to open %s\n", path.c_str());
-            std::exit(1);
-        }
-        std::stringstream ss;
-        ss << f.rdbuf();
-        return ss.str();
-    }
-
-    GLuint Game::compile(GLenum type, const std::string& src) {
-        GLuint s = glCreateShader(type);
-        const char* c = src.c_str();
-        glShaderSource(s, 1, &c, nullptr);
-        glCompileShader(s);
-
-        GLint ok = 0;
-        glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
-        if (!ok) {
-            GLint n = 0;
-            glGetShaderiv(s, GL_INFO_LOG_LENGTH, &n);
-            std::string log(n, '\0');
-            glGetShaderInfoLog(s, n, nullptr, log.data());
-            std::fprintf(stderr, "Shader compile error:\n%s\n", log.c_str());
-            std::exit(1);
-        }
-        return s;
-    }
-
-    GLuint Game::link(GLuint v, GLuint f) {
-        GLuint p = glCreateProgram();
-        glAttachShader(p, v);
-        glAttachShader(p, f);
-        glLinkProgram(p);
-
-        GLint ok = 0;
-        glGetProgramiv(p, GL_LINK_STATUS, &ok);
-        if (!ok) {
-            GLint n = 0;
-            glGetProgramiv(p, GL_INFO_LOG_LENGTH, &n);
-            std::string log(n, '\0');
-            glGetProgramInfoLog(p, n, nullptr, log.data());
-            std::fprintf(stderr, "Program link error:\n%s\n", log.c_str());
-            std::exit(1);
-        }
-
-        glDeleteShader(v);
-        glDeleteShader(f);
-        return p;
-    }
+    // Every program Game builds from assets/shaders. They are all requested at once in
+    // initShaders() so the driver can compile them side by side; each init function then
+    // takes the ones it needs.
+    static const struct {
+        const char* name;
+        const char* vert;
+        const char* frag;
+    } kGamePrograms[] = {
+        { "basic", "basic.vert", "basic.frag" },
+        { "shadow", "shadow.vert", "shadow.frag" },
+        { "gbuffer", "basic.vert", "gbuffer.frag" },
+        { "deferred_light", "fullscreen.vert", "deferred_light.frag" },
+        { "light_volume", "light_volume.vert", "light_volume.frag" },
+        { "resolve", "fullscreen.vert", "resolve.frag" },
+        { "bloom_down", "fullscreen.vert", "bloom_down.frag" },
+        { "bloom_up", "fullscreen.vert", "bloom_up.frag" },
+        { "volumetric_source", "fullscreen.vert", "volumetric_source.frag" },
+        { "volumetric_light", "fullscreen.vert", "VolumetricLight.frag" },
+        { "tonemap_fxaa", "fullscreen.vert", "tonemap_fxaa.frag" },
+    };
+
+    // Edge of every surface texture layer; generated once, then read from cache/textures
+    static const int kSurfaceTextureSize = 1024;
 
     void Game::printInstructions() {
         std::cout << "\n";
@@ -99,6 +75,12 @@
         std::cout << "   Camera:        Q/E - Rotate | Z/X - Height                 \n";
         std::cout << "   Game:          P - Pause | R - Restart | ESC - Quit        \n";
         std::cout << "   Sound:         M - Toggle Sound ON/OFF                     \n";
+        std::cout << "   Perf HUD:      F3 - Toggle frame timings and counters      \n";
+        std::cout << "   Lighting:      F4 - Toggle deferred / forward shading      \n";
+        std::cout << "   Resolution:    F5 - Toggle dynamic / native resolution     \n";
+        std::cout << "   Occlusion:     F6 - Toggle CPU occlusion culling           \n";
+        std::cout << "   Stress test:   T - Start with 10,000 cheeses (intro only)  \n";
+        std::cout << "   Light bench:   L - Cycle 0/16/256/1024 extra point lights  \n";
         std::cout << "                                                               \n";
         std::cout << " POWER-UPS (Last 5 seconds):                                  \n";
         std::cout << "   Gold Sphere  - SHIELD (Invincible)                         \n";
@@ -150,15 +132,51 @@
             std::cerr << "  Lightning system failed: " << e.what() << "\n";
         }
 
+        try {
+            initShadows();
+            std::cout << "  Shadow map initialized\n";
+        }
+        catch (const std::exception& e) {
+            shadowMap_.reset();
+            std::cerr << "  Shadow map failed: " << e.what() << "\n";
+        }
+
+        try {
+            initDeferred();
+            std::cout << "  Deferred renderer initialized\n";
+        }
+        catch (const std::exception& e) {
+            deferred_.reset();
+            gbuffer_.reset();
+            std::cerr << "  Deferred renderer failed: " << e.what() << "\n";
+        }
+
+        try {
+            initPostProcessing();
+            std::cout << "  Post processing initialized\n";
+        }
+        catch (const std::exception& e) {
+            post_.reset();
+            dynamicResolution_.reset();
+            std::cerr << "  Post processing failed: " << e.what() << "\n";
+        }
+
         try {
             uiRenderer_ = std::make_unique<UIRenderer>();
             uiRenderer_->Init(width_, height_);
             std::cout << "  UI Renderer initialized\n";
         }
         catch (const std::exception& e) {
+            uiRenderer_.reset();
             std::cerr << "  UI Renderer failed: " << e.what() << "\n";
         }
 
+        const ShaderManager& shaders = shaderManager();
+        std::cout << "Shaders: " << shaders.Compiled() << " compiled in " << shaders.CompileMs() << " ms, "
+            << shaders.CacheHits() << " loaded from cache in " << shaders.CacheMs() << " ms ("
+            << (shaders.ParallelCompile() ? "parallel" : "serial") << " compile, binary cache "
+            << (shaders.BinaryCache() ? "on" : "off") << ")\n";
+
         printInstructions();
         resetWorld();
 
@@ -207,82 +225,200 @@
             std::exit(1);
         }
 
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
+        glState().Enable(GL_DEPTH_TEST);
+        glState().DepthFunc(GL_LEQUAL);
+        glState().Enable(GL_CULL_FACE);
+        glState().CullFace(GL_BACK);
         glFrontFace(GL_CCW);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glState().Enable(GL_BLEND);
+        glState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
 
     void Game::initShaders() {
         std::string base = ASSET_DIR;
-        std::string vsPath = base + std::string("/shaders/basic.vert");
-        std::string fsPath = base + std::string("/shaders/basic.frag");
-
-        std::string vsSrc = loadText(vsPath);
-        std::string fsSrc = loadText(fsPath);
-
-        GLuint v = compile(GL_VERTEX_SHADER, vsSrc);
-        GLuint f = compile(GL_FRAGMENT_SHADER, fsSrc);
-        prog_ = link(v, f);
-
-        glUseProgram(prog_);
-
-        uModel_ = glGetUniformLocation(prog_, "uModel");
-        uView_ = glGetUniformLocation(prog_, "uView");
-        uProj_ = glGetUniformLocation(prog_, "uProj");
-        uViewPos_ = glGetUniformLocation(prog_, "uViewPos");
-        uBaseColor_ = glGetUniformLocation(prog_, "uBaseColor");
-        uEmissive_ = glGetUniformLocation(prog_, "uEmissive");
-        uKa_ = glGetUniformLocation(prog_, "uKa");
-        uKd_ = glGetUniformLocation(prog_, "uKd");
-        uKs_ = glGetUniformLocation(prog_, "uKs");
-        uShine_ = glGetUniformLocation(prog_, "uShine");
-        uL1pos_ = glGetUniformLocation(prog_, "uL1.position");
-        uL1col_ = glGetUniformLocation(prog_, "uL1.color");
-        uL2pos_ = glGetUniformLocation(prog_, "uL2.position");
-        uL2col_ = glGetUniformLocation(prog_, "uL2.color");
-        uUseTexture_ = glGetUniformLocation(prog_, "uUseTexture");
-        uTexture_ = glGetUniformLocation(prog_, "uTexture");
-
-        glm::vec3 L1pos(6.0f, 12.0f, 6.0f);
-        glm::vec3 L1col(6.0f, 5.5f, 5.0f);
-        glm::vec3 L2pos(-6.0f, 10.0f, -6.0f);
-        glm::vec3 L2col(4.0f, 4.5f, 5.0f);
-
-        glUniform3fv(uL1pos_, 1, glm::value_ptr(L1pos));
-        glUniform3fv(uL1col_, 1, glm::value_ptr(L1col));
-        glUniform3fv(uL2pos_, 1, glm::value_ptr(L2pos));
-        glUniform3fv(uL2col_, 1, glm::value_ptr(L2col));
+        for (const auto& p : kGamePrograms) {
+            shaderManager().RequestFiles(p.name, base + "/shaders/" + p.vert, base + "/shaders/" + p.frag);
+        }
+        prog_ = shaderManager().Take("basic");
+
+        glState().UseProgram(prog_);
+
+        uTexture_ = glGetUniformLocation(prog_, "uTextures");
+        uPosScale_ = glGetUniformLocation(prog_, "uPosScale");
+        uPosOffset_ = glGetUniformLocation(prog_, "uPosOffset");
+        uOctNormals_ = glGetUniformLocation(prog_, "uOctNormals");
+
+        sceneProgram_.program = prog_;
+        sceneProgram_.posScale = uPosScale_;
+        sceneProgram_.posOffset = uPosOffset_;
+        sceneProgram_.octNormals = uOctNormals_;
+        bindUniformBlocks(prog_);
+
+        // sampler2DShadow must not share unit 0 with uTextures, even when shadows are off
+        renderDevice().Uniform1i(glGetUniformLocation(prog_, "uShadowMap"), 1);
+        renderDevice().Uniform1i(glGetUniformLocation(prog_, "uClusterLights"), (GLint)LightClusters::kLightUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(prog_, "uClusterRanges"), (GLint)LightClusters::kRangeUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(prog_, "uClusterIndices"), (GLint)LightClusters::kIndexUnit);
+
+        materials_.resize(MatCount);
+        materials_[MatGround] = { 0.4f, 0.9f, 0.1f, 8.0f };
+        materials_[MatWall] = { 0.3f, 0.8f, 0.4f, 48.0f };
+        materials_[MatFurniture] = { 0.3f, 0.85f, 0.3f, 24.0f };
+        materials_[MatCheese] = { 0.4f, 0.8f, 0.4f, 32.0f };
+        materials_[MatShield] = { 0.3f, 0.6f, 0.9f, 96.0f };
+        materials_[MatSpeed] = { 0.2f, 0.7f, 0.8f, 72.0f };
+        materials_[MatFreeze] = { 0.3f, 0.6f, 0.9f, 80.0f };
+        materials_[MatParticle] = { 0.1f, 0.3f, 0.2f, 8.0f };
+        materials_[MatMouse] = { 0.35f, 0.8f, 0.3f, 28.0f };
+        materials_[MatCat] = { 0.4f, 0.85f, 0.25f, 24.0f };
+        materials_[MatEffect] = { 0.5f, 0.5f, 0.9f, 128.0f };
+
+        // Materials never change, so the table is uploaded once
+        materialUbo_ = std::make_unique<UniformBuffer>(kMaterialBlockBinding, kMaxMaterials * sizeof(RenderMaterial));
+        materialUbo_->Update(materials_.data(), materials_.size() * sizeof(RenderMaterial));
+
+        // Lights live in the per-frame block next to the camera
+        frameBlock_ = FrameBlock();
+        frameBlock_.lightPosition[0] = glm::vec4(6.0f, 12.0f, 6.0f, 1.0f);
+        frameBlock_.lightColor[0] = glm::vec4(6.0f, 5.5f, 5.0f, 0.0f);
+        frameBlock_.lightPosition[1] = glm::vec4(-6.0f, 10.0f, -6.0f, 1.0f);
+        frameBlock_.lightColor[1] = glm::vec4(4.0f, 4.5f, 5.0f, 0.0f);
+        frameBlock_.lightCount = glm::ivec4(2, 0, 0, 0);
+        frameUbo_ = std::make_unique<UniformBuffer>(kFrameBlockBinding, sizeof(FrameBlock));
+        clusters_ = std::make_unique<LightClusters>();
     }
 
     void Game::initMeshes() {
-        box_ = makeBox();
-        sphere_ = makeSphere(24, 16);
-        cyl_ = makeCylinder(24);
-        cone_ = makeCone(24);
+        double start = glfwGetTime();
+        jobs_ = std::make_unique<JobSystem>();
+        geometry_ = std::make_unique<GeometryArena>(packedVertexLayout(), GL_UNSIGNED_SHORT);
+        meshCache_ = std::make_unique<MeshCache>("cache/meshes", geometry_.get());
+        instances_ = std::make_unique<InstanceBuffer>();
+        renderQueue_ = std::make_unique<RenderQueue>(*instances_);
+        occlusion_ = std::make_unique<OcclusionCuller>(jobs_.get());
+        assets_ = std::make_unique<AssetLoader>(*jobs_, *meshCache_);
+
+        // Everything drawn with basic.vert is static, so use the packed vertex format
+        const VertexFormat fmt = VertexFormat::Packed;
+
+        // Placeholders are needed before the first frame, the rest streams in
+        box_ = meshCache_->Load("box", "", "box", [] { return buildBox(); }, fmt);
+        sphere_ = meshCache_->Load("sphere", "", "sphere seg=24 rings=16", [] { return buildSphere(24, 16); }, fmt);
 
         std::string base = ASSET_DIR;
-        std::cout << "Loading 3D models...\n";
-        mouseModel_ = loadOBJ(base + std::string("/models/mouse.obj"));
-        catModel_ = loadOBJ(base + std::string("/models/cat.obj"));
-        cheeseModel_ = loadOBJ(base + std::string("/models/cheese.obj"));
-        std::cout << "Models ready!\n";
+        std::string mousePath = base + std::string("/models/mouse.obj");
+        std::string catPath = base + std::string("/models/cat.obj");
+        std::string cheesePath = base + std::string("/models/cheese.obj");
+
+        std::cout << "Loading 3D models in the background (" << jobs_->WorkerCount() << " workers)...\n";
+        cylHandle_ = assets_->LoadMesh("cylinder", "", "cylinder seg=24", [] { return buildCylinder(24); }, fmt, box_);
+        coneHandle_ = assets_->LoadMesh("cone", "", "cone seg=24", [] { return buildCone(24); }, fmt, box_);
+        mouseHandle_ = assets_->LoadMesh("mouse", mousePath, "obj fallback=mouse", [mousePath] { return buildOBJ(mousePath); }, fmt, sphere_);
+        catHandle_ = assets_->LoadMesh("cat", catPath, "obj fallback=cat", [catPath] { return buildOBJ(catPath); }, fmt, sphere_);
+        cheeseHandle_ = assets_->LoadMesh("cheese", cheesePath, "obj fallback=cheese", [cheesePath] { return buildOBJ(cheesePath); }, fmt, box_);
+        std::cout << "Placeholders ready in " << (int)((glfwGetTime() - start) * 1000.0) << " ms\n";
     }
 
     void Game::initTextures() {
         std::cout << "Generating procedural textures...\n";
-        grassTex_ = std::make_unique<Texture>();
-        grassTex_->GenerateGrass();
-        stoneTex_ = std::make_unique<Texture>();
-        stoneTex_->GenerateStone();
-        metalTex_ = std::make_unique<Texture>();
-        metalTex_->GenerateMetal();
-        woodTex_ = std::make_unique<Texture>();
-        woodTex_->GenerateCheckerboard();
-        std::cout << "Textures generated!\n";
+        double start = glfwGetTime();
+        TextureCache cache("cache/textures", jobs_.get());
+        surfaceTextures_ = std::make_unique<TextureArray>(kSurfaceTextureSize, kSurfaceTextureSize);
+        auto add = [&](const char* name, Surface surface) {
+            return surfaceTextures_->Add(name, cache.Load(name, { surface, kSurfaceTextureSize }).data());
+            };
+        grassLayer_ = add("grass", Surface::Grass);
+        stoneLayer_ = add("stone", Surface::Stone);
+        metalLayer_ = add("metal", Surface::Metal);
+        woodLayer_ = add("wood", Surface::Wood);
+        std::cout << "Textures ready in " << (int)((glfwGetTime() - start) * 1000.0) << " ms (texture cache: "
+            << cache.Hits() << " hits, " << cache.Misses() << " rebuilt)\n";
+    }
+
+    // Depth-only program for the shadow casters and the light 0 shadow map. Light 0 is treated
+    // as a directional light aimed at the room centre, so its matrix is fixed.
+    void Game::initShadows() {
+        shadowProg_ = shaderManager().Take("shadow");
+        bindUniformBlocks(shadowProg_);
+
+        shadowProgram_.program = shadowProg_;
+        shadowProgram_.posScale = glGetUniformLocation(shadowProg_, "uPosScale");
+        shadowProgram_.posOffset = glGetUniformLocation(shadowProg_, "uPosOffset");
+
+        shadowMap_ = std::make_unique<ShadowMap>(2048, 2048);
+        shadowQueue_ = std::make_unique<RenderQueue>(*instances_);
+
+        frameBlock_.lightSpace = shadowMap_->GetLightSpaceMatrix(glm::vec3(frameBlock_.lightPosition[0]),
+            glm::vec3(0.0f), 12.0f);
+        frameBlock_.lightCount.y = 1;
+    }
+
+    // G-buffer fill program (basic.vert + gbuffer.frag) and the lighting passes. Only opaque
+    // and double-sided draws are deferred; blended and overlay draws keep using prog_.
+    void Game::initDeferred() {
+        gbufferProg_ = shaderManager().Take("gbuffer");
+        bindUniformBlocks(gbufferProg_);
+
+        gbufferProgram_.program = gbufferProg_;
+        gbufferProgram_.posScale = glGetUniformLocation(gbufferProg_, "uPosScale");
+        gbufferProgram_.posOffset = glGetUniformLocation(gbufferProg_, "uPosOffset");
+        gbufferProgram_.octNormals = glGetUniformLocation(gbufferProg_, "uOctNormals");
+
+        GLuint directional = shaderManager().Take("deferred_light");
+        GLuint point = shaderManager().Take("light_volume");
+        GLuint resolve = shaderManager().Take("resolve");
+        deferred_ = std::make_unique<DeferredLighting>(directional, point, resolve);
+
+        int W, H;
+        glfwGetFramebufferSize(win_, &W, &H);
+        gbuffer_ = std::make_unique<GBuffer>();
+        gbuffer_->Init(std::max(W, 1), std::max(H, 1));
+    }
+
+    void Game::initPostProcessing() {
+        GLuint down = shaderManager().Take("bloom_down");
+        GLuint up = shaderManager().Take("bloom_up");
+        GLuint shaftSource = shaderManager().Take("volumetric_source");
+        GLuint shafts = shaderManager().Take("volumetric_light");
+        GLuint tonemap = shaderManager().Take("tonemap_fxaa");
+        post_ = std::make_unique<PostProcessor>(down, up, shaftSource, shafts, tonemap);
+
+        int W, H;
+        glfwGetFramebufferSize(win_, &W, &H);
+        post_->Init(std::max(W, 1), std::max(H, 1));
+        dynamicResolution_ = std::make_unique<DynamicResolution>();
+    }
+
+    // Themed lamps, tinted per level: sconces along the inside of the walls and a grid of
+    // hanging lamps. With the cheese and power-ups a level has well over 100 point lights.
+    void Game::buildLamps() {
+        static const glm::vec3 themes[4] = {
+            { 1.0f, 0.75f, 0.45f },     // warm kitchen
+            { 0.45f, 0.7f, 1.0f },      // moonlight
+            { 0.85f, 0.5f, 1.0f },      // party
+            { 0.5f, 1.0f, 0.6f }        // garden
+        };
+        const glm::vec3 tint = themes[(level_ - 1) % 4];
+        const float W = 18.f;
+        const float D = 12.f;
+
+        lamps_.clear();
+        auto lamp = [&](float x, float y, float z, float radius, float intensity) {
+            lamps_.push_back({ glm::vec4(x, y, z, radius), glm::vec4(tint * intensity, 0.0f) });
+            };
+        for (float x = -W * 0.5f + 1.5f; x < W * 0.5f - 1.0f; x += 1.5f) {
+            lamp(x, 1.2f, -D * 0.5f + 0.6f, 2.5f, 0.5f);
+            lamp(x, 1.2f, D * 0.5f - 0.6f, 2.5f, 0.5f);
+        }
+        for (float z = -D * 0.5f + 1.5f; z < D * 0.5f - 1.0f; z += 1.5f) {
+            lamp(-W * 0.5f + 0.6f, 1.2f, z, 2.5f, 0.5f);
+            lamp(W * 0.5f - 0.6f, 1.2f, z, 2.5f, 0.5f);
+        }
+        for (int ix = 0; ix < 10; ++ix) {
+            for (int iz = 0; iz < 6; ++iz) {
+                lamp(-7.2f + ix * 1.6f, 2.5f, -4.0f + iz * 1.6f, 3.5f, 0.25f);
+            }
+        }
     }
 
     void Game::resetWorld() {
@@ -351,7 +487,8 @@
         addF({ -2.5f, 0.5f, 3.0f }, { 1.5f, 1.0f, 1.0f }, { 0.65f, 0.45f, 0.35f }, 2);
 
         cheeses_.clear();
-        totalCheese_ = 5 + level_;
+        totalCheese_ = stressTest_ ? 10000 : 5 + level_;
+        cheeses_.reserve(totalCheese_);
         for (int i = 0; i < totalCheese_; ++i) {
             float x = -7.f + (rand() % 140) / 10.0f;
             float z = -5.f + (rand() % 100) / 10.0f;
@@ -389,6 +526,10 @@
         showCollisionEffect_ = false;
         collisionEffectTimer_ = 0.0f;
 
+        // Walls and furniture were rebuilt
+        if (shadowMap_) shadowMap_->InvalidateStatic();
+        buildLamps();
+
         if (level_ > 1) {
             std::cout << "\n>>> LEVEL " << level_ << " STARTED! <<<\n\n";
         }
@@ -542,6 +683,7 @@
     }
 
     void Game::updateAI(float dt) {
+        PerfHud::Scope scope(perfHud_, PerfPhase::AI);
         if (catFrozen_) {
             catState_ = CatState::CONFUSED;
             return;
@@ -821,6 +963,7 @@
     }
 
     void Game::updatePhysics(float dt) {
+        PerfHud::Scope scope(perfHud_, PerfPhase::Physics);
         const float roomMinX = -8.5f;
         const float roomMaxX = 8.5f;
         const float roomMinZ = -5.5f;
@@ -889,8 +1032,29 @@
             float dt = static_cast<float>(now - prev);
             prev = now;
 
-            update(dt);
+            // Finished background loads go to the GPU a few at a time
+            assets_->PumpUploads(2.0);
+
+            perfHud_.BeginFrame();
+            {
+                PerfHud::Scope scope(perfHud_, PerfPhase::Update);
+                update(dt);
+            }
+            if (dynamicResolution_) dynamicResolution_->BeginFrame();
             render();
+            if (dynamicResolution_) frameStats_.frameGpuMs = dynamicResolution_->GpuMs();
+            reportFrameStats(now);
+            if (uiRenderer_) {
+                perfHud_.Render(*uiRenderer_, static_cast<float>(width_) - 360.0f, 80.0f);
+            }
+            if (dynamicResolution_) {
+                // The next frame's render() reallocates the targets when the scale moved
+                dynamicResolution_->EndFrame();
+                dynamicResolution_->Update((glfwGetTime() - now) * 1000.0);
+            }
+            perfHud_.EndFrame(dt * 1000.0, frameStats_,
+                (particleSystem_ ? particleSystem_->AliveCount() : 0) + (int)particles_.size(),
+                lightningSystem_ ? lightningSystem_->BoltCount() : 0);
 
             glfwSwapBuffers(win_);
             glfwPollEvents();
@@ -907,6 +1071,37 @@
             keys_[GLFW_KEY_M] = false;
         }
 
+        if (keys_[GLFW_KEY_F3]) {
+            perfHud_.Toggle();
+            keys_[GLFW_KEY_F3] = false;
+        }
+
+        if (keys_[GLFW_KEY_F4]) {
+            deferredEnabled_ = !deferredEnabled_;
+            std::cout << "Lighting: " << (deferredEnabled_ && deferred_ ? "deferred" : "forward") << "\n";
+            keys_[GLFW_KEY_F4] = false;
+        }
+
+        if (keys_[GLFW_KEY_F5]) {
+            if (dynamicResolution_) {
+                dynamicResolution_->SetEnabled(!dynamicResolution_->Enabled());
+                std::cout << "Resolution: " << (dynamicResolution_->Enabled() ? "dynamic" : "native") << "\n";
+            }
+            keys_[GLFW_KEY_F5] = false;
+        }
+
+        if (keys_[GLFW_KEY_F6]) {
+            occlusionEnabled_ = !occlusionEnabled_;
+            std::cout << "Occlusion culling: " << (occlusionEnabled_ ? "ON" : "OFF") << "\n";
+            keys_[GLFW_KEY_F6] = false;
+        }
+
+        if (keys_[GLFW_KEY_L]) {
+            benchmarkLights_ = benchmarkLights_ == 0 ? 16 : benchmarkLights_ == 16 ? 256 : benchmarkLights_ == 256 ? 1024 : 0;
+            std::cout << "Light benchmark: " << benchmarkLights_ << " extra point lights\n";
+            keys_[GLFW_KEY_L] = false;
+        }
+
         if (keys_[GLFW_KEY_Q]) cameraAngle_ -= 1.5f * dt;
         if (keys_[GLFW_KEY_E]) cameraAngle_ += 1.5f * dt;
 
@@ -943,8 +1138,11 @@
             lightningIntensity_ -= dt * 2.0f;
         }
 
-        if (particleSystem_) particleSystem_->Update(dt);
-        if (lightningSystem_) lightningSystem_->Update(dt);
+        {
+            PerfHud::Scope scope(perfHud_, PerfPhase::Particles);
+            if (particleSystem_) particleSystem_->Update(dt);
+            if (lightningSystem_) lightningSystem_->Update(dt);
+        }
 
         if (showCollisionEffect_) {
             collisionEffectTimer_ -= dt;
@@ -977,30 +1175,43 @@
             break;
         }
 
-        std::string title = "Tom & Jerry 3D | Level:" + std::to_string(level_) +
+        int title[7] = { level_, score_, collected_, totalCheese_, mouse_.lives, currentPowerUp_,
+            currentPowerUp_ >= 0 ? (int)std::ceil(powerUpTimer_) : 0 };
+        if (std::equal(title, title + 7, shownTitle_)) return;
+        std::copy(title, title + 7, shownTitle_);
+
+        std::string titleText = "Tom & Jerry 3D | Level:" + std::to_string(level_) +
             " | Score:" + std::to_string(score_) +
             " | Cheese:" + std::to_string(collected_) + "/" + std::to_string(totalCheese_) +
             " | Lives:" + std::to_string(mouse_.lives);
 
         if (currentPowerUp_ >= 0) {
-            title += " | PowerUp:";
-            if (currentPowerUp_ == 0) title += "SHIELD";
-            else if (currentPowerUp_ == 1) title += "SPEED";
-            else title += "FREEZE";
-            title += "(" + std::to_string((int)std::ceil(powerUpTimer_)) + "s)";
+            titleText += " | PowerUp:";
+            if (currentPowerUp_ == 0) titleText += "SHIELD";
+            else if (currentPowerUp_ == 1) titleText += "SPEED";
+            else titleText += "FREEZE";
+            titleText += "(" + std::to_string((int)std::ceil(powerUpTimer_)) + "s)";
         }
 
-        glfwSetWindowTitle(win_, title.c_str());
+        glfwSetWindowTitle(win_, titleText.c_str());
     }
 
     void Game::updateIntro(float dt) {
         introTimer_ -= dt;
 
         if (keys_[GLFW_KEY_U]) {
+            stressTest_ = false;
             startGame();
             keys_[GLFW_KEY_U] = false;
         }
 
+        // Instancing stress level: same room, 10k cheeses
+        if (keys_[GLFW_KEY_T]) {
+            stressTest_ = true;
+            startGame();
+            keys_[GLFW_KEY_T] = false;
+        }
+
         if (introTimer_ <= 0.0f) {
             introTimer_ = 10.0f;
         }
@@ -1048,12 +1259,15 @@
             }
         }
 
-        for (auto it = particles_.begin(); it != particles_.end();) {
-            it->pos += it->vel * dt;
-            it->vel.y -= 9.8f * dt;
-            it->life -= dt;
-            if (it->life <= 0.f) it = particles_.erase(it);
-            else ++it;
+        {
+            PerfHud::Scope scope(perfHud_, PerfPhase::Particles);
+            for (auto it = particles_.begin(); it != particles_.end();) {
+                it->pos += it->vel * dt;
+                it->vel.y -= 9.8f * dt;
+                it->life -= dt;
+                if (it->life <= 0.f) it = particles_.erase(it);
+                else ++it;
+            }
         }
 
         checkCollisions();
@@ -1127,16 +1341,79 @@
     void Game::render() {
         int W, H;
         glfwGetFramebufferSize(win_, &W, &H);
-        glViewport(0, 0, W, H);
+        frameStats_.Reset();
+
+        glm::mat4 V = cam_.view();
+        glm::mat4 P = cam_.proj();
+        frameBlock_.view = V;
+        frameBlock_.proj = P;
+        frameBlock_.viewPos = glm::vec4(cam_.position(), 1.0f);
+
+        // Post-processed frames render linear HDR into post_'s scene target (or the G-buffer's
+        // light target) and reach the screen through post_->Apply. That pass also upscales, so
+        // with post processing the scene renders at the dynamic resolution RW x RH.
+        bool post = post_ && gameState_ != GameState::INTRO && W > 0 && H > 0;
+        int RW = W, RH = H;
+        if (post && dynamicResolution_) {
+            RW = dynamicResolution_->ScaledSize(W);
+            RH = dynamicResolution_->ScaledSize(H);
+        }
+        if (post && (post_->Width() != RW || post_->Height() != RH)) {
+            try {
+                post_->Init(RW, RH);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "  Post processing disabled: " << e.what() << "\n";
+                post_.reset();
+                post = false;
+                RW = W;
+                RH = H;
+            }
+        }
+        if (post) post_->SetOutputSize(W, H);
+        frameStats_.renderScale = W > 0 ? (double)RW / (double)W : 1.0;
+        lodPixelsPerUnit_ = P[1][1] * 0.5f * (float)RH;
+
+        // Deferred frames draw the scene into gbuffer_ and resolve it to the screen at the end
+        bool deferred = deferred_ && deferredEnabled_ && gameState_ != GameState::INTRO && W > 0 && H > 0;
+        if (deferred && (gbuffer_->Width() != RW || gbuffer_->Height() != RH)) {
+            try {
+                gbuffer_->Init(RW, RH);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "  Deferred renderer disabled: " << e.what() << "\n";
+                deferred_.reset();
+                gbuffer_.reset();
+                deferred = false;
+            }
+        }
+        frameBlock_.lightCount.z = deferred || post ? 1 : 0;
+        frameUbo_->Update(&frameBlock_, sizeof(frameBlock_));
+
+        // Shadow passes render into their own targets before the main framebuffer is set up
+        if (gameState_ != GameState::INTRO) {
+            PerfHud::Scope scope(perfHud_, PerfPhase::Scene);
+            renderShadows();
+        }
+
+        renderDevice().Viewport(0, 0, RW, RH);
 
         float clearR = 0.52f;
         float clearG = 0.76f;
         float clearB = 0.92f;
+        float exposure = 1.0f;
 
         if (gameState_ == GameState::PLAYING || gameState_ == GameState::PAUSED) {
-            clearR += lightningIntensity_ * 0.4f;
-            clearG += lightningIntensity_ * 0.2f;
-            clearB += lightningIntensity_ * 0.08f;
+            // With post processing the flash brightens the whole frame and blooms the
+            // highlights instead of only tinting the sky
+            if (post) {
+                exposure += lightningIntensity_ * 0.5f;
+            }
+            else {
+                clearR += lightningIntensity_ * 0.4f;
+                clearG += lightningIntensity_ * 0.2f;
+                clearB += lightningIntensity_ * 0.08f;
+            }
         }
         else if (gameState_ == GameState::INTRO) {
             clearR = 0.15f;
@@ -1157,34 +1434,61 @@
             clearB = 0.9f + lightningIntensity_ * 0.1f;
         }
 
-        glClearColor(clearR, clearG, clearB, 1.f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (post && !deferred) {
+            post_->BeginScene(glm::vec3(clearR, clearG, clearB));
+        }
+        else if (!post) {
+            renderDevice().ClearColor(clearR, clearG, clearB, 1.f);
+            renderDevice().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         if (gameState_ == GameState::INTRO) {
+            PerfHud::Scope scope(perfHud_, PerfPhase::UI);
             renderIntro();
             return;
         }
 
         // Render 3D scene for all game states
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_CULL_FACE);
-        glDisable(GL_BLEND);
+        glState().Enable(GL_DEPTH_TEST);
+        glState().Enable(GL_CULL_FACE);
+        glState().Disable(GL_BLEND);
 
-        glUseProgram(prog_);
-        glm::mat4 V = cam_.view();
-        glm::mat4 P = cam_.proj();
-        glUniformMatrix4fv(uView_, 1, GL_FALSE, glm::value_ptr(V));
-        glUniformMatrix4fv(uProj_, 1, GL_FALSE, glm::value_ptr(P));
-        glUniform3fv(uViewPos_, 1, glm::value_ptr(cam_.position()));
-        glUniform1i(uTexture_, 0);
-        renderScene();
+        glState().UseProgram(prog_);
+        renderDevice().Uniform1i(uTexture_, 0);
+        if (shadowMap_) shadowMap_->BindForReading(1);
+        {
+            PerfHud::Scope scope(perfHud_, PerfPhase::Scene);
+
+            // Deferred frames light with volumes; forward frames need the per-cluster light lists
+            gatherPointLights();
+            if (deferred) {
+                clusters_->Disable();
+            }
+            else {
+                clusters_->Build(pointLights_, V, P, RW, RH, frameStats_);
+                clusters_->Upload();
+            }
+            renderScene(deferred, glm::vec3(clearR, clearG, clearB));
+
+            if (post) {
+                // Shafts come from the key light, the one with the shadow map
+                post_->SetVolumetricLight(V, P, glm::vec3(frameBlock_.lightPosition[0]),
+                    glm::vec3(frameBlock_.lightColor[0]) * 0.5f);
+                post_->Apply(deferred ? gbuffer_->lightTexture : post_->SceneTexture(),
+                    deferred ? gbuffer_->depthTexture : post_->SceneDepth(), exposure, frameStats_);
+            }
+            else if (deferred) {
+                deferred_->Resolve(*gbuffer_, frameStats_);
+            }
+        }
 
         // Now render 2D overlays
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glState().Disable(GL_DEPTH_TEST);
+        glState().Disable(GL_CULL_FACE);
+        glState().Enable(GL_BLEND);
+        glState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+        PerfHud::Scope uiScope(perfHud_, PerfPhase::UI);
         if (gameState_ == GameState::PAUSED) {
             renderPauseMenu();
         }
@@ -1203,16 +1507,25 @@
         }
 
         // Reset OpenGL state
-        glEnable(GL_DEPTH_TEST);
+        glState().Enable(GL_DEPTH_TEST);
     }
-    void Game::renderScene() {
-        auto setMat = [&](const glm::vec3& col, float emis, float ka, float kd, float ks, float sh) {
-            glUniform3fv(uBaseColor_, 1, glm::value_ptr(col));
-            glUniform1f(uEmissive_, emis);
-            glUniform1f(uKa_, ka);
-            glUniform1f(uKd_, kd);
-            glUniform1f(uKs_, ks);
-            glUniform1f(uShine_, sh);
+    void Game::renderScene(bool deferred, const glm::vec3& background) {
+        const glm::mat4 V = cam_.view();
+        renderQueue_->Clear();
+
+        // On deferred frames opaque and double-sided draws only fill the G-buffer
+        auto programFor = [&](RenderPass pass) -> const SceneProgram& {
+            return deferred && pass <= RenderPass::DoubleSided ? gbufferProgram_ : sceneProgram_;
+            };
+
+        // Every object goes through the queue; sorting groups them by pass/program/texture/mesh/LOD.
+        // Texture layer and material go per instance, so floor, walls and furniture share one
+        // batch. One-off objects are submitted directly.
+        auto submit = [&](RenderPass pass, SurfaceTexture tex, const Mesh& mesh, SceneMaterial mat,
+            const glm::mat4& M, const glm::vec3& col, float emis) {
+            float depth = -(V * M[3]).z;
+            renderQueue_->Submit(pass, programFor(pass), tex, mesh, selectLod(mesh, M),
+                (uint16_t)mat, M, glm::vec4(col, emis), depth);
             };
 
         // Ground
@@ -1220,94 +1533,91 @@
             glm::mat4 M(1.f);
             M = glm::translate(M, { 0.f, -0.01f, 0.f });
             M = glm::scale(M, { 18.f, 0.02f, 12.f });
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-            glUniform1i(uUseTexture_, 1);
-            setMat({ 0.5f, 0.8f, 0.4f }, 0.0f, 0.4f, 0.9f, 0.1f, 8.0f);
-            grassTex_->Bind(0);
-            drawMesh(box_);
+            submit(RenderPass::Opaque, { surfaceTextures_->Id(), grassLayer_ }, box_, MatGround, M, { 0.5f, 0.8f, 0.4f }, 0.0f);
         }
 
+        // Build phase for the repeated objects: disjoint index ranges are turned into packets on
+        // the workers, one DrawList per chunk. Nothing in here touches GL or game state.
+        const Mesh& cheeseMesh = assets_->Get(cheeseHandle_);
+        const Mesh& coneMesh = assets_->Get(coneHandle_);
+        const SurfaceTexture stone = { surfaceTextures_->Id(), stoneLayer_ };
+        const SurfaceTexture wood = { surfaceTextures_->Id(), woodLayer_ };
+        size_t listCount = 0;
+
+        auto add = [&](DrawList& list, RenderPass pass, SurfaceTexture tex, const Mesh& mesh, SceneMaterial mat,
+            const glm::mat4& M, const glm::vec3& col, float emis) {
+            list.Add(pass, programFor(pass), tex, mesh, selectLod(mesh, M), (uint16_t)mat, M,
+                glm::vec4(col, emis), -(V * M[3]).z);
+            };
+        auto record = [&](size_t count, auto&& build) {
+            const size_t grain = 1024;
+            size_t base = listCount;
+            listCount += (count + grain - 1) / grain;
+            if (drawLists_.size() < listCount) drawLists_.resize(listCount);
+            jobs_->ParallelFor(count, grain, [&, base](size_t chunk, size_t begin, size_t end) {
+                DrawList& list = drawLists_[base + chunk];
+                list.Clear();
+                for (size_t i = begin; i < end; ++i) build(list, i);
+                });
+            };
+
         // Walls
-        glUniform1i(uUseTexture_, 1);
-        for (const auto& w : walls_) {
+        record(walls_.size(), [&](DrawList& list, size_t i) {
+            const auto& w = walls_[i];
             glm::mat4 M = glm::translate(glm::mat4(1.f), w.pos);
             M = glm::scale(M, w.size);
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-            setMat({ 1.0f, 0.96f, 0.75f }, 0.0f, 0.3f, 0.8f, 0.4f, 48.0f);
-            stoneTex_->Bind(0);
-            drawMesh(box_);
-        }
+            add(list, RenderPass::Opaque, stone, box_, MatWall, M, { 1.0f, 0.96f, 0.75f }, 0.0f);
+            });
 
         // Furniture
-        for (const auto& f : furniture_) {
+        record(furniture_.size(), [&](DrawList& list, size_t i) {
+            const auto& f = furniture_[i];
             glm::mat4 M = glm::translate(glm::mat4(1.f), f.pos);
             M = glm::scale(M, f.size);
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-            glUniform1i(uUseTexture_, 1);
-            setMat(f.color, 0.0f, 0.3f, 0.85f, 0.3f, 24.0f);
-            woodTex_->Bind(0);
-            drawMesh(box_);
-        }
-
-        glUniform1i(uUseTexture_, 0);
+            add(list, RenderPass::Opaque, wood, box_, MatFurniture, M, f.color, 0.0f);
+            });
 
         // Cheese
-        for (const auto& c : cheeses_) {
-            if (c.taken) continue;
-            glm::mat4 M = glm::translate(glm::mat4(1.f), c.pos + glm::vec3(0, c.bobOffset, 0));
-            M = glm::rotate(M, c.rotation, glm::vec3(0, 1, 0));
-            M = glm::scale(M, glm::vec3(0.45f));
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-            setMat({ 1.0f, 0.95f, 0.2f }, 0.4f, 0.4f, 0.8f, 0.4f, 32.0f);
-            drawMesh(cheeseModel_);
-        }
-
-        // Power-ups
-        glDisable(GL_CULL_FACE);
-        for (const auto& p : powerups_) {
-            if (p.taken) continue;
+        record(cheeses_.size(), [&](DrawList& list, size_t i) {
+            const auto& c = cheeses_[i];
+            if (c.taken) return;
+            add(list, RenderPass::Opaque, SurfaceTexture(), cheeseMesh, MatCheese, cheeseModel(c), { 1.0f, 0.95f, 0.2f }, 0.4f);
+            });
+
+        // Power-ups (drawn double sided)
+        struct PowerUpLook { glm::vec3 color; float emissive; SceneMaterial material; };
+        static const PowerUpLook looks[3] = {
+            { { 1.0f, 0.84f, 0.0f }, 1.0f, MatShield },
+            { { 0.0f, 1.0f, 1.0f }, 1.1f, MatSpeed },
+            { { 0.3f, 0.5f, 1.0f }, 1.0f, MatFreeze }
+        };
+        record(powerups_.size(), [&](DrawList& list, size_t i) {
+            const auto& p = powerups_[i];
+            if (p.taken) return;
+            const PowerUpLook& look = looks[p.type];
             glm::mat4 M = glm::translate(glm::mat4(1.f), p.pos + glm::vec3(0, p.bobOffset, 0));
             M = glm::rotate(M, p.rotation, glm::vec3(0, 1, 0));
             M = glm::scale(M, glm::vec3(0.35f));
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-
-            if (p.type == 0) {
-                setMat({ 1.0f, 0.84f, 0.0f }, 1.0f, 0.3f, 0.6f, 0.9f, 96.0f);
-                drawMesh(sphere_);
-            }
-            else if (p.type == 1) {
-                setMat({ 0.0f, 1.0f, 1.0f }, 1.1f, 0.2f, 0.7f, 0.8f, 72.0f);
-                drawMesh(cone_);
-            }
-            else {
-                setMat({ 0.3f, 0.5f, 1.0f }, 1.0f, 0.3f, 0.6f, 0.9f, 80.0f);
-                drawMesh(sphere_);
-            }
-        }
-        glEnable(GL_CULL_FACE);
+            add(list, RenderPass::DoubleSided, SurfaceTexture(), p.type == 1 ? coneMesh : sphere_, look.material,
+                M, look.color, look.emissive);
+            });
 
         // Fallback particles
-        if (!particleSystem_ && !particles_.empty()) {
-            glDisable(GL_CULL_FACE);
-            glDepthMask(GL_FALSE);
-            for (const auto& p : particles_) {
+        if (!particleSystem_) {
+            record(particles_.size(), [&](DrawList& list, size_t i) {
+                const auto& p = particles_[i];
                 glm::mat4 M = glm::translate(glm::mat4(1.f), p.pos);
                 M = glm::scale(M, glm::vec3(p.size));
-                glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
-                setMat(p.color, p.life * 2.0f, 0.1f, 0.3f, 0.2f, 8.0f);
-                drawMesh(sphere_);
-            }
-            glDepthMask(GL_TRUE);
-            glEnable(GL_CULL_FACE);
+                add(list, RenderPass::NoDepthWrite, SurfaceTexture(), sphere_, MatParticle, M, p.color, p.life * 2.0f);
+                });
         }
 
+        // Submit phase: merge the chunk lists in order on the GL thread
+        for (size_t i = 0; i < listCount; ++i) renderQueue_->Append(drawLists_[i]);
+
         // Mouse
         {
-            glm::mat4 M = glm::translate(glm::mat4(1.f), mouse_.pos);
-            M = glm::rotate(M, glm::radians(mouse_.yaw), glm::vec3(0, 1, 0));
-            M = glm::rotate(M, glm::radians(mouse_.pitch), glm::vec3(1, 0, 0));
-            M = glm::scale(M, mouse_.size * 0.9f);
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
+            glm::mat4 M = mouseModel();
 
             float glow = mouseInvincible_ ? 0.8f : 0.05f;
             glm::vec3 color = mouseInvincible_ ? glm::vec3(1.0f, 1.0f, 0.5f) : mouse_.color;
@@ -1317,35 +1627,58 @@
                 if (blink > 0.5f) glow = 0.8f;
             }
 
-            setMat(color, glow, 0.35f, 0.8f, 0.3f, 28.0f);
-            drawMesh(mouseModel_);
+            submit(RenderPass::Opaque, SurfaceTexture(), assets_->Get(mouseHandle_), MatMouse, M, color, glow);
         }
 
         // Cat
         {
-            glm::mat4 M = glm::translate(glm::mat4(1.f), cat_.pos);
-            M = glm::rotate(M, glm::radians(cat_.yaw), glm::vec3(0, 1, 0));
-            M = glm::rotate(M, glm::radians(cat_.pitch), glm::vec3(1, 0, 0));
-            M = glm::scale(M, cat_.size);
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
+            glm::mat4 M = catModel();
 
             glm::vec3 color = catFrozen_ ? glm::vec3(0.5f, 0.7f, 1.0f) : cat_.color;
             float glow = catFrozen_ ? 0.4f : 0.05f;
 
-            setMat(color, glow, 0.4f, 0.85f, 0.25f, 24.0f);
-            drawMesh(catModel_);
+            submit(RenderPass::Opaque, SurfaceTexture(), assets_->Get(catHandle_), MatCat, M, color, glow);
         }
 
         // Collision effect
         if (showCollisionEffect_) {
-            glDisable(GL_DEPTH_TEST);
             glm::mat4 M = glm::translate(glm::mat4(1.f), collisionPosition_);
             M = glm::scale(M, glm::vec3(2.0f + (0.5f - collisionEffectTimer_) * 4.0f));
-            glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(M));
             float alpha = collisionEffectTimer_ / 0.5f;
-            setMat({ 1.0f, 0.5f, 0.0f }, alpha * 3.0f, 0.5f, 0.5f, 0.9f, 128.0f);
-            drawMesh(sphere_);
-            glEnable(GL_DEPTH_TEST);
+            submit(RenderPass::Overlay, SurfaceTexture(), sphere_, MatEffect, M, { 1.0f, 0.5f, 0.0f }, alpha * 3.0f);
+        }
+
+        // Occluders: the walls and any furniture with a footprint of at least 1.5 square units;
+        // smaller pieces hide little and would only cost raster time
+        const OcclusionCuller* occlusion = nullptr;
+        if (occlusionEnabled_) {
+            occlusion_->Begin(V, cam_.proj());
+            for (const auto& w : walls_) {
+                AABB b = w.bounds();
+                occlusion_->AddOccluderBox(b.min, b.max);
+            }
+            for (const auto& f : furniture_) {
+                if (f.size.x * f.size.z < 1.5f) continue;
+                AABB b = f.bounds();
+                occlusion_->AddOccluderBox(b.min, b.max);
+            }
+            occlusion_->Rasterize(frameStats_);
+            occlusion = occlusion_.get();
+        }
+
+        renderQueue_->Cull(cam_.frustum(), occlusion, frameStats_);
+        renderQueue_->Sort();
+        if (deferred) {
+            gbuffer_->BindForWriting();
+            renderQueue_->Execute(frameStats_, RenderPass::Opaque, RenderPass::DoubleSided);
+            deferred_->Light(*gbuffer_, cam_.proj() * V, cam_.frustum(), pointLights_, background, frameStats_);
+
+            // Blended and overlay draws go on top of the lit result, depth tested against the G-buffer
+            gbuffer_->BindForForward();
+            renderQueue_->Execute(frameStats_, RenderPass::NoDepthWrite, RenderPass::Overlay);
+        }
+        else {
+            renderQueue_->Execute(frameStats_);
         }
 
         // Advanced systems
@@ -1358,6 +1691,177 @@
         }
     }
 
+    // Point lights for this frame: the level's lamps, the kMaxCheeseLights cheeses still in play
+    // nearest the camera (by squared distance, picked with nth_element), every power-up still in
+    // play, live lightning bolts and the benchmark lights
+    void Game::gatherPointLights() {
+        // Same hues as the power-up looks in renderScene()
+        static const glm::vec3 powerUpGlow[3] = {
+            { 1.0f, 0.84f, 0.0f }, { 0.0f, 1.0f, 1.0f }, { 0.3f, 0.5f, 1.0f }
+        };
+
+        pointLights_.assign(lamps_.begin(), lamps_.end());
+
+        // Only the cheeses nearest the camera glow: the stress level has thousands, and a light
+        // each would swamp the cluster build and the per-fragment loop
+        const glm::vec3 eye = cam_.position();
+        cheeseLights_.clear();
+        for (const auto& c : cheeses_) {
+            if (c.taken) continue;
+            glm::vec3 p = c.pos + glm::vec3(0.0f, c.bobOffset + 0.3f, 0.0f);
+            glm::vec3 d = p - eye;
+            cheeseLights_.push_back(glm::vec4(p, glm::dot(d, d)));
+        }
+        if (cheeseLights_.size() > kMaxCheeseLights) {
+            std::nth_element(cheeseLights_.begin(), cheeseLights_.begin() + kMaxCheeseLights, cheeseLights_.end(),
+                [](const glm::vec4& a, const glm::vec4& b) { return a.w < b.w; });
+            cheeseLights_.resize(kMaxCheeseLights);
+        }
+        for (const glm::vec4& c : cheeseLights_) {
+            pointLights_.push_back({ glm::vec4(glm::vec3(c), 1.5f), glm::vec4(0.6f, 0.5f, 0.15f, 0.0f) });
+        }
+        for (const auto& p : powerups_) {
+            if (p.taken) continue;
+            glm::vec3 pos = p.pos + glm::vec3(0.0f, p.bobOffset, 0.0f);
+            pointLights_.push_back({ glm::vec4(pos, 2.5f), glm::vec4(powerUpGlow[p.type] * 1.5f, 0.0f) });
+        }
+        if (showCollisionEffect_) {
+            float flash = collisionEffectTimer_ / 0.5f;
+            pointLights_.push_back({ glm::vec4(collisionPosition_, 4.0f), glm::vec4(3.0f * flash, 1.5f * flash, 0.0f, 0.0f) });
+        }
+        if (lightningSystem_) lightningSystem_->AppendLights(pointLights_);
+
+        // Benchmark lights drift around the room on fixed pseudo-random orbits
+        for (int i = 0; i < benchmarkLights_; ++i) {
+            float t = gameTime_ * (0.3f + 0.05f * (float)(i % 7));
+            glm::vec3 pos(std::sin(t + (float)i * 1.7f) * 8.0f, 0.6f + 0.5f * std::sin((float)i * 0.9f),
+                std::cos(t * 0.8f + (float)i * 2.3f) * 5.5f);
+            glm::vec3 hue(0.5f + 0.5f * std::sin((float)i), 0.5f + 0.5f * std::sin((float)i + 2.1f),
+                0.5f + 0.5f * std::sin((float)i + 4.2f));
+            pointLights_.push_back({ glm::vec4(pos, 2.0f), glm::vec4(hue * 0.8f, 0.0f) });
+        }
+    }
+
+
+    // Light 0 shadow casters. Walls and furniture only change in resetWorld(), so they are drawn
+    // into the cached static layer on demand; every frame starts from a copy of it and only
+    // the mouse, cat and cheese are rasterized.
+    void Game::renderShadows() {
+        if (!shadowMap_) return;
+        const glm::mat4& lightSpace = frameBlock_.lightSpace;
+
+        // Depth only: no texture/material, so packets group by mesh and LOD alone
+        auto submit = [&](const Mesh& mesh, int lod, const glm::mat4& M) {
+            shadowQueue_->Submit(RenderPass::Opaque, shadowProgram_, SurfaceTexture(), mesh, lod, 0, M, glm::vec4(0.0f), 0.0f);
+            };
+
+        if (shadowMap_->StaticDirty(lightSpace)) {
+            shadowQueue_->Clear();
+            for (const auto& w : walls_) {
+                submit(box_, 0, glm::scale(glm::translate(glm::mat4(1.f), w.pos), w.size));
+            }
+            for (const auto& f : furniture_) {
+                submit(box_, 0, glm::scale(glm::translate(glm::mat4(1.f), f.pos), f.size));
+            }
+            shadowQueue_->Sort();
+            shadowMap_->BeginStaticPass(lightSpace);
+            shadowQueue_->Execute(frameStats_);
+            shadowMap_->EndShadowPass();
+        }
+
+        shadowQueue_->Clear();
+        const Mesh& cheeseMesh = assets_->Get(cheeseHandle_);
+        for (const auto& c : cheeses_) {
+            if (c.taken) continue;
+            glm::mat4 M = cheeseModel(c);
+            submit(cheeseMesh, selectLod(cheeseMesh, M), M);
+        }
+        const Mesh& mouseMesh = assets_->Get(mouseHandle_);
+        const Mesh& catMesh = assets_->Get(catHandle_);
+        glm::mat4 mouseM = mouseModel();
+        glm::mat4 catM = catModel();
+        submit(mouseMesh, selectLod(mouseMesh, mouseM), mouseM);
+        submit(catMesh, selectLod(catMesh, catM), catM);
+        shadowQueue_->Sort();
+
+        shadowMap_->BeginShadowPass(lightSpace);
+        shadowQueue_->Execute(frameStats_);
+        shadowMap_->EndShadowPass();
+    }
+
+    glm::mat4 Game::mouseModel() const {
+        glm::mat4 M = glm::translate(glm::mat4(1.f), mouse_.pos);
+        M = glm::rotate(M, glm::radians(mouse_.yaw), glm::vec3(0, 1, 0));
+        M = glm::rotate(M, glm::radians(mouse_.pitch), glm::vec3(1, 0, 0));
+        return glm::scale(M, mouse_.size * 0.9f);
+    }
+
+    glm::mat4 Game::catModel() const {
+        glm::mat4 M = glm::translate(glm::mat4(1.f), cat_.pos);
+        M = glm::rotate(M, glm::radians(cat_.yaw), glm::vec3(0, 1, 0));
+        M = glm::rotate(M, glm::radians(cat_.pitch), glm::vec3(1, 0, 0));
+        return glm::scale(M, cat_.size);
+    }
+
+    glm::mat4 Game::cheeseModel(const Cheese& c) const {
+        glm::mat4 M = glm::translate(glm::mat4(1.f), c.pos + glm::vec3(0, c.bobOffset, 0));
+        M = glm::rotate(M, c.rotation, glm::vec3(0, 1, 0));
+        return glm::scale(M, glm::vec3(0.45f));
+    }
+
+    // Coarsest LOD whose error stays under a pixel for this placement
+    int Game::selectLod(const Mesh& mesh, const glm::mat4& model) const {
+        glm::vec3 worldPos(model[3]);
+        float worldScale = std::max(glm::length(glm::vec3(model[0])),
+            std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        float distance = glm::length(worldPos - cam_.position());
+        return selectMeshLod(mesh, worldScale, distance, lodPixelsPerUnit_);
+    }
+
+    // Prints average scene triangles per frame every few seconds
+    void Game::reportFrameStats(double now) {
+        GLStateCache::Counters stateCalls = glState().TakeCounters();
+        frameStats_.stateCallsIssued = stateCalls.issued;
+        frameStats_.stateCallsElided = stateCalls.elided;
+
+        if (statsWindowFrames_ == 0) statsWindowStart_ = now;
+        statsWindow_.Accumulate(frameStats_);
+        statsWindowFrames_++;
+
+        if (now - statsWindowStart_ < 5.0) return;
+        if (statsWindow_.trianglesFullDetail > 0) {
+            size_t frames = (size_t)statsWindowFrames_;
+            size_t full = statsWindow_.trianglesFullDetail / frames;
+            size_t submitted = statsWindow_.trianglesSubmitted / frames;
+            std::cout << "  Render: " << statsWindow_.drawCalls / statsWindowFrames_ << " draws, "
+                << statsWindow_.programBinds / statsWindowFrames_ << " program / "
+                << statsWindow_.textureBinds / statsWindowFrames_ << " texture / "
+                << statsWindow_.vaoBinds / statsWindowFrames_ << " VAO binds, "
+                << submitted << " tris/frame submitted (" << full << " at full detail, "
+                << (int)(100.0 - 100.0 * (double)submitted / (double)full) << "% saved by LOD)\n";
+            std::cout << "  Culling: " << statsWindow_.objectsVisible / statsWindowFrames_ << " visible, "
+                << statsWindow_.objectsCulled / statsWindowFrames_ << " culled, "
+                << statsWindow_.cullMs / statsWindowFrames_ << " ms/frame, "
+                << statsWindow_.objectsOccluded / statsWindowFrames_ << " occluded in "
+                << statsWindow_.occlusionMs / statsWindowFrames_ << " ms/frame, "
+                << statsWindow_.lightsVisible / statsWindowFrames_ << " point lights lit, "
+                << statsWindow_.lightsCulled / statsWindowFrames_ << " culled\n";
+            std::cout << "  Clusters: " << statsWindow_.clusterMs / statsWindowFrames_ << " ms/frame CPU build\n";
+            std::cout << "  Post GPU: " << statsWindow_.bloomDownGpuMs / statsWindowFrames_ << " ms bloom down, "
+                << statsWindow_.bloomUpGpuMs / statsWindowFrames_ << " ms bloom up, "
+                << statsWindow_.volumetricGpuMs / statsWindowFrames_ << " ms light shafts, "
+                << statsWindow_.tonemapGpuMs / statsWindowFrames_ << " ms tonemap+FXAA\n";
+            std::cout << "  Resolution: " << (int)(100.0 * statsWindow_.renderScale / statsWindowFrames_ + 0.5)
+                << "% average scale, " << statsWindow_.frameGpuMs / statsWindowFrames_ << " ms/frame GPU\n";
+    #ifndef NDEBUG
+            std::cout << "  GL state: " << statsWindow_.stateCallsIssued / statsWindowFrames_ << " calls issued, "
+                << statsWindow_.stateCallsElided / statsWindowFrames_ << " elided per frame\n";
+    #endif
+        }
+        statsWindow_.Reset();
+        statsWindowFrames_ = 0;
+    }
+
 
     // REPLACE the renderIntro() function in Game.cpp with this:
 
@@ -1370,13 +1874,13 @@
     void Game::renderIntro() {
         int fbWidth, fbHeight;
         glfwGetFramebufferSize(win_, &fbWidth, &fbHeight);
-        glViewport(0, 0, fbWidth, fbHeight);
+        renderDevice().Viewport(0, 0, fbWidth, fbHeight);
 
-        glClearColor(0.15f, 0.15f, 0.25f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderDevice().ClearColor(0.15f, 0.15f, 0.25f, 1.0f);
+        renderDevice().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        glState().Disable(GL_DEPTH_TEST);
+        glState().Disable(GL_CULL_FACE);
 
         if (!uiRenderer_) {
             std::cout << "PRESS 'U' TO START THE GAME!\n";
@@ -1485,7 +1989,7 @@
         uiRenderer_->RenderRect(w - cornerSize - 10, h - cornerSize - 10, cornerSize, cornerSize, { 1.0f, 1.0f, 0.2f, 0.8f });
 
         uiRenderer_->EndUI();
-        glEnable(GL_DEPTH_TEST);
+        glState().Enable(GL_DEPTH_TEST);
     }
 
     void Game::renderUI() {
@@ -1552,10 +2056,10 @@
         if (!uiRenderer_) return;
 
         // Force correct OpenGL state for 2D rendering
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glState().Disable(GL_DEPTH_TEST);
+        glState().Disable(GL_CULL_FACE);
+        glState().Enable(GL_BLEND);
+        glState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         int fbWidth, fbHeight;
         glfwGetFramebufferSize(win_, &fbWidth, &fbHeight);
@@ -1755,10 +2259,10 @@
         }
 
         // Force correct OpenGL state for 2D rendering
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glState().Disable(GL_DEPTH_TEST);
+        glState().Disable(GL_CULL_FACE);
+        glState().Enable(GL_BLEND);
+        glState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         // Get window size
         int fbWidth, fbHeight;
@@ -0,0 +1,100 @@
+#include "game/GeometryArena.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
+#include <iostream>
+
+namespace game {
+
+    GeometryArena::GeometryArena(const VertexLayout& layout, GLenum indexType,
+        size_t vertexCapacity, size_t indexCapacity)
+        : layout_(layout), indexType_(indexType), indexSize_(indexTypeSize(indexType)),
+        vertexCapacity_(vertexCapacity), indexCapacity_(indexCapacity) {
+        vao_ = renderDevice().GenVertexArray();
+        vbo_ = renderDevice().GenBuffer();
+        ebo_ = renderDevice().GenBuffer();
+
+        glState().BindVertexArray(vao_);
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity_, nullptr, GL_STATIC_DRAW);
+        glState().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+        renderDevice().BufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity_, nullptr, GL_STATIC_DRAW);
+        setupVertexAttribs(layout_);
+        glState().BindVertexArray(0);
+    }
+
+    GeometryArena::~GeometryArena() {
+        glState().DeleteBuffer(ebo_);
+        glState().DeleteBuffer(vbo_);
+        glState().DeleteVertexArray(vao_);
+    }
+
+    bool GeometryArena::Accepts(const VertexLayout& layout, GLenum indexType) const {
+        if (indexType != indexType_) return false;
+        if (layout.stride != layout_.stride || layout.attribCount != layout_.attribCount) return false;
+        for (int a = 0; a < layout.attribCount; ++a) {
+            const VertexAttrib& x = layout.attribs[a];
+            const VertexAttrib& y = layout_.attribs[a];
+            if (x.location != y.location || x.components != y.components || x.type != y.type ||
+                x.normalized != y.normalized || x.offset != y.offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Reallocates at least double the size and copies the old contents over on the GPU
+    void GeometryArena::Grow(GLenum target, GLuint& buffer, size_t& capacity, size_t used, size_t needed) {
+        size_t newCapacity = std::max(capacity * 2, used + needed);
+
+        GLuint grown = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        renderDevice().BufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity, nullptr, GL_STATIC_DRAW);
+        if (used > 0) {
+            glState().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+            renderDevice().CopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)used);
+        }
+        glState().DeleteBuffer(buffer);
+        buffer = grown;
+        capacity = newCapacity;
+
+        // Re-point the shared VAO at the new storage
+        glState().BindVertexArray(vao_);
+        glState().BindBuffer(target, buffer);
+        if (target == GL_ARRAY_BUFFER) setupVertexAttribs(layout_);
+        glState().BindVertexArray(0);
+
+        std::cout << "  Geometry arena: grew " << (target == GL_ARRAY_BUFFER ? "vertex" : "index")
+            << " buffer to " << newCapacity / 1024 << " KB\n";
+    }
+
+    Mesh GeometryArena::Add(const void* vertices, GLsizeiptr vertexBytes,
+        const void* indices, GLsizei indexCount,
+        const MeshLod* lods, int lodCount,
+        const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        size_t indexBytes = (size_t)indexCount * indexSize_;
+        if (vertexUsed_ + (size_t)vertexBytes > vertexCapacity_) {
+            Grow(GL_ARRAY_BUFFER, vbo_, vertexCapacity_, vertexUsed_, (size_t)vertexBytes);
+        }
+        if (indexUsed_ + indexBytes > indexCapacity_) {
+            Grow(GL_ELEMENT_ARRAY_BUFFER, ebo_, indexCapacity_, indexUsed_, indexBytes);
+        }
+
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexUsed_, vertexBytes, vertices);
+        // GL_ELEMENT_ARRAY_BUFFER binding is VAO state, so upload indices through the copy target
+        glState().BindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+        renderDevice().BufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)indexUsed_, (GLsizeiptr)indexBytes, indices);
+
+        Mesh m = describeMesh(layout_, indexCount, indexType_, lods, lodCount, boundsMin, boundsMax);
+        m.vao = vao_;
+        m.baseVertex = (GLint)(vertexUsed_ / (size_t)layout_.stride);
+        m.firstIndex = (unsigned int)(indexUsed_ / indexSize_);
+
+        vertexUsed_ += (size_t)vertexBytes;
+        indexUsed_ += indexBytes;
+        meshCount_++;
+        return m;
+    }
+
+} // namespace game
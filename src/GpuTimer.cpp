@@ -0,0 +1,30 @@
+#include "game/GpuTimer.h"
+#include "game/RenderDevice.h"
+
+namespace game {
+
+    GpuTimer::GpuTimer(int queriesPerFrame)
+        : count_(queriesPerFrame), queries_((size_t)kFrames * queriesPerFrame), values_((size_t)queriesPerFrame, 0) {
+        for (GLuint& query : queries_) query = renderDevice().GenQuery();
+    }
+
+    GpuTimer::~GpuTimer() {
+        for (GLuint query : queries_) renderDevice().DeleteQuery(query);
+    }
+
+    bool GpuTimer::Collect() {
+        if (!issued_[slot_]) return false;
+        // Queries finish in order, so the last one being available covers the whole slot
+        if (!renderDevice().QueryResultAvailable(Query(count_ - 1))) return false;
+        for (int i = 0; i < count_; ++i) {
+            values_[i] = renderDevice().GetQueryResult64(Query(i));
+        }
+        return true;
+    }
+
+    void GpuTimer::EndFrame() {
+        issued_[slot_] = true;
+        slot_ = (slot_ + 1) % kFrames;
+    }
+
+} // namespace game
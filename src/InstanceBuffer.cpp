@@ -0,0 +1,55 @@
+#include "game/InstanceBuffer.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+
+namespace game {
+
+    InstanceBuffer::InstanceBuffer() {
+        vbo_ = renderDevice().GenBuffer();
+        capacity_ = 1024;
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity_ * sizeof(InstanceData)), nullptr, GL_STREAM_DRAW);
+        glState().BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    InstanceBuffer::~InstanceBuffer() {
+        glState().DeleteBuffer(vbo_);
+    }
+
+    void InstanceBuffer::BindVertexArray(GLuint vao) {
+        glState().BindVertexArray(vao);
+        if (!attached_.insert(vao).second) return;
+        for (GLuint c = 0; c < 4; ++c) {
+            renderDevice().EnableVertexAttrib(kInstanceModelLocation + c);
+            renderDevice().VertexAttribDivisor(kInstanceModelLocation + c, 1);
+        }
+        renderDevice().EnableVertexAttrib(kInstanceColorLocation);
+        renderDevice().VertexAttribDivisor(kInstanceColorLocation, 1);
+        renderDevice().EnableVertexAttrib(kInstanceSurfaceLocation);
+        renderDevice().VertexAttribDivisor(kInstanceSurfaceLocation, 1);
+    }
+
+    void InstanceBuffer::BindRange(size_t first) {
+        size_t base = first * sizeof(InstanceData);
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        for (GLuint c = 0; c < 4; ++c) {
+            renderDevice().VertexAttribPointer(kInstanceModelLocation + c, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*)(base + offsetof(InstanceData, model) + c * sizeof(glm::vec4)));
+        }
+        renderDevice().VertexAttribPointer(kInstanceColorLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(base + offsetof(InstanceData, colorEmissive)));
+        renderDevice().VertexAttribPointer(kInstanceSurfaceLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(base + offsetof(InstanceData, surface)));
+    }
+
+    void InstanceBuffer::Upload(const InstanceData* instances, size_t count) {
+        if (count > capacity_) {
+            while (capacity_ < count) capacity_ *= 2;
+        }
+
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity_ * sizeof(InstanceData)), nullptr, GL_STREAM_DRAW);
+        renderDevice().BufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(count * sizeof(InstanceData)), instances);
+    }
+
+} // namespace game
@@ -0,0 +1,123 @@
+#include "game/JobSystem.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+namespace game {
+
+    JobSystem::JobSystem(unsigned int workerCount) {
+        if (workerCount == 0) {
+            unsigned int hw = std::thread::hardware_concurrency();
+            workerCount = hw > 1 ? hw - 1 : 1;
+        }
+        workers_.reserve(workerCount);
+        for (unsigned int i = 0; i < workerCount; ++i) {
+            workers_.emplace_back(&JobSystem::WorkerMain, this);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+
+    void JobSystem::Submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(job));
+        }
+        wake_.notify_one();
+    }
+
+    void JobSystem::ParallelFor(size_t count, size_t grain,
+        const std::function<void(size_t, size_t, size_t)>& fn) {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1) {
+            fn(0, 0, count);
+            return;
+        }
+
+        // Chunks are claimed from a shared cursor, so a helper that starts late just finds
+        // nothing left; the state outlives this call for exactly that case
+        struct State {
+            std::atomic<size_t> next{ 0 };
+            std::atomic<size_t> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        std::shared_ptr<State> state = std::make_shared<State>();
+        const std::function<void(size_t, size_t, size_t)>* body = &fn;
+
+        auto runChunks = [state, body, chunks, count, grain] {
+            for (;;) {
+                size_t chunk = state->next.fetch_add(1);
+                if (chunk >= chunks) return;
+                size_t begin = chunk * grain;
+                size_t end = begin + grain < count ? begin + grain : count;
+                try {
+                    (*body)(chunk, begin, end);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "  Job failed: " << e.what() << "\n";
+                }
+                if (state->done.fetch_add(1) + 1 == chunks) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min((size_t)workers_.size(), chunks - 1);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < helpers; ++i) queue_.push_front(runChunks);
+        }
+        if (helpers == 1) wake_.notify_one();
+        else wake_.notify_all();
+
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done.load() == chunks; });
+    }
+
+    void JobSystem::WaitIdle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+    }
+
+    void JobSystem::WorkerMain() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return quit_ || !queue_.empty(); });
+                if (queue_.empty()) return;     // quitting and drained
+                job = std::move(queue_.front());
+                queue_.pop_front();
+                running_++;
+            }
+
+            // A throwing job must not take the worker (and the process) down with it
+            try {
+                job();
+            }
+            catch (const std::exception& e) {
+                std::cerr << "  Job failed: " << e.what() << "\n";
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_--;
+                if (queue_.empty() && running_ == 0) idle_.notify_all();
+            }
+        }
+    }
+
+} // namespace game
@@ -0,0 +1,167 @@
+#include "game/LightClusters.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace game {
+
+    static const size_t kClusterCount = (size_t)LightClusters::kTilesX * LightClusters::kTilesY * LightClusters::kSlices;
+
+    static void createTextureBuffer(GLenum format, GLuint& buffer, GLuint& texture) {
+        buffer = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_TEXTURE_BUFFER, buffer);
+        renderDevice().BufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        glState().BindTexture(0, GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    }
+
+    LightClusters::LightClusters() {
+        createTextureBuffer(GL_RGBA32F, lightBuffer_, lightTexture_);
+        createTextureBuffer(GL_RG32UI, rangeBuffer_, rangeTexture_);
+        createTextureBuffer(GL_R16UI, indexBuffer_, indexTexture_);
+        ranges_.assign(2 * kClusterCount, 0);
+
+        block_.grid = glm::ivec4(kTilesX, kTilesY, kSlices, 0);
+        block_.params = glm::vec4(0.0f);
+        ubo_ = std::make_unique<UniformBuffer>(kClusterBlockBinding, sizeof(ClusterBlock));
+        ubo_->Update(&block_, sizeof(block_));
+    }
+
+    LightClusters::~LightClusters() {
+        glState().DeleteTexture(lightTexture_);
+        glState().DeleteTexture(rangeTexture_);
+        glState().DeleteTexture(indexTexture_);
+        glState().DeleteBuffer(lightBuffer_);
+        glState().DeleteBuffer(rangeBuffer_);
+        glState().DeleteBuffer(indexBuffer_);
+    }
+
+    void LightClusters::Build(const std::vector<PointLight>& lights, const glm::mat4& view, const glm::mat4& proj,
+        int width, int height, FrameStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+
+        // Planes of a standard perspective matrix; slice = log(depth) * scale + bias puts
+        // slice 0 at the near plane and kSlices at the far plane
+        const float zNear = proj[3][2] / (proj[2][2] - 1.0f);
+        const float zFar = proj[3][2] / (proj[2][2] + 1.0f);
+        const float sliceScale = (float)kSlices / std::log(zFar / zNear);
+        const float sliceBias = -std::log(zNear) * sliceScale;
+        const float tileW = std::ceil((float)std::max(width, 1) / kTilesX);
+        const float tileH = std::ceil((float)std::max(height, 1) / kTilesY);
+        auto slice = [&](float depth) {
+            return std::min(std::max((int)(std::log(depth) * sliceScale + sliceBias), 0), kSlices - 1);
+            };
+        auto tile = [](float ndc, float size, float tileSize, int tiles) {
+            return std::min(std::max((int)((ndc * 0.5f + 0.5f) * size / tileSize), 0), tiles - 1);
+            };
+
+        size_t count = std::min(lights.size(), (size_t)kMaxLights);
+        lightData_.resize(2 * count);
+        lightBounds_.resize(6 * count);
+        std::fill(ranges_.begin(), ranges_.end(), 0u);
+        int visible = 0;
+
+        // Pass 1: froxel bounds per light and per-cluster counts
+        for (size_t i = 0; i < count; ++i) {
+            const PointLight& light = lights[i];
+            lightData_[2 * i] = light.positionRadius;
+            lightData_[2 * i + 1] = light.color;
+
+            uint8_t* b = &lightBounds_[6 * i];
+            glm::vec3 c = glm::vec3(view * glm::vec4(glm::vec3(light.positionRadius), 1.0f));
+            float r = light.positionRadius.w;
+            float depth = -c.z;
+            b[4] = 1;
+            b[5] = 0;
+            if (depth + r < zNear || depth - r > zFar) continue;
+
+            // Screen rectangle of the sphere's view-space box; it projects to the hull of its
+            // corners as long as the box stays in front of the near plane
+            int x0 = 0, x1 = kTilesX - 1, y0 = 0, y1 = kTilesY - 1;
+            if (depth - r > zNear) {
+                float dNear = depth - r, dFar = depth + r;
+                float minX = std::min((c.x - r) / dNear, (c.x - r) / dFar) * proj[0][0];
+                float maxX = std::max((c.x + r) / dNear, (c.x + r) / dFar) * proj[0][0];
+                float minY = std::min((c.y - r) / dNear, (c.y - r) / dFar) * proj[1][1];
+                float maxY = std::max((c.y + r) / dNear, (c.y + r) / dFar) * proj[1][1];
+                if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) continue;
+                x0 = tile(minX, (float)width, tileW, kTilesX);
+                x1 = tile(maxX, (float)width, tileW, kTilesX);
+                y0 = tile(minY, (float)height, tileH, kTilesY);
+                y1 = tile(maxY, (float)height, tileH, kTilesY);
+            }
+            int z0 = slice(std::max(depth - r, zNear));
+            int z1 = slice(std::min(depth + r, zFar));
+            b[0] = (uint8_t)x0; b[1] = (uint8_t)x1;
+            b[2] = (uint8_t)y0; b[3] = (uint8_t)y1;
+            b[4] = (uint8_t)z0; b[5] = (uint8_t)z1;
+            visible++;
+
+            for (int z = z0; z <= z1; ++z) {
+                for (int y = y0; y <= y1; ++y) {
+                    uint32_t* row = &ranges_[2 * (((size_t)z * kTilesY + y) * kTilesX)];
+                    for (int x = x0; x <= x1; ++x) row[2 * x + 1]++;
+                }
+            }
+        }
+
+        // Offsets from the counts; the counts restart at zero and are rebuilt while filling
+        uint32_t total = 0;
+        for (size_t cl = 0; cl < kClusterCount; ++cl) {
+            ranges_[2 * cl] = total;
+            total += ranges_[2 * cl + 1];
+            ranges_[2 * cl + 1] = 0;
+        }
+        indices_.resize(total);
+
+        // Pass 2: scatter the light indices, which stay sorted within each cluster
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* b = &lightBounds_[6 * i];
+            for (int z = b[4]; z <= b[5]; ++z) {
+                for (int y = b[2]; y <= b[3]; ++y) {
+                    uint32_t* row = &ranges_[2 * (((size_t)z * kTilesY + y) * kTilesX)];
+                    for (int x = b[0]; x <= b[1]; ++x) {
+                        indices_[row[2 * x] + row[2 * x + 1]++] = (uint16_t)i;
+                    }
+                }
+            }
+        }
+
+        block_.grid = glm::ivec4(kTilesX, kTilesY, kSlices, (int)count);
+        block_.params = glm::vec4(sliceScale, sliceBias, tileW, tileH);
+
+        stats.lightsVisible += visible;
+        stats.lightsCulled += (int)(lights.size() - (size_t)visible);
+        stats.clusterMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void LightClusters::Upload() {
+        glState().BindBuffer(GL_TEXTURE_BUFFER, lightBuffer_);
+        renderDevice().BufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(lightData_.size() * sizeof(glm::vec4)),
+            lightData_.data(), GL_STREAM_DRAW);
+        glState().BindBuffer(GL_TEXTURE_BUFFER, rangeBuffer_);
+        renderDevice().BufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(ranges_.size() * sizeof(uint32_t)),
+            ranges_.data(), GL_STREAM_DRAW);
+        glState().BindBuffer(GL_TEXTURE_BUFFER, indexBuffer_);
+        renderDevice().BufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(indices_.size() * sizeof(uint16_t)),
+            indices_.data(), GL_STREAM_DRAW);
+        ubo_->Update(&block_, sizeof(block_));
+        enabled_ = true;
+
+        glState().BindTexture(kLightUnit, GL_TEXTURE_BUFFER, lightTexture_);
+        glState().BindTexture(kRangeUnit, GL_TEXTURE_BUFFER, rangeTexture_);
+        glState().BindTexture(kIndexUnit, GL_TEXTURE_BUFFER, indexTexture_);
+    }
+
+    void LightClusters::Disable() {
+        if (!enabled_) return;
+        ClusterBlock off = block_;
+        off.grid.w = 0;
+        ubo_->Update(&off, sizeof(off));
+        enabled_ = false;
+    }
+
+} // namespace game
@@ -1,26 +1,38 @@
 #include "game/LightningSystem.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include "game/ShaderManager.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
+#include <stdexcept>
+
+static constexpr UniformName kViewUniform("uView");
+static constexpr UniformName kProjUniform("uProj");
+static constexpr UniformName kColorUniform("uColor");
+static constexpr UniformName kAlphaUniform("uAlpha");
 
 LightningSystem::LightningSystem()
-    : vao_(0), vbo_(0), shader_(0),
-    uView_(-1), uProj_(-1), uColor_(-1), uAlpha_(-1) {
+    : vao_(0), vbo_(0) {
 }
 
 LightningSystem::~LightningSystem() {
-    if (vao_) glDeleteVertexArrays(1, &vao_);
-    if (vbo_) glDeleteBuffers(1, &vbo_);
-    if (shader_) glDeleteProgram(shader_);
+    game::glState().DeleteVertexArray(vao_);
+    game::glState().DeleteBuffer(vbo_);
 }
 
 void LightningSystem::Init() {
-    InitGL();
+    InitShaders();
+    InitBuffers();
+}
+
+void LightningSystem::InitHeadless() {
+    InitBuffers();
 }
 
-void LightningSystem::InitGL() {
+void LightningSystem::InitShaders() {
     // Lightning shader
     const char* vertSrc = R"(
         #version 330 core
@@ -46,62 +58,23 @@ void LightningSystem::InitGL() {
         }
     )";
 
-    // Compile shaders
-    GLuint vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vertSrc, nullptr);
-    glCompileShader(vert);
-
-    GLint success;
-    glGetShaderiv(vert, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(vert, 512, nullptr, log);
-        std::cerr << "Lightning vertex shader error: " << log << std::endl;
-    }
-
-    GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fragSrc, nullptr);
-    glCompileShader(frag);
-
-    glGetShaderiv(frag, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(frag, 512, nullptr, log);
-        std::cerr << "Lightning fragment shader error: " << log << std::endl;
-    }
-
-    shader_ = glCreateProgram();
-    glAttachShader(shader_, vert);
-    glAttachShader(shader_, frag);
-    glLinkProgram(shader_);
-
-    glGetProgramiv(shader_, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(shader_, 512, nullptr, log);
-        std::cerr << "Lightning shader link error: " << log << std::endl;
+    // Compiled (or loaded from the program cache); the error has been logged when it fails
+    if (!shader_.LoadFromStrings(vertSrc, fragSrc)) {
+        throw std::runtime_error("lightning shaders failed to build");
     }
+}
 
-    glDeleteShader(vert);
-    glDeleteShader(frag);
-
-    // Get uniform locations
-    uView_ = glGetUniformLocation(shader_, "uView");
-    uProj_ = glGetUniformLocation(shader_, "uProj");
-    uColor_ = glGetUniformLocation(shader_, "uColor");
-    uAlpha_ = glGetUniformLocation(shader_, "uAlpha");
-
-    // Create VAO/VBO
-    glGenVertexArrays(1, &vao_);
-    glGenBuffers(1, &vbo_);
+void LightningSystem::InitBuffers() {
+    vao_ = game::renderDevice().GenVertexArray();
+    vbo_ = game::renderDevice().GenBuffer();
 
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    game::glState().BindVertexArray(vao_);
+    game::glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    game::renderDevice().EnableVertexAttrib(0);
+    game::renderDevice().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    glBindVertexArray(0);
+    game::glState().BindVertexArray(0);
 }
 
 void LightningSystem::GenerateBolt(LightningBolt& bolt, const glm::vec3& start, const glm::vec3& end, int depth) {
@@ -161,25 +134,35 @@ void LightningSystem::Update(float dt) {
     }
 }
 
+void LightningSystem::AppendLights(std::vector<game::PointLight>& lights) const {
+    for (const auto& bolt : bolts_) {
+        if (bolt.points.empty()) continue;
+        float fade = bolt.life / bolt.maxLife;
+        lights.push_back({ glm::vec4(bolt.points[bolt.points.size() / 2], 6.0f),
+            glm::vec4(bolt.color * 4.0f * fade, 0.0f) });
+    }
+}
+
 void LightningSystem::Render(const glm::mat4& view, const glm::mat4& proj) {
     if (bolts_.empty()) return;
 
-    glUseProgram(shader_);
-    glUniformMatrix4fv(uView_, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(uProj_, 1, GL_FALSE, glm::value_ptr(proj));
+    game::GLStateCache& gl = game::glState();
+    shader_.Use();
+    shader_.SetMat4(kViewUniform, view);
+    shader_.SetMat4(kProjUniform, proj);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
-    glDisable(GL_DEPTH_TEST);
-    glLineWidth(3.0f);
+    gl.Enable(GL_BLEND);
+    gl.BlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+    gl.Disable(GL_DEPTH_TEST);
+    game::renderDevice().LineWidth(3.0f);
 
-    glBindVertexArray(vao_);
+    gl.BindVertexArray(vao_);
 
     for (const auto& bolt : bolts_) {
         float alpha = bolt.life / bolt.maxLife;
 
-        glUniform3fv(uColor_, 1, glm::value_ptr(bolt.color));
-        glUniform1f(uAlpha_, alpha);
+        shader_.SetVec3(kColorUniform, bolt.color);
+        shader_.SetFloat(kAlphaUniform, alpha);
 
         // Upload line strip data
         std::vector<float> data;
@@ -189,15 +172,13 @@ void LightningSystem::Render(const glm::mat4& view, const glm::mat4& proj) {
             data.push_back(p.z);
         }
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STREAM_DRAW);
+        gl.BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        game::renderDevice().BufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STREAM_DRAW);
 
-        glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)bolt.points.size());
+        game::renderDevice().DrawArrays(GL_LINE_STRIP, 0, (GLsizei)bolt.points.size());
     }
 
-    glLineWidth(1.0f);
-    glEnable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    game::renderDevice().LineWidth(1.0f);
+    gl.Enable(GL_DEPTH_TEST);
+    gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
\ No newline at end of file
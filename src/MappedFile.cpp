@@ -0,0 +1,119 @@
+#include "game/MappedFile.h"
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace game {
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        file_ = file;
+        mapping_ = mapping;
+        data_ = static_cast<const unsigned char*>(view);
+        size_ = (size_t)size.QuadPart;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle((HANDLE)mapping_);
+        if (file_) CloseHandle((HANDLE)file_);
+        data_ = nullptr;
+        mapping_ = nullptr;
+        file_ = nullptr;
+        size_ = 0;
+    }
+#else
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) return false;
+
+        data_ = static_cast<const unsigned char*>(view);
+        size_ = (size_t)st.st_size;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+#endif
+
+    bool writeFileAtomic(const std::string& path, std::initializer_list<FileChunk> chunks) {
+        std::string tmpPath = path + ".tmp";
+        bool written = false;
+        {
+            std::ofstream f(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!f) return false;
+            for (const FileChunk& chunk : chunks) {
+                f.write(static_cast<const char*>(chunk.data), (std::streamsize)chunk.size);
+            }
+            f.close();
+            written = !f.fail();
+        }
+
+        std::error_code ec;
+        if (written) {
+            std::filesystem::rename(tmpPath, path, ec);
+            if (ec) {
+                // Some file systems refuse to rename over an existing file
+                std::filesystem::remove(path, ec);
+                std::filesystem::rename(tmpPath, path, ec);
+            }
+            if (!ec) return true;
+        }
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+} // namespace game
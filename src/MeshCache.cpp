@@ -0,0 +1,203 @@
+#include "game/MeshCache.h"
+#include "game/MappedFile.h"
+#include "game/MeshOptimizer.h"
+#include "game/MeshSimplifier.h"
+#include "game/Hash.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace game {
+
+    static uint64_t alignUp(uint64_t v, uint64_t a) {
+        return (v + a - 1) / a * a;
+    }
+
+    MeshCache::MeshCache(const std::string& directory, GeometryArena* arena)
+        : directory_(directory), arena_(arena) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        if (ec) {
+            std::cerr << "  Mesh cache: cannot create " << directory_ << " (" << ec.message() << ")\n";
+        }
+    }
+
+    uint64_t MeshCache::ComputeKey(const std::string& sourcePath, const std::string& generatorParams,
+        VertexFormat format) {
+        uint32_t versions[3] = { kMeshFileVersion, kMeshBuilderVersion, (uint32_t)format };
+        uint64_t h = hashBytes(versions, sizeof(versions));
+        h = hashString(generatorParams, h);
+
+        // Missing sources hash to the same key, so the procedural fallback stays cached
+        if (!sourcePath.empty()) {
+            MappedFile src;
+            if (src.Open(sourcePath)) {
+                h = hashBytes(src.Data(), src.Size(), h);
+            }
+        }
+        return h;
+    }
+
+    Mesh MeshCache::Load(const std::string& name, const std::string& sourcePath,
+        const std::string& generatorParams, const std::function<MeshData()>& build,
+        VertexFormat format) {
+        return Upload(Prepare(name, sourcePath, generatorParams, build, format));
+    }
+
+    PreparedMesh MeshCache::Prepare(const std::string& name, const std::string& sourcePath,
+        const std::string& generatorParams, const std::function<MeshData()>& build,
+        VertexFormat format) {
+        uint64_t key = ComputeKey(sourcePath, generatorParams, format);
+        std::string path = directory_ + "/" + name + ".gmesh";
+
+        PreparedMesh prepared;
+        prepared.name = name;
+        if (TryMap(path, key, prepared)) {
+            hits_++;
+            return prepared;
+        }
+
+        misses_++;
+        MeshData data = build();
+        optimizeMesh(data, name.c_str());
+        buildMeshLods(data, name.c_str());
+
+        prepared.buffers = encodeMesh(data, format);
+        prepared.layout = prepared.buffers.layout;
+        prepared.indexCount = prepared.buffers.indexCount;
+        prepared.indexType = prepared.buffers.indexType;
+        prepared.lodCount = (int)std::min(data.lods.size(), (size_t)kMaxMeshLods);
+        for (int l = 0; l < prepared.lodCount; ++l) prepared.lods[l] = data.lods[l];
+        computeBounds(data, prepared.boundsMin, prepared.boundsMax);
+
+        if (!Write(path, key, prepared.buffers, data)) {
+            std::cerr << "  Mesh cache: failed to write " << path << "\n";
+        }
+        return prepared;
+    }
+
+    Mesh MeshCache::Upload(const PreparedMesh& prepared) {
+        const void* vertices;
+        const void* indices;
+        GLsizeiptr vertexBytes;
+        if (prepared.file) {
+            // Blobs go straight from the mapping into the GL buffers
+            vertices = prepared.file->Data() + prepared.vertexOffset;
+            indices = prepared.file->Data() + prepared.indexOffset;
+            vertexBytes = (GLsizeiptr)prepared.vertexBytes;
+        }
+        else {
+            vertices = prepared.buffers.vertices.data();
+            indices = prepared.buffers.indices.data();
+            vertexBytes = (GLsizeiptr)prepared.buffers.vertices.size();
+        }
+
+        if (arena_ && arena_->Accepts(prepared.layout, prepared.indexType)) {
+            return arena_->Add(vertices, vertexBytes, indices, prepared.indexCount,
+                prepared.lods, prepared.lodCount, prepared.boundsMin, prepared.boundsMax);
+        }
+        return createMeshFromMemory(prepared.layout, vertices, vertexBytes,
+            indices, prepared.indexCount, prepared.indexType,
+            prepared.lods, prepared.lodCount, prepared.boundsMin, prepared.boundsMax);
+    }
+
+    bool MeshCache::TryMap(const std::string& path, uint64_t key, PreparedMesh& out) {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        if (!file->Open(path)) return false;
+        if (file->Size() < sizeof(MeshFileHeader)) return false;
+
+        MeshFileHeader header;
+        std::memcpy(&header, file->Data(), sizeof(header));
+
+        if (header.magic != kMeshFileMagic || header.version != kMeshFileVersion) return false;
+        if (header.key != key) return false;
+        if (header.attribCount == 0 || header.attribCount > 4) return false;
+        if (header.vertexOffset + header.vertexBytes > file->Size()) return false;
+        if (header.indexOffset + header.indexBytes > file->Size()) return false;
+        if (header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)) return false;
+        if (header.indexBytes != (uint64_t)header.indexCount * header.indexSize) return false;
+        if (header.vertexBytes != (uint64_t)header.vertexCount * header.vertexStride) return false;
+        if (header.lodCount == 0 || header.lodCount > (uint32_t)kMaxMeshLods) return false;
+
+        for (uint32_t l = 0; l < header.lodCount; ++l) {
+            const MeshFileLod& fl = header.lods[l];
+            if ((uint64_t)fl.indexOffset + fl.indexCount > header.indexCount) return false;
+            out.lods[l] = { fl.indexOffset, fl.indexCount, fl.error };
+        }
+        out.lodCount = (int)header.lodCount;
+
+        out.layout.stride = (GLsizei)header.vertexStride;
+        out.layout.attribCount = (int)header.attribCount;
+        for (uint32_t a = 0; a < header.attribCount; ++a) {
+            const MeshFileAttrib& fa = header.attribs[a];
+            out.layout.attribs[a] = { fa.location, (GLint)fa.components, (GLenum)fa.type,
+                (GLboolean)(fa.normalized ? GL_TRUE : GL_FALSE), fa.offset };
+        }
+
+        out.indexCount = (GLsizei)header.indexCount;
+        out.indexType = header.indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        out.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        out.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+        out.vertexOffset = header.vertexOffset;
+        out.vertexBytes = header.vertexBytes;
+        out.indexOffset = header.indexOffset;
+
+        // The mapping stays open until the upload has copied out of it
+        out.file = std::move(file);
+        return true;
+    }
+
+    bool MeshCache::Write(const std::string& path, uint64_t key, const MeshBuffers& buffers,
+        const MeshData& data) {
+        const VertexLayout& layout = buffers.layout;
+
+        MeshFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = kMeshFileMagic;
+        header.version = kMeshFileVersion;
+        header.key = key;
+        header.vertexCount = (uint32_t)data.vertices.size();
+        header.indexCount = (uint32_t)data.indices.size();
+        header.vertexStride = (uint32_t)layout.stride;
+        header.attribCount = (uint32_t)layout.attribCount;
+        for (int a = 0; a < layout.attribCount; ++a) {
+            const VertexAttrib& va = layout.attribs[a];
+            header.attribs[a] = { va.location, (uint32_t)va.components, (uint32_t)va.type,
+                (uint32_t)va.normalized, va.offset };
+        }
+
+        glm::vec3 bmin, bmax;
+        computeBounds(data, bmin, bmax);
+        for (int c = 0; c < 3; ++c) {
+            header.boundsMin[c] = bmin[c];
+            header.boundsMax[c] = bmax[c];
+        }
+
+        if (data.lods.empty()) {
+            header.lodCount = 1;
+            header.lods[0] = { 0, header.indexCount, 0.0f };
+        }
+        else {
+            header.lodCount = (uint32_t)std::min(data.lods.size(), (size_t)kMaxMeshLods);
+            for (uint32_t l = 0; l < header.lodCount; ++l) {
+                header.lods[l] = { data.lods[l].indexOffset, data.lods[l].indexCount, data.lods[l].error };
+            }
+        }
+
+        header.indexSize = buffers.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+        header.vertexBytes = buffers.vertices.size();
+        header.indexBytes = buffers.indices.size();
+        header.vertexOffset = alignUp(sizeof(MeshFileHeader), kMeshFileAlignment);
+        header.indexOffset = alignUp(header.vertexOffset + header.vertexBytes, kMeshFileAlignment);
+
+        static const char zeros[kMeshFileAlignment] = {};
+        return writeFileAtomic(path, {
+            { &header, sizeof(header) },
+            { zeros, (size_t)(header.vertexOffset - sizeof(header)) },
+            { buffers.vertices.data(), (size_t)header.vertexBytes },
+            { zeros, (size_t)(header.indexOffset - header.vertexOffset - header.vertexBytes) },
+            { buffers.indices.data(), (size_t)header.indexBytes } });
+    }
+
+} // namespace game
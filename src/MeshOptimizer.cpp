@@ -0,0 +1,288 @@
+#include "game/MeshOptimizer.h"
+#include "game/Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace game {
+
+    // ============================================================================
+    // Statistics
+    // ============================================================================
+
+    VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices,
+        size_t vertexCount, unsigned int cacheSize) {
+        VertexCacheStats stats;
+        // No whole triangle: zeros rather than a division by zero in the report
+        if (indices.size() < 3 || vertexCount == 0) return stats;
+
+        // FIFO simulation: a vertex is a hit while fewer than cacheSize misses happened since it was loaded
+        std::vector<unsigned int> loadedAt(vertexCount, 0);
+        unsigned int clock = cacheSize + 1;
+        size_t misses = 0;
+        for (unsigned int idx : indices) {
+            if (clock - loadedAt[idx] > cacheSize) {
+                loadedAt[idx] = clock++;
+                misses++;
+            }
+        }
+
+        stats.acmr = (float)misses / (float)(indices.size() / 3);
+        stats.atvr = (float)misses / (float)vertexCount;
+        return stats;
+    }
+
+    // ============================================================================
+    // Vertex welding
+    // ============================================================================
+
+    namespace {
+        struct WeldKey {
+            int64_t q[6];     // 64 bit, so large coordinates cannot wrap into another vertex's key
+            bool operator==(const WeldKey& o) const { return std::memcmp(q, o.q, sizeof(q)) == 0; }
+        };
+
+        struct WeldKeyHash {
+            size_t operator()(const WeldKey& k) const { return (size_t)hashBytes(k.q, sizeof(k.q)); }
+        };
+    }
+
+    void weldVertices(MeshData& data) {
+        const double posScale = 1.0 / 1e-5;   // positions within 0.01 mm
+        const double normalScale = 1.0 / 1e-3;
+
+        std::unordered_map<WeldKey, unsigned int, WeldKeyHash> unique;
+        unique.reserve(data.vertices.size());
+
+        std::vector<unsigned int> remap(data.vertices.size());
+        std::vector<MeshVertex> welded;
+        welded.reserve(data.vertices.size());
+
+        for (size_t i = 0; i < data.vertices.size(); ++i) {
+            const MeshVertex& v = data.vertices[i];
+            WeldKey key = { {
+                std::llround(v.x * posScale), std::llround(v.y * posScale), std::llround(v.z * posScale),
+                std::llround(v.nx * normalScale), std::llround(v.ny * normalScale), std::llround(v.nz * normalScale)
+            } };
+
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                unsigned int index = (unsigned int)welded.size();
+                unique.emplace(key, index);
+                welded.push_back(v);
+                remap[i] = index;
+            }
+            else {
+                remap[i] = it->second;
+            }
+        }
+
+        // Poles and seams collapse into degenerate triangles; drop them
+        std::vector<unsigned int> indices;
+        indices.reserve(data.indices.size());
+        for (size_t t = 0; t + 2 < data.indices.size(); t += 3) {
+            unsigned int a = remap[data.indices[t]];
+            unsigned int b = remap[data.indices[t + 1]];
+            unsigned int c = remap[data.indices[t + 2]];
+            if (a == b || b == c || a == c) continue;
+            indices.insert(indices.end(), { a, b, c });
+        }
+
+        data.vertices = std::move(welded);
+        data.indices = std::move(indices);
+    }
+
+    // ============================================================================
+    // Forsyth vertex cache optimization
+    // ============================================================================
+
+    namespace {
+        const int kForsythCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriScore = 0.75f;
+        const float kValenceBoostScale = 2.0f;
+        const float kValenceBoostPower = 0.5f;
+
+        float forsythVertexScore(int cachePosition, int remainingTriangles) {
+            if (remainingTriangles <= 0) return -1.0f;
+
+            float score = 0.0f;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // Vertices of the triangle just emitted get a fixed score so the
+                    // next triangle does not simply reuse the same edge
+                    score = kLastTriScore;
+                }
+                else {
+                    float scaler = 1.0f / (float)(kForsythCacheSize - 3);
+                    score = std::pow(1.0f - (float)(cachePosition - 3) * scaler, kCacheDecayPower);
+                }
+            }
+
+            // Favour vertices with few triangles left so they can leave the cache for good
+            score += kValenceBoostScale * std::pow((float)remainingTriangles, -kValenceBoostPower);
+            return score;
+        }
+    }
+
+    void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+        const size_t triCount = indices.size() / 3;
+        if (triCount == 0 || vertexCount == 0) return;
+
+        // Vertex -> triangle adjacency (compact, shrinks as triangles are emitted)
+        std::vector<int> remaining(vertexCount, 0);
+        for (unsigned int idx : indices) remaining[idx]++;
+
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + (unsigned int)remaining[v];
+
+        std::vector<unsigned int> adjacency(indices.size());
+        {
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triCount; ++t) {
+                for (int k = 0; k < 3; ++k) {
+                    adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+                }
+            }
+        }
+
+        std::vector<int> cachePos(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+
+        std::vector<float> triScore(triCount);
+        std::vector<char> emitted(triCount, 0);
+        long bestTri = -1;
+        float bestScore = -1.0f;
+        for (size_t t = 0; t < triCount; ++t) {
+            triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+            if (triScore[t] > bestScore) {
+                bestScore = triScore[t];
+                bestTri = (long)t;
+            }
+        }
+
+        std::vector<unsigned int> out;
+        out.reserve(indices.size());
+
+        unsigned int cache[kForsythCacheSize + 3];
+        int cacheCount = 0;
+        size_t scanCursor = 0;
+
+        for (size_t n = 0; n < triCount; ++n) {
+            if (bestTri < 0) {
+                // Nothing adjacent to the cache is left; restart from the next unused triangle
+                while (emitted[scanCursor]) scanCursor++;
+                bestTri = (long)scanCursor;
+            }
+
+            const unsigned int tri = (unsigned int)bestTri;
+            emitted[tri] = 1;
+
+            unsigned int newCache[kForsythCacheSize + 3];
+            int newCount = 0;
+
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = indices[tri * 3 + k];
+                out.push_back(v);
+                newCache[newCount++] = v;
+
+                // Remove the triangle from this vertex's adjacency list
+                unsigned int begin = offsets[v];
+                unsigned int end = begin + (unsigned int)remaining[v];
+                for (unsigned int a = begin; a < end; ++a) {
+                    if (adjacency[a] == tri) {
+                        adjacency[a] = adjacency[end - 1];
+                        break;
+                    }
+                }
+                remaining[v]--;
+            }
+
+            for (int i = 0; i < cacheCount; ++i) {
+                unsigned int v = cache[i];
+                if (v != newCache[0] && v != newCache[1] && v != newCache[2]) {
+                    newCache[newCount++] = v;
+                }
+            }
+
+            for (int i = 0; i < newCount; ++i) {
+                cachePos[newCache[i]] = i < kForsythCacheSize ? i : -1;
+            }
+
+            cacheCount = std::min(newCount, kForsythCacheSize);
+            for (int i = 0; i < cacheCount; ++i) cache[i] = newCache[i];
+
+            // Only vertices that moved in (or out of) the cache change score
+            bestTri = -1;
+            bestScore = -1.0f;
+            for (int i = 0; i < newCount; ++i) {
+                unsigned int v = newCache[i];
+                vertexScore[v] = forsythVertexScore(cachePos[v], remaining[v]);
+            }
+            for (int i = 0; i < newCount; ++i) {
+                unsigned int v = newCache[i];
+                unsigned int begin = offsets[v];
+                unsigned int end = begin + (unsigned int)remaining[v];
+                for (unsigned int a = begin; a < end; ++a) {
+                    unsigned int t = adjacency[a];
+                    float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                    triScore[t] = score;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTri = (long)t;
+                    }
+                }
+            }
+        }
+
+        indices.swap(out);
+    }
+
+    // ============================================================================
+    // Vertex fetch optimization
+    // ============================================================================
+
+    void optimizeVertexFetch(MeshData& data) {
+        const unsigned int kUnused = ~0u;
+        std::vector<unsigned int> remap(data.vertices.size(), kUnused);
+        std::vector<MeshVertex> ordered;
+        ordered.reserve(data.vertices.size());
+
+        for (unsigned int& idx : data.indices) {
+            if (remap[idx] == kUnused) {
+                remap[idx] = (unsigned int)ordered.size();
+                ordered.push_back(data.vertices[idx]);
+            }
+            idx = remap[idx];
+        }
+
+        data.vertices = std::move(ordered);
+    }
+
+    void optimizeMesh(MeshData& data, const char* name) {
+        if (data.indices.empty()) return;
+
+        size_t vertsBefore = data.vertices.size();
+        size_t trisBefore = data.indices.size() / 3;
+        VertexCacheStats before = analyzeVertexCache(data.indices, data.vertices.size());
+
+        weldVertices(data);
+        optimizeVertexCache(data.indices, data.vertices.size());
+        optimizeVertexFetch(data);
+
+        VertexCacheStats after = analyzeVertexCache(data.indices, data.vertices.size());
+
+        std::ostringstream line;
+        line.precision(2);
+        line << std::fixed << "    Optimized " << (name ? name : "mesh") << ": "
+            << vertsBefore << " -> " << data.vertices.size() << " verts, "
+            << trisBefore << " -> " << data.indices.size() / 3 << " tris, "
+            << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+        std::cout << line.str();
+    }
+
+} // namespace game
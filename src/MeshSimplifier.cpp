@@ -0,0 +1,295 @@
+#include "game/MeshSimplifier.h"
+#include "game/MeshOptimizer.h"
+#include "game/Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+namespace game {
+
+    namespace {
+        // Symmetric 4x4 error quadric, upper triangle only. w is the total plane weight,
+        // so eval() / w is a mean squared distance in model units.
+        struct Quadric {
+            double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+            double a11 = 0, a12 = 0, a13 = 0;
+            double a22 = 0, a23 = 0;
+            double a33 = 0;
+            double w = 0;
+
+            void addPlane(const glm::vec3& n, float d, float weight) {
+                a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z; a03 += weight * n.x * d;
+                a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a13 += weight * n.y * d;
+                a22 += weight * n.z * n.z; a23 += weight * n.z * d;
+                a33 += weight * d * d;
+                w += weight;
+            }
+
+            void add(const Quadric& q) {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+                a11 += q.a11; a12 += q.a12; a13 += q.a13;
+                a22 += q.a22; a23 += q.a23;
+                a33 += q.a33;
+                w += q.w;
+            }
+
+            // v^T Q v for v = (p, 1)
+            double eval(const glm::vec3& p) const {
+                double x = p.x, y = p.y, z = p.z;
+                return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+                    + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+                    + a22 * z * z + 2 * a23 * z
+                    + a33;
+            }
+        };
+
+        struct Collapse {
+            unsigned int from, to;
+            float cost;
+        };
+
+        struct PositionKey {
+            int32_t q[3];
+            bool operator==(const PositionKey& o) const { return std::memcmp(q, o.q, sizeof(q)) == 0; }
+        };
+
+        struct PositionKeyHash {
+            size_t operator()(const PositionKey& k) const { return (size_t)hashBytes(k.q, sizeof(k.q)); }
+        };
+
+        glm::vec3 vertexPosition(const MeshVertex& v) {
+            return glm::vec3(v.x, v.y, v.z);
+        }
+
+        // Maps every vertex to the first vertex sharing its position (welded meshes only split on normals)
+        std::vector<unsigned int> buildPositionRemap(const std::vector<MeshVertex>& vertices) {
+            const float scale = 1.0f / 1e-5f;
+            std::unordered_map<PositionKey, unsigned int, PositionKeyHash> unique;
+            unique.reserve(vertices.size());
+
+            std::vector<unsigned int> remap(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const MeshVertex& v = vertices[i];
+                PositionKey key = { { (int32_t)std::lround(v.x * scale), (int32_t)std::lround(v.y * scale),
+                    (int32_t)std::lround(v.z * scale) } };
+                remap[i] = unique.emplace(key, (unsigned int)i).first->second;
+            }
+            return remap;
+        }
+
+        // Seam vertices (several vertices at one position) and open-border vertices keep their place
+        std::vector<bool> findLockedVertices(const std::vector<unsigned int>& positionOf,
+            const std::vector<unsigned int>& indices) {
+            size_t vertexCount = positionOf.size();
+            std::vector<unsigned int> wedges(vertexCount, 0);
+            for (size_t i = 0; i < vertexCount; ++i) wedges[positionOf[i]]++;
+
+            std::unordered_map<uint64_t, int> edgeUses;
+            edgeUses.reserve(indices.size());
+            for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                for (int e = 0; e < 3; ++e) {
+                    uint64_t a = positionOf[indices[t + e]];
+                    uint64_t b = positionOf[indices[t + (e + 1) % 3]];
+                    edgeUses[a < b ? (a << 32 | b) : (b << 32 | a)]++;
+                }
+            }
+
+            std::vector<bool> lockedPosition(vertexCount, false);
+            for (const auto& e : edgeUses) {
+                if (e.second != 1) continue;
+                lockedPosition[(size_t)(e.first >> 32)] = true;
+                lockedPosition[(size_t)(e.first & 0xFFFFFFFFu)] = true;
+            }
+
+            std::vector<bool> locked(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                unsigned int p = positionOf[i];
+                locked[i] = wedges[p] > 1 || lockedPosition[p];
+            }
+            return locked;
+        }
+
+        // Rejects a collapse that would flip or squash any triangle around 'from'
+        bool collapseKeepsOrientation(const std::vector<MeshVertex>& vertices,
+            const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles,
+            unsigned int from, unsigned int to) {
+            glm::vec3 target = vertexPosition(vertices[to]);
+            for (unsigned int t : triangles) {
+                const unsigned int* tri = &indices[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) continue; // removed by the collapse
+
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = vertexPosition(vertices[tri[k]]);
+                    q[k] = tri[k] == from ? target : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                float lenBefore = glm::length(before), lenAfter = glm::length(after);
+                if (lenAfter <= 1e-12f) return false;
+                if (glm::dot(before, after) < 0.25f * lenBefore * lenAfter) return false;
+            }
+            return true;
+        }
+    }
+
+    std::vector<unsigned int> simplifyMesh(const std::vector<MeshVertex>& vertices,
+        const std::vector<unsigned int>& indices, size_t targetIndexCount,
+        float maxError, float* outError) {
+        std::vector<unsigned int> result = indices;
+        if (outError) *outError = 0.0f;
+        if (result.size() <= targetIndexCount || vertices.empty()) return result;
+
+        size_t vertexCount = vertices.size();
+        std::vector<unsigned int> positionOf = buildPositionRemap(vertices);
+        std::vector<bool> locked = findLockedVertices(positionOf, result);
+
+        // Area-weighted plane quadrics, accumulated per position so seam wedges share one
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t t = 0; t + 2 < result.size(); t += 3) {
+            glm::vec3 p0 = vertexPosition(vertices[result[t]]);
+            glm::vec3 p1 = vertexPosition(vertices[result[t + 1]]);
+            glm::vec3 p2 = vertexPosition(vertices[result[t + 2]]);
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(n);
+            if (area <= 0.0f) continue;
+            n /= area;
+            for (int k = 0; k < 3; ++k) {
+                quadrics[positionOf[result[t + k]]].addPlane(n, -glm::dot(n, p0), area * 0.5f);
+            }
+        }
+
+        const double maxCost = (double)maxError * (double)maxError;
+        double worstCost = 0.0;
+
+        std::vector<unsigned int> remap(vertexCount);
+        std::vector<bool> touched(vertexCount);
+        std::vector<unsigned int> triOffsets(vertexCount + 1);
+        std::vector<unsigned int> triList;
+        std::vector<Collapse> collapses;
+
+        // Each pass collapses a batch of cheap, non-overlapping edges, then compacts the index list
+        while (result.size() > targetIndexCount) {
+            size_t triCount = result.size() / 3;
+
+            std::fill(triOffsets.begin(), triOffsets.end(), 0);
+            for (unsigned int idx : result) triOffsets[idx + 1]++;
+            for (size_t v = 0; v < vertexCount; ++v) triOffsets[v + 1] += triOffsets[v];
+            triList.resize(result.size());
+            std::vector<unsigned int> fill(triOffsets.begin(), triOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) triList[fill[result[i]]++] = (unsigned int)(i / 3);
+
+            collapses.clear();
+            for (size_t t = 0; t < triCount; ++t) {
+                for (int e = 0; e < 3; ++e) {
+                    unsigned int a = result[t * 3 + e];
+                    unsigned int b = result[t * 3 + (e + 1) % 3];
+                    for (int dir = 0; dir < 2; ++dir) {
+                        unsigned int from = dir ? b : a, to = dir ? a : b;
+                        if (locked[from]) continue;
+                        Quadric q = quadrics[positionOf[from]];
+                        q.add(quadrics[positionOf[to]]);
+                        double cost = q.w > 0 ? std::max(0.0, q.eval(vertexPosition(vertices[to])) / q.w) : 0.0;
+                        if (cost > maxCost) continue;
+                        collapses.push_back({ from, to, (float)cost });
+                    }
+                }
+            }
+            if (collapses.empty()) break;
+
+            std::sort(collapses.begin(), collapses.end(),
+                [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            for (size_t v = 0; v < vertexCount; ++v) remap[v] = (unsigned int)v;
+            std::fill(touched.begin(), touched.end(), false);
+
+            size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+            size_t removed = 0;
+            for (const Collapse& c : collapses) {
+                if (removed >= trianglesToRemove) break;
+                if (touched[c.from] || touched[c.to]) continue;
+
+                std::vector<unsigned int> around(triList.begin() + triOffsets[c.from],
+                    triList.begin() + triOffsets[c.from + 1]);
+                if (!collapseKeepsOrientation(vertices, result, around, c.from, c.to)) continue;
+
+                // Freeze the whole one-ring so later collapses in this pass see unchanged triangles
+                for (unsigned int t : around) {
+                    const unsigned int* tri = &result[t * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+                    if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) removed++;
+                }
+                touched[c.to] = true;
+
+                remap[c.from] = c.to;
+                quadrics[positionOf[c.to]].add(quadrics[positionOf[c.from]]);
+                worstCost = std::max(worstCost, (double)c.cost);
+            }
+            if (removed == 0) break;
+
+            size_t write = 0;
+            for (size_t t = 0; t < triCount; ++t) {
+                unsigned int a = remap[result[t * 3]];
+                unsigned int b = remap[result[t * 3 + 1]];
+                unsigned int c = remap[result[t * 3 + 2]];
+                if (a == b || b == c || a == c) continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (outError) *outError = (float)std::sqrt(worstCost);
+        return result;
+    }
+
+    void buildMeshLods(MeshData& data, const char* name) {
+        data.lods.clear();
+        data.lods.push_back({ 0, (unsigned int)data.indices.size(), 0.0f });
+        if (data.indices.empty()) return;
+
+        glm::vec3 bmin, bmax;
+        computeBounds(data, bmin, bmax);
+        float extent = glm::length(bmax - bmin);
+
+        // Each level aims for half the triangles of the previous one; error is capped relative
+        // to the mesh size so coarse levels never degrade into something unrecognisable
+        const float kMaxRelativeError = 0.05f;
+        const float kMinReduction = 0.8f;
+
+        std::vector<unsigned int> base(data.indices.begin(), data.indices.end());
+        size_t previousCount = base.size();
+        float previousError = 0.0f;
+
+        for (int level = 1; level < kMaxMeshLods; ++level) {
+            size_t target = base.size() / ((size_t)3 << level) * 3;
+            float error = 0.0f;
+            std::vector<unsigned int> lod = simplifyMesh(data.vertices, base, target,
+                kMaxRelativeError * extent, &error);
+
+            // Not worth another draw range if it barely shrank
+            if ((float)lod.size() > (float)previousCount * kMinReduction) break;
+
+            optimizeVertexCache(lod, data.vertices.size());
+            error = std::max(error, previousError);
+            data.lods.push_back({ (unsigned int)data.indices.size(), (unsigned int)lod.size(), error });
+            data.indices.insert(data.indices.end(), lod.begin(), lod.end());
+            previousCount = lod.size();
+            previousError = error;
+        }
+
+        std::ostringstream line;
+        line << "    LODs " << (name ? name : "mesh") << ":";
+        for (const MeshLod& l : data.lods) {
+            line << " " << l.indexCount / 3;
+        }
+        line.precision(4);
+        line << std::fixed << " tris (rms error " << data.lods.back().error << ")\n";
+        std::cout << line.str();
+    }
+
+} // namespace game
@@ -1,4 +1,9 @@
 ﻿#include "game/MeshUtils.h"
+#include "game/MeshOptimizer.h"
+#include "game/MeshSimplifier.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <string>
@@ -15,35 +20,183 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-struct V { float x, y, z, nx, ny, nz; };
-
 namespace game {
 
-    static void setupAttribs() {
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)(3 * sizeof(float)));
+    typedef MeshVertex V;
+
+    VertexLayout meshVertexLayout() {
+        VertexLayout layout;
+        layout.stride = sizeof(V);
+        layout.attribCount = 2;
+        layout.attribs[0] = { 0, 3, GL_FLOAT, GL_FALSE, 0 };
+        layout.attribs[1] = { 1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float) };
+        return layout;
+    }
+
+    VertexLayout packedVertexLayout() {
+        VertexLayout layout;
+        layout.stride = sizeof(PackedVertex);
+        layout.attribCount = 2;
+        layout.attribs[0] = { 0, 3, GL_SHORT, GL_TRUE, 0 };
+        layout.attribs[1] = { 1, 2, GL_SHORT, GL_TRUE, 4 * sizeof(int16_t) };
+        return layout;
+    }
+
+    void setupVertexAttribs(const VertexLayout& layout) {
+        for (int a = 0; a < layout.attribCount; ++a) {
+            const VertexAttrib& attr = layout.attribs[a];
+            renderDevice().EnableVertexAttrib(attr.location);
+            renderDevice().VertexAttribPointer(attr.location, attr.components, attr.type, attr.normalized,
+                layout.stride, (void*)(size_t)attr.offset);
+        }
+    }
+
+    void computeBounds(const MeshData& data, glm::vec3& outMin, glm::vec3& outMax) {
+        if (data.vertices.empty()) {
+            outMin = outMax = glm::vec3(0.0f);
+            return;
+        }
+        outMin = outMax = glm::vec3(data.vertices[0].x, data.vertices[0].y, data.vertices[0].z);
+        for (const V& v : data.vertices) {
+            glm::vec3 p(v.x, v.y, v.z);
+            outMin = glm::min(outMin, p);
+            outMax = glm::max(outMax, p);
+        }
+    }
+
+    // Packed positions map the bounds onto [-1, 1]; flat axes keep a tiny extent
+    static glm::vec3 quantizationScale(const glm::vec3& bmin, const glm::vec3& bmax) {
+        return glm::max((bmax - bmin) * 0.5f, glm::vec3(1e-6f));
+    }
+
+    static int16_t toSnorm16(float v) {
+        v = std::max(-1.0f, std::min(1.0f, v));
+        return (int16_t)std::lround(v * 32767.0f);
+    }
+
+    // Octahedral mapping: project onto |x|+|y|+|z| = 1 and fold the lower hemisphere over
+    static glm::vec2 octEncode(glm::vec3 n) {
+        n /= std::max(std::abs(n.x) + std::abs(n.y) + std::abs(n.z), 1e-20f);
+        glm::vec2 e(n.x, n.y);
+        if (n.z < 0.0f) {
+            e.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            e.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return e;
+    }
+
+    MeshBuffers encodeMesh(const MeshData& data, VertexFormat format) {
+        MeshBuffers out;
+        out.indexCount = (GLsizei)data.indices.size();
+
+        if (format == VertexFormat::Float) {
+            out.layout = meshVertexLayout();
+            const unsigned char* v = reinterpret_cast<const unsigned char*>(data.vertices.data());
+            out.vertices.assign(v, v + data.vertices.size() * sizeof(V));
+            const unsigned char* i = reinterpret_cast<const unsigned char*>(data.indices.data());
+            out.indices.assign(i, i + data.indices.size() * sizeof(unsigned int));
+            out.indexType = GL_UNSIGNED_INT;
+            return out;
+        }
+
+        glm::vec3 bmin, bmax;
+        computeBounds(data, bmin, bmax);
+        glm::vec3 center = (bmin + bmax) * 0.5f;
+        glm::vec3 invScale = 1.0f / quantizationScale(bmin, bmax);
+
+        out.layout = packedVertexLayout();
+        out.vertices.resize(data.vertices.size() * sizeof(PackedVertex));
+        PackedVertex* packed = reinterpret_cast<PackedVertex*>(out.vertices.data());
+        for (size_t k = 0; k < data.vertices.size(); ++k) {
+            const V& v = data.vertices[k];
+            glm::vec3 q = (glm::vec3(v.x, v.y, v.z) - center) * invScale;
+            glm::vec2 e = octEncode(glm::vec3(v.nx, v.ny, v.nz));
+            packed[k] = { toSnorm16(q.x), toSnorm16(q.y), toSnorm16(q.z), 0, toSnorm16(e.x), toSnorm16(e.y) };
+        }
+
+        if (data.vertices.size() <= 0xFFFF) {
+            out.indexType = GL_UNSIGNED_SHORT;
+            out.indices.resize(data.indices.size() * sizeof(uint16_t));
+            uint16_t* dst = reinterpret_cast<uint16_t*>(out.indices.data());
+            for (size_t k = 0; k < data.indices.size(); ++k) dst[k] = (uint16_t)data.indices[k];
+        }
+        else {
+            out.indexType = GL_UNSIGNED_INT;
+            const unsigned char* i = reinterpret_cast<const unsigned char*>(data.indices.data());
+            out.indices.assign(i, i + data.indices.size() * sizeof(unsigned int));
+        }
+        return out;
+    }
+
+    size_t indexTypeSize(GLenum indexType) {
+        return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
     }
 
-    static Mesh createMeshFromData(const std::vector<V>& verts, const std::vector<unsigned int>& indices) {
+    Mesh describeMesh(const VertexLayout& layout, GLsizei indexCount, GLenum indexType,
+        const MeshLod* lods, int lodCount, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
         Mesh m;
-        glGenVertexArrays(1, &m.vao);
-        glGenBuffers(1, &m.vbo);
-        glGenBuffers(1, &m.ebo);
-
-        glBindVertexArray(m.vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(verts.size() * sizeof(V)), verts.data(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(unsigned int)), indices.data(), GL_STATIC_DRAW);
-        setupAttribs();
-        m.indexCount = (GLsizei)indices.size();
-        glBindVertexArray(0);
+        if (lodCount <= 0) {
+            m.lodCount = 1;
+            m.lods[0].indexCount = (unsigned int)indexCount;
+        }
+        else {
+            m.lodCount = lodCount < kMaxMeshLods ? lodCount : kMaxMeshLods;
+            for (int i = 0; i < m.lodCount; ++i) m.lods[i] = lods[i];
+        }
+        m.indexCount = (GLsizei)m.lods[0].indexCount;
+        m.indexType = indexType;
+        m.boundsMin = boundsMin;
+        m.boundsMax = boundsMax;
+        m.boundsCenter = (boundsMin + boundsMax) * 0.5f;
+        m.boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+        // Quantized layouts are recognised from the attribute types
+        if (layout.attribCount > 0 && layout.attribs[0].type == GL_SHORT) {
+            m.posScale = quantizationScale(boundsMin, boundsMax);
+            m.posOffset = (boundsMin + boundsMax) * 0.5f;
+        }
+        m.octNormals = layout.attribCount > 1 && layout.attribs[1].components == 2;
+        return m;
+    }
+
+    // Uploads vertex/index bytes as-is; the source may be a mapped cache file
+    Mesh createMeshFromMemory(const VertexLayout& layout,
+        const void* vertices, GLsizeiptr vertexBytes,
+        const void* indices, GLsizei indexCount, GLenum indexType,
+        const MeshLod* lods, int lodCount,
+        const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        Mesh m = describeMesh(layout, indexCount, indexType, lods, lodCount, boundsMin, boundsMax);
+        m.vao = renderDevice().GenVertexArray();
+        m.vbo = renderDevice().GenBuffer();
+        m.ebo = renderDevice().GenBuffer();
+
+        glState().BindVertexArray(m.vao);
+        glState().BindBuffer(GL_ARRAY_BUFFER, m.vbo);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+        glState().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
+        renderDevice().BufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexCount * indexTypeSize(indexType)), indices, GL_STATIC_DRAW);
+        setupVertexAttribs(layout);
+        glState().BindVertexArray(0);
 
         return m;
     }
 
+    Mesh uploadMesh(const MeshData& data, VertexFormat format) {
+        glm::vec3 bmin, bmax;
+        computeBounds(data, bmin, bmax);
+        MeshBuffers buffers = encodeMesh(data, format);
+        return createMeshFromMemory(buffers.layout,
+            buffers.vertices.data(), (GLsizeiptr)buffers.vertices.size(),
+            buffers.indices.data(), buffers.indexCount, buffers.indexType,
+            data.lods.data(), (int)data.lods.size(), bmin, bmax);
+    }
+
+    Mesh createMesh(MeshData data, const char* name, VertexFormat format) {
+        optimizeMesh(data, name);
+        buildMeshLods(data, name);
+        return uploadMesh(data, format);
+    }
+
     // Helper to add a solid box with proper normals
     static void addSolidBox(std::vector<V>& verts, std::vector<unsigned int>& indices,
         glm::vec3 center, glm::vec3 size) {
@@ -210,10 +363,11 @@ namespace game {
     }
 
     // DETAILED MOUSE MODEL
-    Mesh createDetailedMouse() {
+    MeshData buildDetailedMouse() {
         std::cout << "  Creating DETAILED procedural mouse...\n";
-        std::vector<V> verts;
-        std::vector<unsigned int> indices;
+        MeshData data;
+        std::vector<V>& verts = data.vertices;
+        std::vector<unsigned int>& indices = data.indices;
 
         // Body (main torso) - rounded ellipsoid
         addEllipsoid(verts, indices, { 0.0f, 0.0f, 0.0f }, { 0.35f, 0.4f, 0.5f }, 20, 16);
@@ -252,14 +406,19 @@ namespace game {
         std::cout << "    Detailed mouse: " << verts.size() << " vertices, "
             << indices.size() / 3 << " triangles\n";
 
-        return createMeshFromData(verts, indices);
+        return data;
+    }
+
+    Mesh createDetailedMouse() {
+        return createMesh(buildDetailedMouse());
     }
 
     // DETAILED CAT MODEL
-    Mesh createDetailedCat() {
+    MeshData buildDetailedCat() {
         std::cout << "  Creating DETAILED procedural cat...\n";
-        std::vector<V> verts;
-        std::vector<unsigned int> indices;
+        MeshData data;
+        std::vector<V>& verts = data.vertices;
+        std::vector<unsigned int>& indices = data.indices;
 
         // Body (larger, more elongated)
         addEllipsoid(verts, indices, { 0.0f, 0.0f, 0.0f }, { 0.45f, 0.5f, 0.65f }, 20, 16);
@@ -308,14 +467,19 @@ namespace game {
         std::cout << "    Detailed cat: " << verts.size() << " vertices, "
             << indices.size() / 3 << " triangles\n";
 
-        return createMeshFromData(verts, indices);
+        return data;
+    }
+
+    Mesh createDetailedCat() {
+        return createMesh(buildDetailedCat());
     }
 
     // DETAILED CHEESE MODEL
-    Mesh createDetailedCheese() {
+    MeshData buildDetailedCheese() {
         std::cout << "  Creating DETAILED procedural cheese...\n";
-        std::vector<V> verts;
-        std::vector<unsigned int> indices;
+        MeshData data;
+        std::vector<V>& verts = data.vertices;
+        std::vector<unsigned int>& indices = data.indices;
 
         // Main cheese wedge body
         glm::vec3 v0(-0.35f, 0, -0.25f);
@@ -377,7 +541,11 @@ namespace game {
         std::cout << "    Detailed cheese: " << verts.size() << " vertices, "
             << indices.size() / 3 << " triangles\n";
 
-        return createMeshFromData(verts, indices);
+        return data;
+    }
+
+    Mesh createDetailedCheese() {
+        return createMesh(buildDetailedCheese());
     }
 
     // Create realistic furniture models
@@ -394,7 +562,7 @@ namespace game {
         addSolidBox(verts, indices, { -0.9f, 0.4f,  0.5f }, { 0.12f, 0.9f, 0.12f });
         addSolidBox(verts, indices, { 0.9f, 0.4f,  0.5f }, { 0.12f, 0.9f, 0.12f });
 
-        return createMeshFromData(verts, indices);
+        return createMesh({ verts, indices, {} });
     }
 
     Mesh createChair() {
@@ -413,7 +581,7 @@ namespace game {
         addSolidBox(verts, indices, { -0.35f, 0.25f,  0.35f }, { 0.08f, 0.5f, 0.08f });
         addSolidBox(verts, indices, { 0.35f, 0.25f,  0.35f }, { 0.08f, 0.5f, 0.08f });
 
-        return createMeshFromData(verts, indices);
+        return createMesh({ verts, indices, {} });
     }
 
     Mesh createSofa() {
@@ -436,27 +604,33 @@ namespace game {
         addSphere(verts, indices, { -0.6f, 0.7f, 0 }, 0.15f, 12, 10);
         addSphere(verts, indices, { 0.6f, 0.7f, 0 }, 0.15f, 12, 10);
 
-        return createMeshFromData(verts, indices);
+        return createMesh({ verts, indices, {} });
     }
 
     // Create quad for UI
   // Create quad for UI
-    Mesh createQuad() {
-        std::vector<V> verts = {
+    MeshData buildQuad() {
+        MeshData data;
+        data.vertices = {
             { -0.5f, -0.5f, 0.0f,  0, 0, 1 },
             {  0.5f, -0.5f, 0.0f,  0, 0, 1 },
             {  0.5f,  0.5f, 0.0f,  0, 0, 1 },
             { -0.5f,  0.5f, 0.0f,  0, 0, 1 }
         };
 
-        std::vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+        data.indices = { 0, 1, 2, 0, 2, 3 };
+
+        return data;
+    }
 
-        return createMeshFromData(verts, indices);
+    Mesh createQuad() {
+        return createMesh(buildQuad());
     }
 // Basic primitives
-Mesh makeBox() {
-    std::vector<V> v;
-    std::vector<unsigned int> i;
+MeshData buildBox() {
+    MeshData data;
+    std::vector<V>& v = data.vertices;
+    std::vector<unsigned int>& i = data.indices;
 
     auto face = [&](float ax, float ay, float az, float bx, float by, float bz,
         float cx, float cy, float cz, float dx, float dy, float dz,
@@ -477,12 +651,13 @@ Mesh makeBox() {
     face(-s, -s, s, -s, s, s, s, s, s, s, -s, s, 0, 0, 1);
     face(s, -s, -s, s, s, -s, -s, s, -s, -s, -s, -s, 0, 0, -1);
 
-    return createMeshFromData(v, i);
+    return data;
 }
 
-Mesh makeSphere(int seg, int rings) {
-    std::vector<V> v;
-    std::vector<unsigned int> i;
+MeshData buildSphere(int seg, int rings) {
+    MeshData data;
+    std::vector<V>& v = data.vertices;
+    std::vector<unsigned int>& i = data.indices;
 
     for (int y = 0; y <= rings; ++y) {
         for (int x = 0; x <= seg; ++x) {
@@ -505,12 +680,13 @@ Mesh makeSphere(int seg, int rings) {
         }
     }
 
-    return createMeshFromData(v, i);
+    return data;
 }
 
-Mesh makeCylinder(int seg) {
-    std::vector<V> v;
-    std::vector<unsigned int> i;
+MeshData buildCylinder(int seg) {
+    MeshData data;
+    std::vector<V>& v = data.vertices;
+    std::vector<unsigned int>& i = data.indices;
 
     for (int k = 0; k <= 1; ++k) {
         float y = (float)k;
@@ -526,12 +702,13 @@ Mesh makeCylinder(int seg) {
         i.insert(i.end(), { a, b, c, c, b, d });
     }
 
-    return createMeshFromData(v, i);
+    return data;
 }
 
-Mesh makeCone(int seg) {
-    std::vector<V> v;
-    std::vector<unsigned int> i;
+MeshData buildCone(int seg) {
+    MeshData data;
+    std::vector<V>& v = data.vertices;
+    std::vector<unsigned int>& i = data.indices;
 
     v.push_back({ 0.f, 1.f, 0.f, 0.f, 1.f, 0.f });
 
@@ -547,33 +724,77 @@ Mesh makeCone(int seg) {
     for (int s = 1; s <= seg; ++s)
         i.insert(i.end(), { 0u, (unsigned int)s, (unsigned int)(s + 1) });
 
-    return createMeshFromData(v, i);
+    return data;
+}
+
+Mesh makeBox() {
+    return createMesh(buildBox());
+}
+
+Mesh makeSphere(int seg, int rings) {
+    return createMesh(buildSphere(seg, rings));
+}
+
+Mesh makeCylinder(int seg) {
+    return createMesh(buildCylinder(seg));
+}
+
+Mesh makeCone(int seg) {
+    return createMesh(buildCone(seg));
 }
 
 void drawMesh(const Mesh& m) {
-    glBindVertexArray(m.vao);
-    glDrawElements(GL_TRIANGLES, m.indexCount, GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);
+    drawMeshLod(m, 0);
+}
+
+void drawMeshLod(const Mesh& m, int lod) {
+    glState().BindVertexArray(m.vao);
+    drawMeshElements(m, lod);
+}
+
+void drawMeshElements(const Mesh& m, int lod) {
+    const MeshLod& l = m.lods[lod];
+    size_t first = (size_t)m.firstIndex + l.indexOffset;
+    renderDevice().DrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)l.indexCount, m.indexType,
+        (void*)(first * indexTypeSize(m.indexType)), m.baseVertex);
+}
+
+void drawMeshElementsInstanced(const Mesh& m, int lod, GLsizei instanceCount) {
+    const MeshLod& l = m.lods[lod];
+    size_t first = (size_t)m.firstIndex + l.indexOffset;
+    renderDevice().DrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)l.indexCount, m.indexType,
+        (void*)(first * indexTypeSize(m.indexType)), instanceCount, m.baseVertex);
+}
+
+int selectMeshLod(const Mesh& m, float worldScale, float distance,
+    float pixelsPerUnit, float maxPixelError) {
+    // Projected error shrinks with distance; walk down until a level is too coarse
+    float pixelsPerModelUnit = worldScale * pixelsPerUnit / std::max(distance, 0.01f);
+    int lod = 0;
+    while (lod + 1 < m.lodCount && m.lods[lod + 1].error * pixelsPerModelUnit <= maxPixelError) {
+        lod++;
+    }
+    return lod;
 }
 
 // OBJ loader with fallback
-Mesh loadOBJ(const std::string& path) {
+MeshData buildOBJ(const std::string& path) {
     std::ifstream file(path);
 
     if (!file) {
         std::cout << "  OBJ not found: " << path << "\n";
 
         if (path.find("mouse") != std::string::npos) {
-            return createDetailedMouse();
+            return buildDetailedMouse();
         }
         else if (path.find("cat") != std::string::npos) {
-            return createDetailedCat();
+            return buildDetailedCat();
         }
         else if (path.find("cheese") != std::string::npos) {
-            return createDetailedCheese();
+            return buildDetailedCheese();
         }
         else {
-            return makeSphere();
+            return buildSphere();
         }
     }
 
@@ -616,7 +837,7 @@ Mesh loadOBJ(const std::string& path) {
         }
     }
 
-    if (positions.empty()) return makeSphere();
+    if (positions.empty()) return buildSphere();
 
     std::vector<glm::vec3> normals(positions.size(), glm::vec3(0));
     for (size_t i = 0; i + 2 < indices.size(); i += 3) {
@@ -629,14 +850,20 @@ Mesh loadOBJ(const std::string& path) {
         normals[indices[i + 2]] += n;
     }
 
-    std::vector<V> verts;
+    MeshData data;
+    data.vertices.reserve(positions.size());
     for (size_t i = 0; i < positions.size(); ++i) {
         glm::vec3 n = glm::length(normals[i]) > 1e-6f ?
             glm::normalize(normals[i]) : glm::vec3(0, 1, 0);
-        verts.push_back({ positions[i].x, positions[i].y, positions[i].z, n.x, n.y, n.z });
+        data.vertices.push_back({ positions[i].x, positions[i].y, positions[i].z, n.x, n.y, n.z });
     }
+    data.indices = std::move(indices);
 
-    return createMeshFromData(verts, indices);
+    return data;
+}
+
+Mesh loadOBJ(const std::string& path) {
+    return createMesh(buildOBJ(path));
 }
 
 } // namespace game</parameter>
\ No newline at end of file
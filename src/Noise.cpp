@@ -0,0 +1,287 @@
+#include "game/Noise.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAME_NOISE_SSE2 1
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#define GAME_NOISE_SSE41 1
+#endif
+#endif
+
+namespace game {
+
+    static const uint32_t kSeedMul = 0x27D4EB2Du;
+    static const uint32_t kXMul = 0x9E3779B1u;
+    static const uint32_t kYMul = 0x85EBCA77u;
+    static const uint32_t kMix1 = 0x2C1B3C6Du;
+    static const uint32_t kMix2 = 0x297A2D39u;
+
+    // Feature point offsets come from 16 bits of the hash each
+    static const float kWorleyScale = 1.0f / 65536.0f;
+
+    uint32_t hashCell(uint32_t x, uint32_t y, uint32_t seed) {
+        uint32_t h = seed * kSeedMul + x * kXMul + y * kYMul;
+        h ^= h >> 15;
+        h *= kMix1;
+        h ^= h >> 12;
+        h *= kMix2;
+        h ^= h >> 15;
+        return h;
+    }
+
+    static inline float fade(float t) {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    // One of the four diagonal gradients, picked by the low two bits
+    static inline float grad(uint32_t h, float dx, float dy) {
+        return ((h & 1) ? -dx : dx) + ((h & 2) ? -dy : dy);
+    }
+
+    float gradientNoise(float x, float y, int cellsX, int cellsY, uint32_t seed) {
+        // Coordinates are never negative here, so truncation is floor
+        int ix = (int)x, iy = (int)y;
+        float fx = x - (float)ix, fy = y - (float)iy;
+        if (ix >= cellsX) ix -= cellsX;
+        if (iy >= cellsY) iy -= cellsY;
+        int ix1 = ix + 1 == cellsX ? 0 : ix + 1;
+        int iy1 = iy + 1 == cellsY ? 0 : iy + 1;
+
+        float g00 = grad(hashCell(ix, iy, seed), fx, fy);
+        float g10 = grad(hashCell(ix1, iy, seed), fx - 1.0f, fy);
+        float g01 = grad(hashCell(ix, iy1, seed), fx, fy - 1.0f);
+        float g11 = grad(hashCell(ix1, iy1, seed), fx - 1.0f, fy - 1.0f);
+        float sx = fade(fx), sy = fade(fy);
+        float a = g00 + (g10 - g00) * sx;
+        float b = g01 + (g11 - g01) * sx;
+        return a + (b - a) * sy;
+    }
+
+    float fbm(float u, float v, const FractalParams& params) {
+        float sum = 0.0f, amp = 1.0f, norm = 0.0f;
+        for (int o = 0; o < params.octaves; ++o) {
+            int cx = params.cellsX << o, cy = params.cellsY << o;
+            sum += amp * gradientNoise(u * (float)cx, v * (float)cy, cx, cy, params.seed + o);
+            norm += amp;
+            amp *= params.gain;
+        }
+        return norm > 0.0f ? sum / norm : 0.0f;
+    }
+
+    float ridged(float u, float v, const FractalParams& params) {
+        float sum = 0.0f, amp = 1.0f, norm = 0.0f, weight = 1.0f;
+        for (int o = 0; o < params.octaves; ++o) {
+            int cx = params.cellsX << o, cy = params.cellsY << o;
+            float n = 1.0f - std::fabs(gradientNoise(u * (float)cx, v * (float)cy, cx, cy, params.seed + o));
+            n *= n;
+            n *= weight;
+            weight = n;
+            sum += amp * n;
+            norm += amp;
+            amp *= params.gain;
+        }
+        return norm > 0.0f ? sum / norm : 0.0f;
+    }
+
+    void worley(float u, float v, int cells, uint32_t seed, float& f1, float& f2) {
+        float x = u * (float)cells, y = v * (float)cells;
+        int ix = (int)x, iy = (int)y;
+        float fx = x - (float)ix, fy = y - (float)iy;
+
+        float d1 = 8.0f, d2 = 8.0f;
+        for (int dy = -1; dy <= 1; ++dy) {
+            int cy = iy + dy + cells;
+            if (cy >= cells) cy -= cells;
+            if (cy >= cells) cy -= cells;
+            for (int dx = -1; dx <= 1; ++dx) {
+                int cx = ix + dx + cells;
+                if (cx >= cells) cx -= cells;
+                if (cx >= cells) cx -= cells;
+                uint32_t h = hashCell(cx, cy, seed);
+                float px = (float)dx + (float)(h & 0xFFFF) * kWorleyScale - fx;
+                float py = (float)dy + (float)(h >> 16) * kWorleyScale - fy;
+                float d = px * px + py * py;
+                d2 = std::min(d2, std::max(d1, d));
+                d1 = std::min(d1, d);
+            }
+        }
+        f1 = std::sqrt(d1);
+        f2 = std::sqrt(d2);
+    }
+
+#ifdef GAME_NOISE_SSE2
+    static inline __m128i mul32(__m128i a, __m128i b) {
+#ifdef GAME_NOISE_SSE41
+        return _mm_mullo_epi32(a, b);
+#else
+        // Low halves of the even and odd lane products, interleaved back
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    static inline __m128i hash4(__m128i x, __m128i y, uint32_t seed) {
+        __m128i h = _mm_set1_epi32((int)(seed * kSeedMul));
+        h = _mm_add_epi32(h, mul32(x, _mm_set1_epi32((int)kXMul)));
+        h = _mm_add_epi32(h, mul32(y, _mm_set1_epi32((int)kYMul)));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        h = mul32(h, _mm_set1_epi32((int)kMix1));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+        h = mul32(h, _mm_set1_epi32((int)kMix2));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+        return h;
+    }
+
+    static inline __m128 fade4(__m128 t) {
+        __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+        inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+    }
+
+    static inline __m128 grad4(__m128i h, __m128 dx, __m128 dy) {
+        // Bits 0 and 1 moved into the float sign bit flip dx and dy
+        __m128 sx = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+        __m128 sy = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+        return _mm_add_ps(_mm_xor_ps(dx, sx), _mm_xor_ps(dy, sy));
+    }
+
+    // ix in [0, 2 * cells) -> [0, cells)
+    static inline __m128i wrap4(__m128i ix, __m128i cells) {
+        __m128i over = _mm_cmpgt_epi32(ix, _mm_sub_epi32(cells, _mm_set1_epi32(1)));
+        return _mm_sub_epi32(ix, _mm_and_si128(over, cells));
+    }
+
+    // Same steps as gradientNoise(), for four x positions on one row
+    static inline __m128 gradientNoise4(__m128 x, float y, int cellsX, int cellsY, uint32_t seed) {
+        __m128i cx = _mm_set1_epi32(cellsX);
+        __m128i ix = _mm_cvttps_epi32(x);
+        __m128 fx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+        ix = wrap4(ix, cx);
+        __m128i ix1 = _mm_add_epi32(ix, _mm_set1_epi32(1));
+        ix1 = _mm_andnot_si128(_mm_cmpeq_epi32(ix1, cx), ix1);
+
+        int iy = (int)y;
+        float fyScalar = y - (float)iy;
+        if (iy >= cellsY) iy -= cellsY;
+        int iy1 = iy + 1 == cellsY ? 0 : iy + 1;
+        __m128i vy0 = _mm_set1_epi32(iy), vy1 = _mm_set1_epi32(iy1);
+        __m128 fy = _mm_set1_ps(fyScalar);
+
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 fx1 = _mm_sub_ps(fx, one), fy1 = _mm_sub_ps(fy, one);
+        __m128 g00 = grad4(hash4(ix, vy0, seed), fx, fy);
+        __m128 g10 = grad4(hash4(ix1, vy0, seed), fx1, fy);
+        __m128 g01 = grad4(hash4(ix, vy1, seed), fx, fy1);
+        __m128 g11 = grad4(hash4(ix1, vy1, seed), fx1, fy1);
+        __m128 sx = fade4(fx), sy = _mm_set1_ps(fade(fyScalar));
+        __m128 a = _mm_add_ps(g00, _mm_mul_ps(_mm_sub_ps(g10, g00), sx));
+        __m128 b = _mm_add_ps(g01, _mm_mul_ps(_mm_sub_ps(g11, g01), sx));
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), sy));
+    }
+
+    static inline __m128 rowU4(int x, float width) {
+        __m128 xs = _mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3));
+        return _mm_div_ps(xs, _mm_set1_ps(width));
+    }
+#endif
+
+    void fbmRow(float* out, int width, float v, const FractalParams& params) {
+        int x = 0;
+#ifdef GAME_NOISE_SSE2
+        float norm = 0.0f, amp = 1.0f;
+        for (int o = 0; o < params.octaves; ++o) {
+            norm += amp;
+            amp *= params.gain;
+        }
+        for (; x + 4 <= width; x += 4) {
+            __m128 u = rowU4(x, (float)width);
+            __m128 sum = _mm_setzero_ps();
+            amp = 1.0f;
+            for (int o = 0; o < params.octaves; ++o) {
+                int cx = params.cellsX << o, cy = params.cellsY << o;
+                __m128 n = gradientNoise4(_mm_mul_ps(u, _mm_set1_ps((float)cx)), v * (float)cy, cx, cy, params.seed + o);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(amp), n));
+                amp *= params.gain;
+            }
+            _mm_storeu_ps(out + x, norm > 0.0f ? _mm_div_ps(sum, _mm_set1_ps(norm)) : _mm_setzero_ps());
+        }
+#endif
+        for (; x < width; ++x) out[x] = fbm((float)x / (float)width, v, params);
+    }
+
+    void ridgedRow(float* out, int width, float v, const FractalParams& params) {
+        int x = 0;
+#ifdef GAME_NOISE_SSE2
+        float norm = 0.0f, amp = 1.0f;
+        for (int o = 0; o < params.octaves; ++o) {
+            norm += amp;
+            amp *= params.gain;
+        }
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (; x + 4 <= width; x += 4) {
+            __m128 u = rowU4(x, (float)width);
+            __m128 sum = _mm_setzero_ps(), weight = _mm_set1_ps(1.0f);
+            amp = 1.0f;
+            for (int o = 0; o < params.octaves; ++o) {
+                int cx = params.cellsX << o, cy = params.cellsY << o;
+                __m128 g = gradientNoise4(_mm_mul_ps(u, _mm_set1_ps((float)cx)), v * (float)cy, cx, cy, params.seed + o);
+                __m128 n = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_and_ps(g, absMask));
+                n = _mm_mul_ps(n, n);
+                n = _mm_mul_ps(n, weight);
+                weight = n;
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(amp), n));
+                amp *= params.gain;
+            }
+            _mm_storeu_ps(out + x, norm > 0.0f ? _mm_div_ps(sum, _mm_set1_ps(norm)) : _mm_setzero_ps());
+        }
+#endif
+        for (; x < width; ++x) out[x] = ridged((float)x / (float)width, v, params);
+    }
+
+    void worleyRow(float* f1, float* f2, int width, float v, int cells, uint32_t seed) {
+        int x = 0;
+#ifdef GAME_NOISE_SSE2
+        const __m128i vcells = _mm_set1_epi32(cells);
+        const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+        const __m128 scale = _mm_set1_ps(kWorleyScale);
+        float y = v * (float)cells;
+        int iy = (int)y;
+        __m128 fy = _mm_set1_ps(y - (float)iy);
+        for (; x + 4 <= width; x += 4) {
+            __m128 px0 = _mm_mul_ps(rowU4(x, (float)width), _mm_set1_ps((float)cells));
+            __m128i ix = _mm_cvttps_epi32(px0);
+            __m128 fx = _mm_sub_ps(px0, _mm_cvtepi32_ps(ix));
+
+            __m128 d1 = _mm_set1_ps(8.0f), d2 = _mm_set1_ps(8.0f);
+            for (int dy = -1; dy <= 1; ++dy) {
+                int cy = iy + dy + cells;
+                if (cy >= cells) cy -= cells;
+                if (cy >= cells) cy -= cells;
+                __m128i vy = _mm_set1_epi32(cy);
+                __m128 offY = _mm_set1_ps((float)dy);
+                for (int dx = -1; dx <= 1; ++dx) {
+                    __m128i cx = _mm_add_epi32(ix, _mm_set1_epi32(dx + cells));
+                    cx = wrap4(wrap4(cx, vcells), vcells);
+                    __m128i h = hash4(cx, vy, seed);
+                    __m128 jx = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(h, lowMask)), scale);
+                    __m128 jy = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(h, 16)), scale);
+                    __m128 ddx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)dx), jx), fx);
+                    __m128 ddy = _mm_sub_ps(_mm_add_ps(offY, jy), fy);
+                    __m128 d = _mm_add_ps(_mm_mul_ps(ddx, ddx), _mm_mul_ps(ddy, ddy));
+                    d2 = _mm_min_ps(d2, _mm_max_ps(d1, d));
+                    d1 = _mm_min_ps(d1, d);
+                }
+            }
+            _mm_storeu_ps(f1 + x, _mm_sqrt_ps(d1));
+            _mm_storeu_ps(f2 + x, _mm_sqrt_ps(d2));
+        }
+#endif
+        for (; x < width; ++x) worley((float)x / (float)width, v, cells, seed, f1[x], f2[x]);
+    }
+
+} // namespace game
@@ -0,0 +1,226 @@
+#include "game/OcclusionCuller.h"
+#include "game/JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define GAME_OCCLUSION_SSE 1
+#endif
+
+namespace game {
+
+    static const int kBandRows = OcclusionCuller::kHeight / OcclusionCuller::kBands;
+
+    OcclusionCuller::OcclusionCuller(JobSystem* jobs)
+        : jobs_(jobs) {
+        for (int l = 0; l < kLevels; ++l) {
+            levels_[l].assign((size_t)(kWidth >> l) * (size_t)(kHeight >> l), 1.0f);
+        }
+    }
+
+    void OcclusionCuller::Begin(const glm::mat4& view, const glm::mat4& proj) {
+        view_ = view;
+        viewProj_ = proj * view;
+        projX_ = proj[0][0];
+        projY_ = proj[1][1];
+        projZ_ = proj[2][2];
+        projW_ = proj[3][2];
+        zNear_ = proj[3][2] / (proj[2][2] - 1.0f);
+        triangles_.clear();
+    }
+
+    void OcclusionCuller::AddOccluderBox(const glm::vec3& min, const glm::vec3& max) {
+        // Corner i takes max on x for bit 0, y for bit 1, z for bit 2
+        glm::vec4 clip[8];
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+            clip[i] = viewProj_ * glm::vec4(p, 1.0f);
+        }
+
+        // Back faces are kept: a box is only 12 triangles and the front ones win the depth test
+        static const int faces[6][4] = {
+            { 0, 2, 6, 4 }, { 1, 3, 7, 5 },     // -x, +x
+            { 0, 1, 5, 4 }, { 2, 3, 7, 6 },     // -y, +y
+            { 0, 1, 3, 2 }, { 4, 5, 7, 6 }      // -z, +z
+        };
+        for (const auto& f : faces) {
+            AddClipTriangle(clip[f[0]], clip[f[1]], clip[f[2]]);
+            AddClipTriangle(clip[f[0]], clip[f[2]], clip[f[3]]);
+        }
+    }
+
+    // Clips against the near plane (z >= -w), which also keeps w positive for the divide; the
+    // other planes are left to the rasterizer's bounding box
+    void OcclusionCuller::AddClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+        const glm::vec4 in[3] = { a, b, c };
+        glm::vec4 poly[4];
+        int count = 0;
+        for (int i = 0; i < 3; ++i) {
+            const glm::vec4& p = in[i];
+            const glm::vec4& q = in[(i + 1) % 3];
+            float dp = p.z + p.w, dq = q.z + q.w;
+            if (dp >= 0.0f) poly[count++] = p;
+            if ((dp >= 0.0f) != (dq >= 0.0f)) poly[count++] = p + (q - p) * (dp / (dp - dq));
+        }
+        if (count < 3) return;
+
+        glm::vec3 screen[4];
+        for (int i = 0; i < count; ++i) {
+            float invW = 1.0f / std::max(poly[i].w, 1e-6f);
+            screen[i] = glm::vec3((poly[i].x * invW * 0.5f + 0.5f) * kWidth,
+                (poly[i].y * invW * 0.5f + 0.5f) * kHeight, poly[i].z * invW * 0.5f + 0.5f);
+        }
+
+        for (int i = 1; i + 1 < count; ++i) {
+            ScreenTriangle t = { { screen[0], screen[i], screen[i + 1] } };
+            float minX = std::min(t.v[0].x, std::min(t.v[1].x, t.v[2].x));
+            float maxX = std::max(t.v[0].x, std::max(t.v[1].x, t.v[2].x));
+            float minY = std::min(t.v[0].y, std::min(t.v[1].y, t.v[2].y));
+            float maxY = std::max(t.v[0].y, std::max(t.v[1].y, t.v[2].y));
+            if (maxX < 0.0f || minX > (float)kWidth || maxY < 0.0f || minY > (float)kHeight) continue;
+
+            // Counter-clockwise on screen, so inside is where all three edge functions are >= 0
+            float area = (t.v[1].x - t.v[0].x) * (t.v[2].y - t.v[0].y) - (t.v[1].y - t.v[0].y) * (t.v[2].x - t.v[0].x);
+            if (std::abs(area) < 1e-6f) continue;
+            if (area < 0.0f) std::swap(t.v[1], t.v[2]);
+            triangles_.push_back(t);
+        }
+    }
+
+    void OcclusionCuller::RasterizeBand(int band) {
+        const int rowBegin = band * kBandRows;
+        const int rowEnd = rowBegin + kBandRows;
+        float* depth = levels_[0].data();
+        std::fill(depth + (size_t)rowBegin * kWidth, depth + (size_t)rowEnd * kWidth, 1.0f);
+
+        for (const ScreenTriangle& t : triangles_) {
+            const glm::vec3& a = t.v[0];
+            const glm::vec3& b = t.v[1];
+            const glm::vec3& c = t.v[2];
+            int minY = std::max((int)std::floor(std::min(a.y, std::min(b.y, c.y))), rowBegin);
+            int maxY = std::min((int)std::ceil(std::max(a.y, std::max(b.y, c.y))), rowEnd);
+            int minX = std::max((int)std::floor(std::min(a.x, std::min(b.x, c.x))), 0);
+            int maxX = std::min((int)std::ceil(std::max(a.x, std::max(b.x, c.x))), kWidth);
+            if (minX >= maxX || minY >= maxY) continue;
+
+            // Edge p -> q: e(x, y) = A x + B y + C; depth is a plane in window space
+            const glm::vec3* v[3] = { &a, &b, &c };
+            float edgeA[3], edgeB[3], edgeC[3];
+            for (int e = 0; e < 3; ++e) {
+                const glm::vec3& p = *v[e];
+                const glm::vec3& q = *v[(e + 1) % 3];
+                edgeA[e] = p.y - q.y;
+                edgeB[e] = q.x - p.x;
+                edgeC[e] = p.x * q.y - p.y * q.x;
+            }
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            float zdx = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+            float zdy = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+            float z0 = a.z - zdx * a.x - zdy * a.y;
+
+            // Rows run in groups of four pixels from a 16-byte aligned column
+            const int firstX = minX & ~3;
+            for (int y = minY; y < maxY; ++y) {
+                float py = (float)y + 0.5f;
+                float* row = depth + (size_t)y * kWidth;
+#ifdef GAME_OCCLUSION_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+                const __m128 a0 = _mm_set1_ps(edgeA[0]), a1 = _mm_set1_ps(edgeA[1]), a2 = _mm_set1_ps(edgeA[2]);
+                const __m128 r0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+                const __m128 r1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+                const __m128 r2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+                const __m128 dz = _mm_set1_ps(zdx);
+                const __m128 rz = _mm_set1_ps(zdy * py + z0);
+                for (int x = firstX; x < maxX; x += 4) {
+                    __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                    __m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero),
+                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+                    if (!_mm_movemask_ps(inside)) continue;
+                    __m128 old = _mm_loadu_ps(row + x);
+                    __m128 nearer = _mm_min_ps(old, _mm_add_ps(_mm_mul_ps(dz, px), rz));
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+                }
+#else
+                for (int x = firstX; x < maxX; ++x) {
+                    float px = (float)x + 0.5f;
+                    if (edgeA[0] * px + edgeB[0] * py + edgeC[0] < 0.0f ||
+                        edgeA[1] * px + edgeB[1] * py + edgeC[1] < 0.0f ||
+                        edgeA[2] * px + edgeB[2] * py + edgeC[2] < 0.0f) continue;
+                    row[x] = std::min(row[x], zdx * px + zdy * py + z0);
+                }
+#endif
+            }
+        }
+    }
+
+    // Each texel keeps the farthest depth below it, so a sphere in front of a texel's value
+    // may be visible somewhere in its block and one behind it is hidden everywhere
+    void OcclusionCuller::BuildHierarchy() {
+        for (int l = 1; l < kLevels; ++l) {
+            const int w = kWidth >> l, h = kHeight >> l;
+            const int srcW = w * 2;
+            const float* src = levels_[l - 1].data();
+            float* dst = levels_[l].data();
+            for (int y = 0; y < h; ++y) {
+                const float* r0 = src + (size_t)(2 * y) * srcW;
+                const float* r1 = r0 + srcW;
+                for (int x = 0; x < w; ++x) {
+                    dst[(size_t)y * w + x] = std::max(std::max(r0[2 * x], r0[2 * x + 1]), std::max(r1[2 * x], r1[2 * x + 1]));
+                }
+            }
+        }
+    }
+
+    void OcclusionCuller::Rasterize(FrameStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        if (jobs_) {
+            jobs_->ParallelFor(kBands, 1, [this](size_t, size_t begin, size_t end) {
+                for (size_t b = begin; b < end; ++b) RasterizeBand((int)b);
+                });
+        }
+        else {
+            for (int b = 0; b < kBands; ++b) RasterizeBand(b);
+        }
+        BuildHierarchy();
+        stats.occlusionMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool OcclusionCuller::IsVisible(const glm::vec3& center, float radius) const {
+        // The sphere's view-space box projects to the hull of its corners (see
+        // LightClusters::Build); its front face holds the nearest depth
+        glm::vec3 c = glm::vec3(view_ * glm::vec4(center, 1.0f));
+        float dNear = -c.z - radius, dFar = -c.z + radius;
+        if (dNear <= zNear_) return true;
+        float ndcMinX = std::min((c.x - radius) / dNear, (c.x - radius) / dFar) * projX_;
+        float ndcMaxX = std::max((c.x + radius) / dNear, (c.x + radius) / dFar) * projX_;
+        float ndcMinY = std::min((c.y - radius) / dNear, (c.y - radius) / dFar) * projY_;
+        float ndcMaxY = std::max((c.y + radius) / dNear, (c.y + radius) / dFar) * projY_;
+        float minX = (ndcMinX * 0.5f + 0.5f) * kWidth, maxX = (ndcMaxX * 0.5f + 0.5f) * kWidth;
+        float minY = (ndcMinY * 0.5f + 0.5f) * kHeight, maxY = (ndcMaxY * 0.5f + 0.5f) * kHeight;
+        float nearest = (projW_ / dNear - projZ_) * 0.5f + 0.5f;
+
+        // One texel of margin for occluder edges that cover a pixel center but not the whole pixel
+        int x0 = std::max((int)std::floor(minX) - 1, 0);
+        int x1 = std::min((int)std::floor(maxX) + 1, kWidth - 1);
+        int y0 = std::max((int)std::floor(minY) - 1, 0);
+        int y1 = std::min((int)std::floor(maxY) + 1, kHeight - 1);
+        if (x0 > x1 || y0 > y1) return true;
+
+        // Coarsest useful level: the rectangle spans at most 4-5 texels each way
+        int level = 0;
+        while (level < kLevels - 1 && (std::max(x1 - x0, y1 - y0) >> level) > 3) level++;
+        const int w = kWidth >> level;
+        const float* depth = levels_[level].data();
+        for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+            for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+                if (depth[(size_t)y * w + x] >= nearest) return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace game
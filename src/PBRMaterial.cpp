@@ -1,5 +1,8 @@
 // PBRMaterial.cpp - Complete PBR Material System
 #include "game/PBRMaterial.h"
+#include "game/Shader.h"
+#include "game/GLState.h"
+#include "game/UniformBlocks.h"
 #include <iostream>
 
 // Use stb_image for texture loading
@@ -13,7 +16,7 @@ namespace game {
     // ============================================================================
 
     PBRTexture::~PBRTexture() {
-        if (id) glDeleteTextures(1, &id);
+        glState().DeleteTexture(id);
     }
 
     bool PBRTexture::LoadFromFile(const std::string& path) {
@@ -26,7 +29,7 @@ namespace game {
         }
 
         glGenTextures(1, &id);
-        glBindTexture(GL_TEXTURE_2D, id);
+        glState().BindTexture(0, GL_TEXTURE_2D, id);
 
         GLenum format = GL_RGB;
         if (nrChannels == 1) format = GL_RED;
@@ -57,7 +60,6 @@ namespace game {
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAnisotropy);
 
         stbi_image_free(data);
-        glBindTexture(GL_TEXTURE_2D, 0);
 
         std::cout << "  Loaded PBR texture: " << path << " (" << width << "x" << height
             << ", " << nrChannels << " channels)\n";
@@ -65,8 +67,7 @@ namespace game {
     }
 
     void PBRTexture::Bind(int unit) const {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, id);
+        glState().BindTexture((GLuint)unit, GL_TEXTURE_2D, id);
     }
 
     // ============================================================================
@@ -231,6 +232,22 @@ namespace game {
     // PBRRenderer - Renders objects with PBR materials
     // ============================================================================
 
+    // Uniform names hashed at compile time; Shader finds each with a single table probe
+    static constexpr UniformName kModelUniform("uModel");
+    static constexpr UniformName kAlbedoUniform("uAlbedo");
+    static constexpr UniformName kMetallicUniform("uMetallic");
+    static constexpr UniformName kRoughnessUniform("uRoughness");
+    static constexpr UniformName kAlbedoMapUniform("uAlbedoMap");
+    static constexpr UniformName kUseAlbedoMapUniform("uUseAlbedoMap");
+    static constexpr UniformName kNormalMapUniform("uNormalMap");
+    static constexpr UniformName kUseNormalMapUniform("uUseNormalMap");
+    static constexpr UniformName kMetallicMapUniform("uMetallicMap");
+    static constexpr UniformName kUseMetallicMapUniform("uUseMetallicMap");
+    static constexpr UniformName kRoughnessMapUniform("uRoughnessMap");
+    static constexpr UniformName kUseRoughnessMapUniform("uUseRoughnessMap");
+    static constexpr UniformName kAOMapUniform("uAOMap");
+    static constexpr UniformName kUseAOMapUniform("uUseAOMap");
+
     void PBRRenderer::Init() {
         // Load PBR shader
         pbrShader_ = std::make_unique<Shader>();
@@ -246,94 +263,77 @@ namespace game {
                 GetEmbeddedPBRFragmentShader().c_str());
         }
 
+        bindUniformBlocks(pbrShader_->ID);
         std::cout << "PBR Renderer initialized\n";
     }
 
-    void PBRRenderer::SetLights(const std::vector<Light>& lights) {
-        lights_ = lights;
-    }
-
+    // View, projection, camera position and lights are not parameters: they come from the
+    // FrameData block (UniformBlocks.h), which the frame's owner uploads once per frame
     void PBRRenderer::RenderMesh(const Mesh& mesh,
         const PBRMaterial& material,
-        const glm::mat4& modelMatrix,
-        const glm::mat4& viewMatrix,
-        const glm::mat4& projMatrix,
-        const glm::vec3& camPos) {
+        const glm::mat4& modelMatrix) {
 
         pbrShader_->Use();
 
-        // Set matrices
-        pbrShader_->SetMat4("uModel", modelMatrix);
-        pbrShader_->SetMat4("uView", viewMatrix);
-        pbrShader_->SetMat4("uProj", projMatrix);
-        pbrShader_->SetVec3("uCamPos", camPos);
+        // Only per-draw state is set here
+        pbrShader_->SetMat4(kModelUniform, modelMatrix);
 
         // Set material properties
-        pbrShader_->SetVec3("uAlbedo", material.albedoColor);
-        pbrShader_->SetFloat("uMetallic", material.metallicValue);
-        pbrShader_->SetFloat("uRoughness", material.roughnessValue);
+        pbrShader_->SetVec3(kAlbedoUniform, material.albedoColor);
+        pbrShader_->SetFloat(kMetallicUniform, material.metallicValue);
+        pbrShader_->SetFloat(kRoughnessUniform, material.roughnessValue);
 
         // Bind textures
         int texUnit = 0;
 
         if (material.albedoMap && material.albedoMap->id) {
             material.albedoMap->Bind(texUnit);
-            pbrShader_->SetInt("uAlbedoMap", texUnit);
-            pbrShader_->SetBool("uUseAlbedoMap", true);
+            pbrShader_->SetInt(kAlbedoMapUniform, texUnit);
+            pbrShader_->SetBool(kUseAlbedoMapUniform, true);
             texUnit++;
         }
         else {
-            pbrShader_->SetBool("uUseAlbedoMap", false);
+            pbrShader_->SetBool(kUseAlbedoMapUniform, false);
         }
 
         if (material.normalMap && material.normalMap->id) {
             material.normalMap->Bind(texUnit);
-            pbrShader_->SetInt("uNormalMap", texUnit);
-            pbrShader_->SetBool("uUseNormalMap", true);
+            pbrShader_->SetInt(kNormalMapUniform, texUnit);
+            pbrShader_->SetBool(kUseNormalMapUniform, true);
             texUnit++;
         }
         else {
-            pbrShader_->SetBool("uUseNormalMap", false);
+            pbrShader_->SetBool(kUseNormalMapUniform, false);
         }
 
         if (material.metallicMap && material.metallicMap->id) {
             material.metallicMap->Bind(texUnit);
-            pbrShader_->SetInt("uMetallicMap", texUnit);
-            pbrShader_->SetBool("uUseMetallicMap", true);
+            pbrShader_->SetInt(kMetallicMapUniform, texUnit);
+            pbrShader_->SetBool(kUseMetallicMapUniform, true);
             texUnit++;
         }
         else {
-            pbrShader_->SetBool("uUseMetallicMap", false);
+            pbrShader_->SetBool(kUseMetallicMapUniform, false);
         }
 
         if (material.roughnessMap && material.roughnessMap->id) {
             material.roughnessMap->Bind(texUnit);
-            pbrShader_->SetInt("uRoughnessMap", texUnit);
-            pbrShader_->SetBool("uUseRoughnessMap", true);
+            pbrShader_->SetInt(kRoughnessMapUniform, texUnit);
+            pbrShader_->SetBool(kUseRoughnessMapUniform, true);
             texUnit++;
         }
         else {
-            pbrShader_->SetBool("uUseRoughnessMap", false);
+            pbrShader_->SetBool(kUseRoughnessMapUniform, false);
         }
 
         if (material.aoMap && material.aoMap->id) {
             material.aoMap->Bind(texUnit);
-            pbrShader_->SetInt("uAOMap", texUnit);
-            pbrShader_->SetBool("uUseAOMap", true);
+            pbrShader_->SetInt(kAOMapUniform, texUnit);
+            pbrShader_->SetBool(kUseAOMapUniform, true);
             texUnit++;
         }
         else {
-            pbrShader_->SetBool("uUseAOMap", false);
-        }
-
-        // Set lights
-        pbrShader_->SetInt("uNumLights", std::min((int)lights_.size(), 4));
-        for (size_t i = 0; i < std::min(lights_.size(), size_t(4)); ++i) {
-            std::string base = "uLightPositions[" + std::to_string(i) + "]";
-            pbrShader_->SetVec3(base, lights_[i].position);
-
-            base = "uLightColors[" + std::to_string(i) + "]";
-            pbrShader_->SetVec3(base, lights_[i].color);
+            pbrShader_->SetBool(kUseAOMapUniform, false);
         }
 
         // Render mesh
@@ -355,8 +355,17 @@ out VS_OUT {
 } vs_out;
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
 
 void main() {
     vec4 worldPos = uModel * vec4(aPos, 1.0);
@@ -399,10 +408,16 @@ uniform bool uUseMetallicMap;
 uniform bool uUseRoughnessMap;
 uniform bool uUseAOMap;
 
-uniform vec3 uCamPos;
-uniform vec3 uLightPositions[4];
-uniform vec3 uLightColors[4];
-uniform int uNumLights;
+// Per-frame camera and lights (FrameBlock in UniformBlocks.h, binding 0)
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    vec4 uViewPos;
+    vec4 uLightPosition[4];
+    vec4 uLightColor[4];
+    ivec4 uLightCount;
+    mat4 uLightSpace;
+};
 
 float DistributionGGX(vec3 N, vec3 H, float roughness) {
     float a = roughness * roughness;
@@ -454,18 +469,18 @@ void main() {
         texture(uAOMap, fs_in.TexCoord).r : 1.0;
     
     vec3 N = normalize(fs_in.Normal);
-    vec3 V = normalize(uCamPos - fs_in.FragPos);
+    vec3 V = normalize(uViewPos.xyz - fs_in.FragPos);
     
     vec3 F0 = vec3(0.04);
     F0 = mix(F0, albedo, metallic);
     
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < uNumLights; ++i) {
-        vec3 L = normalize(uLightPositions[i] - fs_in.FragPos);
+    for(int i = 0; i < uLightCount.x; ++i) {
+        vec3 L = normalize(uLightPosition[i].xyz - fs_in.FragPos);
         vec3 H = normalize(V + L);
-        float distance = length(uLightPositions[i] - fs_in.FragPos);
+        float distance = length(uLightPosition[i].xyz - fs_in.FragPos);
         float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = uLightColors[i] * attenuation;
+        vec3 radiance = uLightColor[i].rgb * attenuation;
         
         float NDF = DistributionGGX(N, H, roughness);
         float G = GeometrySmith(N, V, L, roughness);
@@ -1,4 +1,7 @@
 #include "game/ParticleSystem.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include "game/ShaderManager.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cstdlib>
@@ -13,16 +16,21 @@ ParticleSystem::ParticleSystem(int maxParticles)
 }
 
 ParticleSystem::~ParticleSystem() {
-    if (vao_) glDeleteVertexArrays(1, &vao_);
-    if (vbo_) glDeleteBuffers(1, &vbo_);
-    if (shader_) glDeleteProgram(shader_);
+    game::glState().DeleteVertexArray(vao_);
+    game::glState().DeleteBuffer(vbo_);
+    game::glState().DeleteProgram(shader_);
 }
 
 void ParticleSystem::Init() {
-    InitGL();
+    InitShaders();
+    InitBuffers();
 }
 
-void ParticleSystem::InitGL() {
+void ParticleSystem::InitHeadless() {
+    InitBuffers();
+}
+
+void ParticleSystem::InitShaders() {
     // Simple particle shader
     const char* vertSrc = R"(
         #version 330 core
@@ -64,70 +72,35 @@ void ParticleSystem::InitGL() {
         }
     )";
 
-    // Compile shaders
-    GLuint vert = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert, 1, &vertSrc, nullptr);
-    glCompileShader(vert);
-
-    GLint success;
-    glGetShaderiv(vert, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(vert, 512, nullptr, log);
-        std::cerr << "Particle vertex shader error: " << log << std::endl;
-    }
-
-    GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag, 1, &fragSrc, nullptr);
-    glCompileShader(frag);
-
-    glGetShaderiv(frag, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetShaderInfoLog(frag, 512, nullptr, log);
-        std::cerr << "Particle fragment shader error: " << log << std::endl;
-    }
-
-    shader_ = glCreateProgram();
-    glAttachShader(shader_, vert);
-    glAttachShader(shader_, frag);
-    glLinkProgram(shader_);
-
-    glGetProgramiv(shader_, GL_LINK_STATUS, &success);
-    if (!success) {
-        char log[512];
-        glGetProgramInfoLog(shader_, 512, nullptr, log);
-        std::cerr << "Particle shader link error: " << log << std::endl;
-    }
-
-    glDeleteShader(vert);
-    glDeleteShader(frag);
+    // Compiled (or loaded from the program cache); throws when the shaders do not build
+    shader_ = game::shaderManager().Build("particles", vertSrc, fragSrc);
 
     // Get uniform locations
     uView_ = glGetUniformLocation(shader_, "uView");
     uProj_ = glGetUniformLocation(shader_, "uProj");
     uCamPos_ = glGetUniformLocation(shader_, "uCamPos");
+}
 
-    // Create VAO/VBO
-    glGenVertexArrays(1, &vao_);
-    glGenBuffers(1, &vbo_);
+void ParticleSystem::InitBuffers() {
+    vao_ = game::renderDevice().GenVertexArray();
+    vbo_ = game::renderDevice().GenBuffer();
 
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    game::glState().BindVertexArray(vao_);
+    game::glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
 
     // Position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)0);
+    game::renderDevice().EnableVertexAttrib(0);
+    game::renderDevice().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)0);
 
     // Color
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(3 * sizeof(float)));
+    game::renderDevice().EnableVertexAttrib(1);
+    game::renderDevice().VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(3 * sizeof(float)));
 
     // Size
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(7 * sizeof(float)));
+    game::renderDevice().EnableVertexAttrib(2);
+    game::renderDevice().VertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(7 * sizeof(float)));
 
-    glBindVertexArray(0);
+    game::glState().BindVertexArray(0);
 }
 
 int ParticleSystem::FindUnusedParticle() {
@@ -185,6 +158,14 @@ void ParticleSystem::CreateTrail(const glm::vec3& position, const glm::vec4& col
     particles_[idx].size = 0.1f;
 }
 
+int ParticleSystem::AliveCount() const {
+    int alive = 0;
+    for (const auto& p : particles_) {
+        if (p.life > 0.0f) alive++;
+    }
+    return alive;
+}
+
 void ParticleSystem::Update(float dt) {
     for (auto& p : particles_) {
         if (p.life > 0.0f) {
@@ -199,10 +180,11 @@ void ParticleSystem::Update(float dt) {
 }
 
 void ParticleSystem::Render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& camPos) {
-    glUseProgram(shader_);
-    glUniformMatrix4fv(uView_, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(uProj_, 1, GL_FALSE, glm::value_ptr(proj));
-    glUniform3fv(uCamPos_, 1, glm::value_ptr(camPos));
+    game::GLStateCache& gl = game::glState();
+    gl.UseProgram(shader_);
+    game::renderDevice().UniformMatrix4fv(uView_, 1, GL_FALSE, glm::value_ptr(view));
+    game::renderDevice().UniformMatrix4fv(uProj_, 1, GL_FALSE, glm::value_ptr(proj));
+    game::renderDevice().Uniform3fv(uCamPos_, 1, glm::value_ptr(camPos));
 
     // Prepare particle data
     std::vector<float> data;
@@ -224,21 +206,18 @@ void ParticleSystem::Render(const glm::mat4& view, const glm::mat4& proj, const
     }
 
     if (count > 0) {
-        glEnable(GL_PROGRAM_POINT_SIZE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
-        glDepthMask(GL_FALSE);
+        gl.Enable(GL_PROGRAM_POINT_SIZE);
+        gl.Enable(GL_BLEND);
+        gl.BlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+        gl.DepthMask(false);
 
-        glBindVertexArray(vao_);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STREAM_DRAW);
+        gl.BindVertexArray(vao_);
+        gl.BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        game::renderDevice().BufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STREAM_DRAW);
 
-        glDrawArrays(GL_POINTS, 0, count);
+        game::renderDevice().DrawArrays(GL_POINTS, 0, count);
 
-        glDepthMask(GL_TRUE);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBindVertexArray(0);
+        gl.DepthMask(true);
+        gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
-
-    glUseProgram(0);
 }
\ No newline at end of file
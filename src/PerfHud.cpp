@@ -0,0 +1,134 @@
+#include "game/PerfHud.h"
+#include "game/UIRenderer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Global allocation hooks for the HUD's allocations-per-frame counter. Relaxed increments
+// only; the pairing with free() matches the default operator new.
+static std::atomic<size_t> allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace game {
+
+    size_t heapAllocationCount() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    static const char* const kPhaseNames[(int)PerfPhase::Count] = {
+        "UPDATE", "  AI", "  PHYSICS", "  PARTICLES", "SCENE", "UI"
+    };
+
+    void PerfHud::BeginFrame() {
+        for (double& ms : phaseMs_) ms = 0.0;
+        allocationsAtBegin_ = heapAllocationCount();
+    }
+
+    void PerfHud::EndFrame(double frameMs, const FrameStats& stats, int particlesAlive, int boltsAlive) {
+        for (int p = 0; p < (int)PerfPhase::Count; ++p) shownPhaseMs_[p] = phaseMs_[p];
+        stats_ = stats;
+        particles_ = particlesAlive;
+        bolts_ = boltsAlive;
+        allocations_ = heapAllocationCount() - allocationsAtBegin_;
+
+        frameMs_[historyHead_] = frameMs;
+        historyHead_ = (historyHead_ + 1) % kHistory;
+    }
+
+    void PerfHud::Render(UIRenderer& ui, float x, float y) {
+        if (!visible_) return;
+        auto start = std::chrono::steady_clock::now();
+
+        const float scale = 2.0f;
+        const float lineHeight = 18.0f;
+        const float graphHeight = 50.0f;
+        const float graphMaxMs = 33.3f;
+        const float barWidth = 2.0f;
+        const float width = kHistory * barWidth + 100.0f;
+        const int lines = 18;
+        const glm::vec4 text(0.9f, 0.95f, 1.0f, 1.0f);
+        const glm::vec4 dim(0.6f, 0.7f, 0.8f, 1.0f);
+        char buf[64];
+
+        ui.BeginUI();
+        ui.RenderRect(x, y, width, 20.0f + graphHeight + lines * lineHeight, { 0.0f, 0.0f, 0.0f, 0.65f });
+        float cy = y + 8.0f;
+
+        double lastMs = frameMs_[(historyHead_ + kHistory - 1) % kHistory];
+        std::snprintf(buf, sizeof(buf), "FRAME %.2f MS  %d FPS", lastMs, lastMs > 0.0 ? (int)(1000.0 / lastMs + 0.5) : 0);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+
+        // Oldest bar on the left; the line marks the 60 Hz budget
+        float graphY = cy + graphHeight;
+        for (int i = 0; i < kHistory; ++i) {
+            double ms = frameMs_[(historyHead_ + i) % kHistory];
+            float h = std::min((float)ms / graphMaxMs, 1.0f) * graphHeight;
+            glm::vec4 color = ms <= 16.7 ? glm::vec4(0.2f, 0.9f, 0.3f, 0.9f) :
+                ms <= 33.3 ? glm::vec4(1.0f, 0.85f, 0.2f, 0.9f) : glm::vec4(1.0f, 0.25f, 0.2f, 0.9f);
+            ui.RenderRect(x + 8.0f + i * barWidth, graphY - h, barWidth, h, color);
+        }
+        ui.RenderRect(x + 8.0f, graphY - graphHeight * 16.7f / graphMaxMs, kHistory * barWidth, 1.0f, dim);
+        cy += graphHeight + 8.0f;
+
+        for (int p = 0; p < (int)PerfPhase::Count; ++p) {
+            std::snprintf(buf, sizeof(buf), "%-11s%6.2f MS", kPhaseNames[p], shownPhaseMs_[p]);
+            ui.RenderText(buf, x + 8.0f, cy, scale, p == (int)PerfPhase::AI || p == (int)PerfPhase::Physics ||
+                p == (int)PerfPhase::Particles ? dim : text);
+            cy += lineHeight;
+        }
+
+        std::snprintf(buf, sizeof(buf), "DRAWS %d  TRIS %zu", stats_.drawCalls, stats_.trianglesSubmitted);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "OCCLUDED %d  %.3f MS", stats_.objectsOccluded, stats_.occlusionMs);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "STATE %d  ELIDED %d", stats_.stateCallsIssued, stats_.stateCallsElided);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "LIGHTS %d  CULLED %d", stats_.lightsVisible, stats_.lightsCulled);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "CLUSTERS %.3f MS", stats_.clusterMs);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "POST GPU %.2f/%.2f/%.2f/%.2f MS", stats_.bloomDownGpuMs,
+            stats_.bloomUpGpuMs, stats_.volumetricGpuMs, stats_.tonemapGpuMs);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "RES SCALE %d%%  GPU %.2f MS", (int)(stats_.renderScale * 100.0 + 0.5),
+            stats_.frameGpuMs);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "PARTICLES %d  BOLTS %d", particles_, bolts_);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "ALLOCS %zu/FRAME", allocations_);
+        ui.RenderText(buf, x + 8.0f, cy, scale, text);
+        cy += lineHeight;
+        std::snprintf(buf, sizeof(buf), "HUD %.3f MS", hudMs_);
+        ui.RenderText(buf, x + 8.0f, cy, scale, dim);
+
+        ui.EndUI();
+        hudMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace game
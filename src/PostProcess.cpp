@@ -0,0 +1,435 @@
+#include "game/PostProcess.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace game {
+
+    // Post passes read from the G-buffer units, which every lighting pass rebinds anyway
+    static const GLuint kSourceUnit = GBuffer::kAlbedoUnit;
+    static const GLuint kBloomUnit = GBuffer::kNormalUnit;
+    static const GLuint kDepthUnit = GBuffer::kDepthUnit;
+    // Shafts go on a cluster unit; those hold buffer textures, so the 2D binding is separate
+    static const GLuint kShaftUnit = 5;
+
+    // Light shaft tuning (see VolumetricLight.frag)
+    static const float kShaftDecay = 0.97f;
+    static const float kShaftDensity = 0.85f;
+    static const float kShaftWeight = 0.012f;
+    static const float kShaftExposure = 0.6f;
+    static const float kShaftDiscRadius = 0.04f;
+
+    // Upscale sharpening at half resolution; it falls off linearly to none at native
+    static const float kMaxSharpness = 0.8f;
+
+    static GLuint createTarget(GLint internalFormat, GLenum format, GLenum type, int width, int height,
+        GLint filter = GL_NEAREST) {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glState().BindTexture(0, GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+
+    static GLuint createFramebuffer(GLuint color0, GLuint color1, GLuint depth) {
+        GLuint fbo = 0;
+        glGenFramebuffers(1, &fbo);
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color0, 0);
+        if (color1) glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, color1, 0);
+        if (depth) glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(color1 ? 2 : 1, buffers);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            glDeleteFramebuffers(1, &fbo);
+            throw std::runtime_error("post-processing framebuffer incomplete");
+        }
+        return fbo;
+    }
+
+    GBuffer::~GBuffer() {
+        Release();
+    }
+
+    void GBuffer::Release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (lightFbo) glDeleteFramebuffers(1, &lightFbo);
+        if (forwardFbo) glDeleteFramebuffers(1, &forwardFbo);
+        fbo = lightFbo = forwardFbo = 0;
+        glState().DeleteTexture(albedoTexture);
+        glState().DeleteTexture(normalTexture);
+        glState().DeleteTexture(depthTexture);
+        glState().DeleteTexture(lightTexture);
+        width_ = height_ = 0;
+    }
+
+    // 16 bytes per pixel in total; a position target alone would have been another 8-16
+    void GBuffer::Init(int width, int height) {
+        Release();
+        albedoTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+        normalTexture = createTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, width, height);
+        depthTexture = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, width, height);
+        lightTexture = createTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, width, height, GL_LINEAR);
+
+        try {
+            fbo = createFramebuffer(albedoTexture, normalTexture, depthTexture);
+            lightFbo = createFramebuffer(lightTexture, 0, 0);
+            forwardFbo = createFramebuffer(lightTexture, 0, depthTexture);
+        }
+        catch (...) {
+            Release();
+            throw;
+        }
+        width_ = width;
+        height_ = height;
+    }
+
+    void GBuffer::BindForWriting() {
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, fbo);
+        renderDevice().Viewport(0, 0, width_, height_);
+
+        // Emissive and material row 0 in the background are never read: depth 1 is skipped
+        glState().DepthMask(true);
+        renderDevice().ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        renderDevice().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void GBuffer::BindForReading() {
+        // The light target has no depth attachment, so sampling depthTexture is no feedback loop
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, lightFbo);
+        renderDevice().Viewport(0, 0, width_, height_);
+        glState().BindTexture(kAlbedoUnit, GL_TEXTURE_2D, albedoTexture);
+        glState().BindTexture(kNormalUnit, GL_TEXTURE_2D, normalTexture);
+        glState().BindTexture(kDepthUnit, GL_TEXTURE_2D, depthTexture);
+    }
+
+    void GBuffer::BindForForward() {
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, forwardFbo);
+        renderDevice().Viewport(0, 0, width_, height_);
+    }
+
+    PostProcessor::PostProcessor(GLuint downsampleProgram, GLuint upsampleProgram, GLuint shaftSourceProgram,
+        GLuint shaftProgram, GLuint finalProgram)
+        : downsampleProgram_(downsampleProgram), upsampleProgram_(upsampleProgram), finalProgram_(finalProgram),
+        shaftSourceProgram_(shaftSourceProgram), shaftProgram_(shaftProgram) {
+        glState().UseProgram(downsampleProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(downsampleProgram_, "uSource"), (GLint)kSourceUnit);
+        downTexel_ = glGetUniformLocation(downsampleProgram_, "uTexel");
+        downThreshold_ = glGetUniformLocation(downsampleProgram_, "uThreshold");
+
+        glState().UseProgram(upsampleProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(upsampleProgram_, "uSource"), (GLint)kSourceUnit);
+        upTexel_ = glGetUniformLocation(upsampleProgram_, "uTexel");
+
+        glState().UseProgram(finalProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(finalProgram_, "uScene"), (GLint)kSourceUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(finalProgram_, "uBloom"), (GLint)kBloomUnit);
+        finalTexel_ = glGetUniformLocation(finalProgram_, "uTexel");
+        finalExposure_ = glGetUniformLocation(finalProgram_, "uExposure");
+        finalBloomStrength_ = glGetUniformLocation(finalProgram_, "uBloomStrength");
+        renderDevice().Uniform1i(glGetUniformLocation(finalProgram_, "uDepth"), (GLint)kDepthUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(finalProgram_, "uShafts"), (GLint)kShaftUnit);
+        finalShaftSize_ = glGetUniformLocation(finalProgram_, "uShaftSize");
+        finalDepthParams_ = glGetUniformLocation(finalProgram_, "uDepthParams");
+        finalSharpness_ = glGetUniformLocation(finalProgram_, "uSharpness");
+
+        glState().UseProgram(shaftSourceProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(shaftSourceProgram_, "uSceneTexture"), (GLint)kSourceUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(shaftSourceProgram_, "uDepthTexture"), (GLint)kDepthUnit);
+        sourceLightPos_ = glGetUniformLocation(shaftSourceProgram_, "uLightScreenPos");
+        sourceLightColor_ = glGetUniformLocation(shaftSourceProgram_, "uLightColor");
+        sourceLightDepth_ = glGetUniformLocation(shaftSourceProgram_, "uLightDepth");
+        sourceAspect_ = glGetUniformLocation(shaftSourceProgram_, "uAspect");
+
+        glState().UseProgram(shaftProgram_);
+        renderDevice().Uniform1i(glGetUniformLocation(shaftProgram_, "uSource"), (GLint)kSourceUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(shaftProgram_, "uHistory"), (GLint)kBloomUnit);
+        renderDevice().Uniform1i(glGetUniformLocation(shaftProgram_, "uDepthTexture"), (GLint)kDepthUnit);
+        renderDevice().Uniform1f(glGetUniformLocation(shaftProgram_, "uDecay"), kShaftDecay);
+        renderDevice().Uniform1f(glGetUniformLocation(shaftProgram_, "uDensity"), kShaftDensity);
+        renderDevice().Uniform1f(glGetUniformLocation(shaftProgram_, "uWeight"), kShaftWeight);
+        renderDevice().Uniform1f(glGetUniformLocation(shaftProgram_, "uExposure"), kShaftExposure);
+        shaftLightPos_ = glGetUniformLocation(shaftProgram_, "uLightScreenPos");
+        shaftTargetSize_ = glGetUniformLocation(shaftProgram_, "uTargetSize");
+        shaftDepthParams_ = glGetUniformLocation(shaftProgram_, "uDepthParams");
+        shaftReproject_ = glGetUniformLocation(shaftProgram_, "uReproject");
+        shaftFrame_ = glGetUniformLocation(shaftProgram_, "uFrame");
+        shaftHistoryWeight_ = glGetUniformLocation(shaftProgram_, "uHistoryWeight");
+
+        emptyVao_ = renderDevice().GenVertexArray();
+    }
+
+    PostProcessor::~PostProcessor() {
+        Release();
+        glState().DeleteVertexArray(emptyVao_);
+        glState().DeleteProgram(downsampleProgram_);
+        glState().DeleteProgram(upsampleProgram_);
+        glState().DeleteProgram(shaftSourceProgram_);
+        glState().DeleteProgram(shaftProgram_);
+        glState().DeleteProgram(finalProgram_);
+    }
+
+    void PostProcessor::Release() {
+        if (sceneFbo_) glDeleteFramebuffers(1, &sceneFbo_);
+        sceneFbo_ = 0;
+        glState().DeleteTexture(sceneTexture_);
+        glState().DeleteTexture(sceneDepth_);
+        for (int i = 0; i < kBloomLevels; ++i) {
+            if (bloomFbos_[i]) glDeleteFramebuffers(1, &bloomFbos_[i]);
+            bloomFbos_[i] = 0;
+            glState().DeleteTexture(bloomTextures_[i]);
+        }
+        if (shaftSourceFbo_) glDeleteFramebuffers(1, &shaftSourceFbo_);
+        shaftSourceFbo_ = 0;
+        glState().DeleteTexture(shaftSourceTexture_);
+        for (int i = 0; i < 2; ++i) {
+            if (shaftFbos_[i]) glDeleteFramebuffers(1, &shaftFbos_[i]);
+            shaftFbos_[i] = 0;
+            glState().DeleteTexture(shaftTextures_[i]);
+        }
+        historyValid_ = false;
+        width_ = height_ = 0;
+    }
+
+    // Bloom levels are R11F_G11F_B10F: 4 bytes per pixel and no alpha to carry around
+    void PostProcessor::Init(int width, int height) {
+        Release();
+        sceneTexture_ = createTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, width, height, GL_LINEAR);
+        sceneDepth_ = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, width, height);
+        for (int i = 0; i < kBloomLevels; ++i) {
+            bloomWidth_[i] = std::max(width >> (i + 1), 1);
+            bloomHeight_[i] = std::max(height >> (i + 1), 1);
+            bloomTextures_[i] = createTarget(GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT,
+                bloomWidth_[i], bloomHeight_[i], GL_LINEAR);
+        }
+        shaftWidth_ = std::max(width / kVolumetricDivisor, 1);
+        shaftHeight_ = std::max(height / kVolumetricDivisor, 1);
+        shaftSourceTexture_ = createTarget(GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, shaftWidth_, shaftHeight_, GL_LINEAR);
+        for (int i = 0; i < 2; ++i) {
+            shaftTextures_[i] = createTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, shaftWidth_, shaftHeight_, GL_LINEAR);
+        }
+
+        try {
+            sceneFbo_ = createFramebuffer(sceneTexture_, 0, sceneDepth_);
+            for (int i = 0; i < kBloomLevels; ++i) {
+                bloomFbos_[i] = createFramebuffer(bloomTextures_[i], 0, 0);
+            }
+            shaftSourceFbo_ = createFramebuffer(shaftSourceTexture_, 0, 0);
+            for (int i = 0; i < 2; ++i) {
+                shaftFbos_[i] = createFramebuffer(shaftTextures_[i], 0, 0);
+            }
+        }
+        catch (...) {
+            Release();
+            throw;
+        }
+        width_ = width;
+        height_ = height;
+    }
+
+    void PostProcessor::SetOutputSize(int width, int height) {
+        outputWidth_ = width;
+        outputHeight_ = height;
+    }
+
+    void PostProcessor::BeginScene(const glm::vec3& background) {
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, sceneFbo_);
+        renderDevice().Viewport(0, 0, width_, height_);
+        glState().DepthMask(true);
+        renderDevice().ClearColor(std::pow(background.r, 2.2f), std::pow(background.g, 2.2f),
+            std::pow(background.b, 2.2f), 1.0f);
+        renderDevice().Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void PostProcessor::SetVolumetricLight(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& position,
+        const glm::vec3& color) {
+        viewProj_ = proj * view;
+        depthParams_ = glm::vec2(proj[3][2] / (proj[2][2] - 1.0f), proj[3][2] / (proj[2][2] + 1.0f));
+        shaftsActive_ = false;
+
+        glm::vec4 clip = viewProj_ * glm::vec4(position, 1.0f);
+        if (clip.w <= depthParams_.x) return;
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+        // Shafts of a light just off screen still reach in; fade them over half a screen
+        float outside = std::max(std::max(std::abs(ndc.x), std::abs(ndc.y)) - 1.0f, 0.0f);
+        float fade = 1.0f - std::min(outside * 2.0f, 1.0f);
+        if (fade <= 0.0f) return;
+
+        lightScreenPos_ = glm::vec2(ndc.x, ndc.y) * 0.5f + 0.5f;
+        lightDepth_ = std::min(ndc.z * 0.5f + 0.5f, 1.0f);
+        lightColor_ = glm::vec4(color * fade, kShaftDiscRadius);
+        shaftsActive_ = true;
+    }
+
+    void PostProcessor::BeginStage(PostStage stage) {
+        renderDevice().BeginQuery(GL_TIME_ELAPSED, timer_.Query((int)stage));
+    }
+
+    void PostProcessor::EndStage() {
+        renderDevice().EndQuery(GL_TIME_ELAPSED);
+    }
+
+    void PostProcessor::ApplyBloom(GLuint hdrTexture) {
+        GLStateCache& gl = glState();
+        gl.Disable(GL_DEPTH_TEST);
+        gl.Disable(GL_CULL_FACE);
+        gl.Disable(GL_BLEND);
+        gl.BindVertexArray(emptyVao_);
+
+        // Down: each level averages a 4x4 block of the one above with four bilinear taps. Only
+        // the first step reads full resolution, and it applies the soft threshold on the way.
+        if (timing_) BeginStage(PostStage::BloomDown);
+        gl.UseProgram(downsampleProgram_);
+        GLuint source = hdrTexture;
+        int sourceWidth = width_, sourceHeight = height_;
+        for (int i = 0; i < kBloomLevels; ++i) {
+            renderDevice().BindFramebuffer(GL_FRAMEBUFFER, bloomFbos_[i]);
+            renderDevice().Viewport(0, 0, bloomWidth_[i], bloomHeight_[i]);
+            gl.BindTexture(kSourceUnit, GL_TEXTURE_2D, source);
+            const float texel[2] = { 1.0f / sourceWidth, 1.0f / sourceHeight };
+            const float threshold[4] = { 1.0f, 0.5f, i == 0 ? 1.0f : 0.0f, 0.0f };
+            renderDevice().Uniform2fv(downTexel_, 1, texel);
+            renderDevice().Uniform4fv(downThreshold_, 1, threshold);
+            renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+            source = bloomTextures_[i];
+            sourceWidth = bloomWidth_[i];
+            sourceHeight = bloomHeight_[i];
+        }
+        if (timing_) EndStage();
+
+        // Up: a 3x3 tent of each level is added onto the next larger one, so level 0 ends up
+        // with the sum of every scale
+        if (timing_) BeginStage(PostStage::BloomUp);
+        gl.UseProgram(upsampleProgram_);
+        gl.Enable(GL_BLEND);
+        gl.BlendFunc(GL_ONE, GL_ONE);
+        for (int i = kBloomLevels - 1; i > 0; --i) {
+            renderDevice().BindFramebuffer(GL_FRAMEBUFFER, bloomFbos_[i - 1]);
+            renderDevice().Viewport(0, 0, bloomWidth_[i - 1], bloomHeight_[i - 1]);
+            gl.BindTexture(kSourceUnit, GL_TEXTURE_2D, bloomTextures_[i]);
+            const float texel[2] = { 1.0f / bloomWidth_[i], 1.0f / bloomHeight_[i] };
+            renderDevice().Uniform2fv(upTexel_, 1, texel);
+            renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        gl.Disable(GL_BLEND);
+        if (timing_) EndStage();
+    }
+
+    // ~101 scene fetches per full-resolution pixel before; now 2 per low-res pixel for the
+    // source, at most kMaxSamples + 2 for the march and 5 for the bilateral upsample
+    void PostProcessor::ApplyVolumetricLight(GLuint hdrTexture, GLuint depthTexture) {
+        shaftsDrawn_ = false;
+        if (!shaftsActive_) {
+            historyValid_ = false;
+            return;
+        }
+        GLStateCache& gl = glState();
+        gl.Disable(GL_DEPTH_TEST);
+        gl.Disable(GL_CULL_FACE);
+        gl.Disable(GL_BLEND);
+        gl.BindVertexArray(emptyVao_);
+        renderDevice().Viewport(0, 0, shaftWidth_, shaftHeight_);
+        gl.BindTexture(kDepthUnit, GL_TEXTURE_2D, depthTexture);
+
+        // Source: sky, highlights and the unoccluded light disc, downsampled once
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, shaftSourceFbo_);
+        gl.UseProgram(shaftSourceProgram_);
+        gl.BindTexture(kSourceUnit, GL_TEXTURE_2D, hdrTexture);
+        renderDevice().Uniform2fv(sourceLightPos_, 1, &lightScreenPos_[0]);
+        renderDevice().Uniform4fv(sourceLightColor_, 1, &lightColor_[0]);
+        renderDevice().Uniform1f(sourceLightDepth_, lightDepth_);
+        renderDevice().Uniform1f(sourceAspect_, (float)width_ / (float)height_);
+        renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+
+        // March toward the light, blended with last frame's result where it reprojects
+        int target = 1 - shaftCurrent_;
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, shaftFbos_[target]);
+        gl.UseProgram(shaftProgram_);
+        gl.BindTexture(kSourceUnit, GL_TEXTURE_2D, shaftSourceTexture_);
+        gl.BindTexture(kBloomUnit, GL_TEXTURE_2D, shaftTextures_[shaftCurrent_]);
+        const float targetSize[2] = { (float)shaftWidth_, (float)shaftHeight_ };
+        glm::mat4 reproject = prevViewProj_ * glm::inverse(viewProj_);
+        renderDevice().Uniform2fv(shaftLightPos_, 1, &lightScreenPos_[0]);
+        renderDevice().Uniform2fv(shaftTargetSize_, 1, targetSize);
+        renderDevice().Uniform2fv(shaftDepthParams_, 1, &depthParams_[0]);
+        renderDevice().UniformMatrix4fv(shaftReproject_, 1, GL_FALSE, &reproject[0][0]);
+        renderDevice().Uniform1f(shaftFrame_, (float)(frameIndex_ % 64));
+        renderDevice().Uniform1f(shaftHistoryWeight_, historyValid_ ? 0.9f : 0.0f);
+        renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+
+        shaftCurrent_ = target;
+        prevViewProj_ = viewProj_;
+        historyValid_ = true;
+        shaftsDrawn_ = true;
+        frameIndex_++;
+    }
+
+    void PostProcessor::ApplyToneMappingFXAA(GLuint hdrTexture, GLuint depthTexture, float exposure) {
+        GLStateCache& gl = glState();
+        if (timing_) BeginStage(PostStage::Final);
+        int outputWidth = outputWidth_ > 0 ? outputWidth_ : width_;
+        int outputHeight = outputHeight_ > 0 ? outputHeight_ : height_;
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, 0);
+        renderDevice().Viewport(0, 0, outputWidth, outputHeight);
+        gl.Disable(GL_DEPTH_TEST);
+        gl.Disable(GL_CULL_FACE);
+        gl.Disable(GL_BLEND);
+        gl.UseProgram(finalProgram_);
+        gl.BindTexture(kSourceUnit, GL_TEXTURE_2D, hdrTexture);
+        gl.BindTexture(kBloomUnit, GL_TEXTURE_2D, bloomTextures_[0]);
+        const float texel[2] = { 1.0f / width_, 1.0f / height_ };
+        renderDevice().Uniform2fv(finalTexel_, 1, texel);
+        renderDevice().Uniform1f(finalExposure_, exposure);
+        renderDevice().Uniform1f(finalBloomStrength_, 0.6f);
+        float scale = std::min((float)width_ / outputWidth, 1.0f);
+        renderDevice().Uniform1f(finalSharpness_, kMaxSharpness * 2.0f * (1.0f - scale));
+
+        // A zero shaft size skips the upsample
+        const float shaftSize[2] = { shaftsDrawn_ ? (float)shaftWidth_ : 0.0f, shaftsDrawn_ ? (float)shaftHeight_ : 0.0f };
+        gl.BindTexture(kDepthUnit, GL_TEXTURE_2D, depthTexture);
+        gl.BindTexture(kShaftUnit, GL_TEXTURE_2D, shaftTextures_[shaftCurrent_]);
+        renderDevice().Uniform2fv(finalShaftSize_, 1, shaftSize);
+        renderDevice().Uniform2fv(finalDepthParams_, 1, &depthParams_[0]);
+        gl.BindVertexArray(emptyVao_);
+        renderDevice().DrawArrays(GL_TRIANGLES, 0, 3);
+        gl.Enable(GL_DEPTH_TEST);
+        gl.Enable(GL_CULL_FACE);
+        if (timing_) EndStage();
+    }
+
+    void PostProcessor::Apply(GLuint hdrTexture, GLuint depthTexture, float exposure, FrameStats& stats) {
+        if (timer_.Collect()) {
+            for (int s = 0; s < (int)PostStage::Count; ++s) {
+                stageMs_[s] = (double)timer_.Value(s) * 1e-6;
+            }
+        }
+        stats.bloomDownGpuMs += stageMs_[(int)PostStage::BloomDown];
+        stats.bloomUpGpuMs += stageMs_[(int)PostStage::BloomUp];
+        stats.volumetricGpuMs += stageMs_[(int)PostStage::Volumetric];
+        stats.tonemapGpuMs += stageMs_[(int)PostStage::Final];
+
+        timing_ = true;
+        ApplyBloom(hdrTexture);
+        // Always issued, so every query of the slot has a result even in frames without shafts
+        BeginStage(PostStage::Volumetric);
+        ApplyVolumetricLight(hdrTexture, depthTexture);
+        EndStage();
+        ApplyToneMappingFXAA(hdrTexture, depthTexture, exposure);
+        timing_ = false;
+        timer_.EndFrame();
+        stats.drawCalls += 2 * kBloomLevels + (shaftsDrawn_ ? 2 : 0);
+        shaftsActive_ = false;
+    }
+
+} // namespace game
@@ -0,0 +1,89 @@
+#include "game/RecordingRenderDevice.h"
+
+namespace game {
+
+    RecordingRenderDevice::RecordingRenderDevice(bool keepLog)
+        : keepLog_(keepLog) {
+        if (keepLog_) log_.reserve(4096);
+    }
+
+    void RecordingRenderDevice::BeginFrame() {
+        log_.clear();           // keeps capacity, so steady-state frames do not allocate
+        counters_ = Counters();
+    }
+
+    size_t RecordingRenderDevice::Count(RenderOp op) const {
+        size_t n = 0;
+        for (const RenderCommand& c : log_) {
+            if (c.op == op) n++;
+        }
+        return n;
+    }
+
+    // Names only need to be unique and non-zero
+    GLuint RecordingRenderDevice::GenBuffer() {
+        Record(RenderOp::GenBuffer, nextName_);
+        return nextName_++;
+    }
+
+    GLuint RecordingRenderDevice::GenVertexArray() {
+        Record(RenderOp::GenVertexArray, nextName_);
+        return nextName_++;
+    }
+
+    GLuint RecordingRenderDevice::GenQuery() {
+        Record(RenderOp::GenQuery, nextName_);
+        return nextName_++;
+    }
+
+    void RecordingRenderDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) {
+        counters_.bufferAllocations++;
+        if (data) counters_.uploadedBytes += (size_t)size;
+        Record(RenderOp::BufferData, target, (uint32_t)size, data ? 1u : 0u);
+    }
+
+    void RecordingRenderDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void*) {
+        counters_.uploadedBytes += (size_t)size;
+        Record(RenderOp::BufferSubData, target, (uint32_t)offset, (uint32_t)size);
+    }
+
+    void RecordingRenderDevice::CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr,
+        GLintptr, GLsizeiptr size) {
+        Record(RenderOp::CopyBufferSubData, readTarget, writeTarget, (uint32_t)size);
+    }
+
+    void RecordingRenderDevice::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean,
+        GLsizei, const void* offset) {
+        Record(RenderOp::VertexAttribPointer, index, (uint32_t)size | (type << 8), (uint32_t)(uintptr_t)offset);
+    }
+
+    void RecordingRenderDevice::VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei,
+        const void* offset) {
+        Record(RenderOp::VertexAttribPointer, index, (uint32_t)size | (type << 8), (uint32_t)(uintptr_t)offset);
+    }
+
+    void RecordingRenderDevice::DrawArrays(GLenum mode, GLint first, GLsizei count) {
+        counters_.drawCalls++;
+        counters_.instances++;
+        counters_.vertices += (size_t)count;
+        Record(RenderOp::DrawArrays, mode, (uint32_t)first, (uint32_t)count);
+    }
+
+    void RecordingRenderDevice::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum,
+        const void* indices, GLint) {
+        counters_.drawCalls++;
+        counters_.instances++;
+        counters_.vertices += (size_t)count;
+        Record(RenderOp::DrawElements, mode, (uint32_t)count, (uint32_t)(uintptr_t)indices);
+    }
+
+    void RecordingRenderDevice::DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum,
+        const void* indices, GLsizei instanceCount, GLint) {
+        (void)mode;
+        counters_.drawCalls++;
+        counters_.instances += (size_t)instanceCount;
+        counters_.vertices += (size_t)count * (size_t)instanceCount;
+        Record(RenderOp::DrawElementsInstanced, (uint32_t)count, (uint32_t)instanceCount, (uint32_t)(uintptr_t)indices);
+    }
+
+} // namespace game
@@ -0,0 +1,119 @@
+#include "game/RenderDevice.h"
+
+namespace game {
+
+    // Straight pass-through to OpenGL
+    class GLRenderDevice : public RenderDevice {
+    public:
+        GLuint GenBuffer() override {
+            GLuint id = 0;
+            glGenBuffers(1, &id);
+            return id;
+        }
+        GLuint GenVertexArray() override {
+            GLuint id = 0;
+            glGenVertexArrays(1, &id);
+            return id;
+        }
+        GLuint GenQuery() override {
+            GLuint id = 0;
+            glGenQueries(1, &id);
+            return id;
+        }
+        void DeleteBuffer(GLuint buffer) override { glDeleteBuffers(1, &buffer); }
+        void DeleteVertexArray(GLuint vao) override { glDeleteVertexArrays(1, &vao); }
+        void DeleteTexture(GLuint texture) override { glDeleteTextures(1, &texture); }
+        void DeleteProgram(GLuint program) override { glDeleteProgram(program); }
+        void DeleteQuery(GLuint query) override { glDeleteQueries(1, &query); }
+
+        void UseProgram(GLuint program) override { glUseProgram(program); }
+        void BindVertexArray(GLuint vao) override { glBindVertexArray(vao); }
+        void BindBuffer(GLenum target, GLuint buffer) override { glBindBuffer(target, buffer); }
+        void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override { glBindBufferBase(target, index, buffer); }
+        void ActiveTexture(GLuint unit) override { glActiveTexture(GL_TEXTURE0 + unit); }
+        void BindTexture(GLenum target, GLuint texture) override { glBindTexture(target, texture); }
+        void SetEnabled(GLenum cap, bool enabled) override {
+            if (enabled) glEnable(cap);
+            else glDisable(cap);
+        }
+        void BlendFunc(GLenum src, GLenum dst) override { glBlendFunc(src, dst); }
+        void DepthMask(bool write) override { glDepthMask(write ? GL_TRUE : GL_FALSE); }
+        void DepthFunc(GLenum func) override { glDepthFunc(func); }
+        void CullFace(GLenum face) override { glCullFace(face); }
+        void LineWidth(float width) override { glLineWidth(width); }
+        void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) override { glViewport(x, y, width, height); }
+
+        void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override {
+            glBufferData(target, size, data, usage);
+        }
+        void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override {
+            glBufferSubData(target, offset, size, data);
+        }
+        void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset,
+            GLintptr writeOffset, GLsizeiptr size) override {
+            glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+        }
+        void EnableVertexAttrib(GLuint index) override { glEnableVertexAttribArray(index); }
+        void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+            GLsizei stride, const void* offset) override {
+            glVertexAttribPointer(index, size, type, normalized, stride, offset);
+        }
+        void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
+            const void* offset) override {
+            glVertexAttribIPointer(index, size, type, stride, offset);
+        }
+        void VertexAttribDivisor(GLuint index, GLuint divisor) override { glVertexAttribDivisor(index, divisor); }
+
+        void Uniform1i(GLint location, GLint value) override { glUniform1i(location, value); }
+        void Uniform1f(GLint location, GLfloat value) override { glUniform1f(location, value); }
+        void Uniform2fv(GLint location, GLsizei count, const GLfloat* value) override { glUniform2fv(location, count, value); }
+        void Uniform3fv(GLint location, GLsizei count, const GLfloat* value) override { glUniform3fv(location, count, value); }
+        void Uniform4fv(GLint location, GLsizei count, const GLfloat* value) override { glUniform4fv(location, count, value); }
+        void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) override {
+            glUniformMatrix4fv(location, count, transpose, value);
+        }
+
+        void BeginQuery(GLenum target, GLuint query) override { glBeginQuery(target, query); }
+        void EndQuery(GLenum target) override { glEndQuery(target); }
+        void QueryCounter(GLuint query, GLenum target) override { glQueryCounter(query, target); }
+        bool QueryResultAvailable(GLuint query) override {
+            GLint available = 0;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            return available != 0;
+        }
+        GLuint64 GetQueryResult64(GLuint query) override {
+            GLuint64 result = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+            return result;
+        }
+
+        void BindFramebuffer(GLenum target, GLuint fbo) override { glBindFramebuffer(target, fbo); }
+        void BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+            GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override {
+            glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+        }
+        void ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override { glClearColor(r, g, b, a); }
+        void Clear(GLbitfield mask) override { glClear(mask); }
+        void DrawArrays(GLenum mode, GLint first, GLsizei count) override { glDrawArrays(mode, first, count); }
+        void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLint baseVertex) override {
+            glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+        }
+        void DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+            const void* indices, GLsizei instanceCount, GLint baseVertex) override {
+            glDrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, baseVertex);
+        }
+    };
+
+    static GLRenderDevice glDevice;
+    static RenderDevice* activeDevice = &glDevice;
+
+    RenderDevice& renderDevice() {
+        return *activeDevice;
+    }
+
+    void setRenderDevice(RenderDevice* device) {
+        activeDevice = device ? device : &glDevice;
+    }
+
+} // namespace game
@@ -0,0 +1,244 @@
+#include "game/RenderQueue.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace game {
+
+    RenderQueue::RenderQueue(InstanceBuffer& instances)
+        : instances_(instances) {
+    }
+
+    void RenderQueue::Clear() {
+        packets_.clear();
+        programIds_.clear();
+        textureIds_.clear();
+        meshIds_.clear();
+    }
+
+    // Ids only need to group equal values; overflowing the key field just costs sort quality
+    uint32_t RenderQueue::SmallId(std::vector<uintptr_t>& table, uintptr_t value) {
+        for (size_t i = 0; i < table.size(); ++i) {
+            if (table[i] == value) return (uint32_t)i;
+        }
+        table.push_back(value);
+        return (uint32_t)(table.size() - 1);
+    }
+
+    // Everything but the state ids, which need the queue's tables; safe on any thread
+    static DrawPacket makePacket(RenderPass pass, const SceneProgram& program, SurfaceTexture texture,
+        const Mesh& mesh, int lod, uint16_t material,
+        const glm::mat4& model, const glm::vec4& colorEmissive, float viewDepth) {
+        // Non-negative IEEE floats order the same as their bit patterns
+        float depth = std::max(viewDepth, 0.0f);
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+        DrawPacket p;
+        p.key = ((uint64_t)pass << 62) | ((uint64_t)(lod & 3) << 42) | ((uint64_t)(material & 0x3FF) << 32) | depthBits;
+        p.program = &program;
+        p.mesh = &mesh;
+        p.texture = texture.array;
+        p.lod = (uint8_t)lod;
+        p.pass = pass;
+        float scale = std::max(glm::length(glm::vec3(model[0])),
+            std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        p.sphere = glm::vec4(glm::vec3(model * glm::vec4(mesh.boundsCenter, 1.0f)), mesh.boundsRadius * scale);
+        p.instance = { model, colorEmissive, glm::vec4(texture.array ? (float)texture.layer : -1.0f, (float)material, 0.0f, 0.0f) };
+        return p;
+    }
+
+    void DrawList::Add(RenderPass pass, const SceneProgram& program, SurfaceTexture texture,
+        const Mesh& mesh, int lod, uint16_t material,
+        const glm::mat4& model, const glm::vec4& colorEmissive, float viewDepth) {
+        packets_.push_back(makePacket(pass, program, texture, mesh, lod, material, model, colorEmissive, viewDepth));
+    }
+
+    void RenderQueue::AssignIds(DrawPacket& p) {
+        uint64_t programId = SmallId(programIds_, (uintptr_t)p.program) & 0xF;
+        uint64_t textureId = SmallId(textureIds_, (uintptr_t)p.texture) & 0x3F;
+        uint64_t meshId = SmallId(meshIds_, (uintptr_t)p.mesh) & 0xFF;
+        p.key |= (programId << 58) | (textureId << 52) | (meshId << 44);
+    }
+
+    void RenderQueue::Submit(RenderPass pass, const SceneProgram& program, SurfaceTexture texture,
+        const Mesh& mesh, int lod, uint16_t material,
+        const glm::mat4& model, const glm::vec4& colorEmissive, float viewDepth) {
+        packets_.push_back(makePacket(pass, program, texture, mesh, lod, material, model, colorEmissive, viewDepth));
+        AssignIds(packets_.back());
+    }
+
+    void RenderQueue::Append(const DrawList& list) {
+        size_t first = packets_.size();
+        packets_.insert(packets_.end(), list.packets_.begin(), list.packets_.end());
+        for (size_t i = first; i < packets_.size(); ++i) AssignIds(packets_[i]);
+    }
+
+    void RenderQueue::Cull(const Frustum& frustum, const OcclusionCuller* occlusion, FrameStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        size_t n = packets_.size();
+
+        // Structure-of-arrays copy so the test runs four spheres per instruction
+        cullX_.resize(n);
+        cullY_.resize(n);
+        cullZ_.resize(n);
+        cullRadius_.resize(n);
+        cullVisible_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const glm::vec4& s = packets_[i].sphere;
+            cullX_[i] = s.x;
+            cullY_[i] = s.y;
+            cullZ_[i] = s.z;
+            cullRadius_[i] = s.w;
+        }
+        size_t visible = cullSpheres(frustum, cullX_.data(), cullY_.data(), cullZ_.data(),
+            cullRadius_.data(), n, cullVisible_.data());
+        stats.objectsCulled += (int)(n - visible);
+        stats.cullMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (occlusion) {
+            auto occlusionStart = std::chrono::steady_clock::now();
+            size_t occluded = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const DrawPacket& p = packets_[i];
+                if (!cullVisible_[i] || p.pass == RenderPass::Overlay) continue;
+                if (!occlusion->IsVisible(glm::vec3(p.sphere), p.sphere.w)) {
+                    cullVisible_[i] = 0;
+                    occluded++;
+                }
+            }
+            visible -= occluded;
+            stats.objectsOccluded += (int)occluded;
+            stats.occlusionMs += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - occlusionStart).count();
+        }
+
+        if (visible < n) {
+            size_t out = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (cullVisible_[i]) packets_[out++] = packets_[i];
+            }
+            packets_.resize(out);
+        }
+        stats.objectsVisible += (int)visible;
+    }
+
+    void RenderQueue::Sort() {
+        size_t n = packets_.size();
+        order_.resize(n);
+        orderScratch_.resize(n);
+        keys_.resize(n);
+        keysScratch_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            order_[i] = (uint32_t)i;
+            keys_[i] = packets_[i].key;
+        }
+
+        for (int shift = 0; shift < 64; shift += 8) {
+            size_t counts[256] = {};
+            for (size_t i = 0; i < n; ++i) counts[(keys_[i] >> shift) & 0xFF]++;
+            if (n == 0 || counts[(keys_[0] >> shift) & 0xFF] == n) continue;
+
+            size_t offsets[256];
+            size_t sum = 0;
+            for (int d = 0; d < 256; ++d) {
+                offsets[d] = sum;
+                sum += counts[d];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                size_t dst = offsets[(keys_[i] >> shift) & 0xFF]++;
+                keysScratch_[dst] = keys_[i];
+                orderScratch_[dst] = order_[i];
+            }
+            keys_.swap(keysScratch_);
+            order_.swap(orderScratch_);
+        }
+        instancesUploaded_ = false;
+    }
+
+    void RenderQueue::ApplyPass(RenderPass pass) {
+        GLStateCache& gl = glState();
+        gl.SetEnabled(GL_CULL_FACE, pass == RenderPass::Opaque || pass == RenderPass::Overlay);
+        gl.DepthMask(pass == RenderPass::Opaque || pass == RenderPass::DoubleSided);
+        gl.SetEnabled(GL_DEPTH_TEST, pass != RenderPass::Overlay);
+    }
+
+    void RenderQueue::Execute(FrameStats& stats, RenderPass first, RenderPass last) {
+        if (packets_.empty()) return;
+
+        // Instances are laid out in draw order so every run is one contiguous range
+        if (!instancesUploaded_) {
+            instanceData_.resize(packets_.size());
+            for (size_t i = 0; i < order_.size(); ++i) {
+                instanceData_[i] = packets_[order_[i]].instance;
+            }
+            instances_.Upload(instanceData_.data(), instanceData_.size());
+            instancesUploaded_ = true;
+        }
+
+        size_t rangeBegin = 0;
+        while (rangeBegin < order_.size() && (keys_[rangeBegin] >> 62) < (uint64_t)first) rangeBegin++;
+        size_t rangeEnd = rangeBegin;
+        while (rangeEnd < order_.size() && (keys_[rangeEnd] >> 62) <= (uint64_t)last) rangeEnd++;
+        if (rangeBegin == rangeEnd) return;
+
+        // Material and depth differ freely within a run
+        const uint64_t kStateMask = ~(uint64_t)0x3FFFFFFFFFFull;
+        int pass = -1;
+        const SceneProgram* program = nullptr;
+        GLuint texture = ~0u;
+        GLuint vao = 0;
+        const Mesh* mesh = nullptr;
+
+        size_t begin = rangeBegin;
+        while (begin < rangeEnd) {
+            const DrawPacket& p = packets_[order_[begin]];
+            size_t end = begin + 1;
+            while (end < rangeEnd && (keys_[end] & kStateMask) == (keys_[begin] & kStateMask) &&
+                packets_[order_[end]].mesh == p.mesh && packets_[order_[end]].texture == p.texture &&
+                packets_[order_[end]].program == p.program) {
+                end++;
+            }
+
+            if ((int)p.pass != pass) {
+                pass = (int)p.pass;
+                ApplyPass(p.pass);
+            }
+            if (p.program != program) {
+                program = p.program;
+                glState().UseProgram(program->program);
+                stats.programBinds++;
+                mesh = nullptr;
+            }
+            if (p.texture != texture && p.texture != 0) {
+                glState().BindTexture(0, GL_TEXTURE_2D_ARRAY, p.texture);
+                stats.textureBinds++;
+                texture = p.texture;
+            }
+            if (p.mesh != mesh) {
+                mesh = p.mesh;
+                if (mesh->vao != vao) {
+                    vao = mesh->vao;
+                    instances_.BindVertexArray(vao);
+                    stats.vaoBinds++;
+                }
+                renderDevice().Uniform3fv(program->posScale, 1, &mesh->posScale.x);
+                renderDevice().Uniform3fv(program->posOffset, 1, &mesh->posOffset.x);
+                renderDevice().Uniform1i(program->octNormals, mesh->octNormals ? 1 : 0);
+            }
+            GLsizei count = (GLsizei)(end - begin);
+            instances_.BindRange(begin);
+            drawMeshElementsInstanced(*mesh, p.lod, count);
+
+            stats.drawCalls++;
+            stats.trianglesSubmitted += (size_t)count * (mesh->lods[p.lod].indexCount / 3);
+            stats.trianglesFullDetail += (size_t)count * ((size_t)mesh->indexCount / 3);
+            begin = end;
+        }
+
+        ApplyPass(RenderPass::Opaque);
+    }
+
+} // namespace game
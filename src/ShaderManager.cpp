@@ -0,0 +1,246 @@
+#include "game/ShaderManager.h"
+#include "game/MappedFile.h"
+#include "game/Hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace game {
+
+    static double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ShaderManager::ShaderManager(const std::string& directory)
+        : directory_(directory) {
+    }
+
+    // Needs a current context, so it runs on the first request rather than at construction
+    void ShaderManager::InitCapabilities() {
+        initialized_ = true;
+        const char* vendor = (const char*)glGetString(GL_VENDOR);
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        const char* version = (const char*)glGetString(GL_VERSION);
+        driver_ = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);    // as many as the driver likes
+            parallel_ = true;
+        }
+
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binaries_ = formats > 0;
+        if (binaries_) {
+            std::error_code ec;
+            std::filesystem::create_directories(directory_, ec);
+            if (ec) {
+                std::cerr << "  Shader cache: cannot create " << directory_ << " (" << ec.message() << ")\n";
+                binaries_ = false;
+            }
+        }
+    }
+
+    std::string ShaderManager::LoadText(const std::string& path) {
+        std::ifstream f(path);
+        if (!f) throw std::runtime_error("cannot open " + path);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    std::string ShaderManager::Path(const std::string& name) const {
+        return directory_ + "/" + name + ".gprog";
+    }
+
+    std::string ShaderManager::Request(const std::string& name, const std::string& vertexSource,
+        const std::string& fragmentSource) {
+        if (!initialized_) InitCapabilities();
+        auto start = std::chrono::steady_clock::now();
+
+        uint32_t version = kProgramFileVersion;
+        uint64_t key = hashString(fragmentSource, hashString(vertexSource, hashBytes(&version, sizeof(version))));
+        std::string id = name.empty() ? hashToHex(key) : name;
+
+        auto existing = pending_.find(id);
+        if (existing != pending_.end()) {
+            if (existing->second.key == key && existing->second.error.empty()) return id;
+            Discard(id);
+        }
+
+        Pending p;
+        p.key = key;
+        if (binaries_ && TryLoadBinary(id, key, p)) {
+            p.ms = msSince(start);
+            pending_[id] = std::move(p);
+            return id;
+        }
+
+        // No status queries here: with KHR_parallel_shader_compile they would wait for the driver
+        const char* vs = vertexSource.c_str();
+        const char* fs = fragmentSource.c_str();
+        p.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(p.vertex, 1, &vs, nullptr);
+        glCompileShader(p.vertex);
+        p.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(p.fragment, 1, &fs, nullptr);
+        glCompileShader(p.fragment);
+
+        p.program = glCreateProgram();
+        glAttachShader(p.program, p.vertex);
+        glAttachShader(p.program, p.fragment);
+        if (binaries_) glProgramParameteri(p.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(p.program);
+        p.ms = msSince(start);
+        pending_[id] = std::move(p);
+        return id;
+    }
+
+    void ShaderManager::RequestFiles(const std::string& name, const std::string& vertexPath,
+        const std::string& fragmentPath) {
+        std::string vertexSource, fragmentSource;
+        try {
+            vertexSource = LoadText(vertexPath);
+            fragmentSource = LoadText(fragmentPath);
+        }
+        catch (const std::exception& e) {
+            Discard(name);
+            Pending p;
+            p.error = e.what();
+            pending_[name] = std::move(p);
+            return;
+        }
+        Request(name, vertexSource, fragmentSource);
+    }
+
+    void ShaderManager::Discard(const std::string& name) {
+        auto it = pending_.find(name);
+        if (it == pending_.end()) return;
+        const Pending& p = it->second;
+        if (p.vertex) glDeleteShader(p.vertex);
+        if (p.fragment) glDeleteShader(p.fragment);
+        if (p.program) glDeleteProgram(p.program);
+        pending_.erase(it);
+    }
+
+    std::string ShaderManager::ShaderLog(GLuint shader) {
+        GLint ok = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok) return std::string();
+        GLint n = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &n);
+        std::string log((size_t)std::max(n, 1), '\0');
+        glGetShaderInfoLog(shader, n, nullptr, &log[0]);
+        return log;
+    }
+
+    GLuint ShaderManager::Take(const std::string& name) {
+        auto it = pending_.find(name);
+        if (it == pending_.end()) throw std::runtime_error("shader program '" + name + "' was never requested");
+        Pending p = std::move(it->second);
+        pending_.erase(it);
+        if (!p.error.empty()) throw std::runtime_error("shader program '" + name + "': " + p.error);
+
+        if (!p.vertex) {
+            cacheHits_++;
+            cacheMs_ += p.ms;
+            return p.program;
+        }
+
+        // The first status query is where a parallel compile is waited for
+        auto start = std::chrono::steady_clock::now();
+        GLint ok = 0;
+        glGetProgramiv(p.program, GL_LINK_STATUS, &ok);
+        std::string error;
+        if (!ok) {
+            std::string vertexLog = ShaderLog(p.vertex);
+            std::string fragmentLog = ShaderLog(p.fragment);
+            if (!vertexLog.empty()) error = "vertex shader compile error:\n" + vertexLog;
+            else if (!fragmentLog.empty()) error = "fragment shader compile error:\n" + fragmentLog;
+            else {
+                GLint n = 0;
+                glGetProgramiv(p.program, GL_INFO_LOG_LENGTH, &n);
+                std::string log((size_t)std::max(n, 1), '\0');
+                glGetProgramInfoLog(p.program, n, nullptr, &log[0]);
+                error = "link error:\n" + log;
+            }
+        }
+        glDetachShader(p.program, p.vertex);
+        glDetachShader(p.program, p.fragment);
+        glDeleteShader(p.vertex);
+        glDeleteShader(p.fragment);
+        if (!ok) {
+            glDeleteProgram(p.program);
+            throw std::runtime_error("shader program '" + name + "' " + error);
+        }
+
+        if (binaries_) WriteBinary(name, p.key, p.program);
+        compiled_++;
+        compileMs_ += p.ms + msSince(start);
+        return p.program;
+    }
+
+    GLuint ShaderManager::Build(const std::string& name, const std::string& vertexSource,
+        const std::string& fragmentSource) {
+        return Take(Request(name, vertexSource, fragmentSource));
+    }
+
+    bool ShaderManager::TryLoadBinary(const std::string& name, uint64_t key, Pending& out) {
+        MappedFile file;
+        if (!file.Open(Path(name)) || file.Size() < sizeof(ProgramFileHeader)) return false;
+
+        ProgramFileHeader header;
+        std::memcpy(&header, file.Data(), sizeof(header));
+        if (header.magic != kProgramFileMagic || header.version != kProgramFileVersion || header.key != key) return false;
+        if (header.driverLength != driver_.size()) return false;
+        if (file.Size() != sizeof(header) + header.driverLength + header.binarySize) return false;
+        const unsigned char* driver = file.Data() + sizeof(header);
+        if (std::memcmp(driver, driver_.data(), driver_.size()) != 0) return false;
+
+        // The driver may still refuse a binary it wrote itself; the sources are the fallback
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, driver + header.driverLength, (GLsizei)header.binarySize);
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            glDeleteProgram(program);
+            return false;
+        }
+        out.program = program;
+        return true;
+    }
+
+    void ShaderManager::WriteBinary(const std::string& name, uint64_t key, GLuint program) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        std::vector<char> binary((size_t)length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        ProgramFileHeader header = {};
+        header.magic = kProgramFileMagic;
+        header.version = kProgramFileVersion;
+        header.key = key;
+        header.driverLength = (uint32_t)driver_.size();
+        header.binaryFormat = format;
+        header.binarySize = (uint64_t)length;
+
+        writeFileAtomic(Path(name), {
+            { &header, sizeof(header) },
+            { driver_.data(), driver_.size() },
+            { binary.data(), (size_t)length } });
+    }
+
+    ShaderManager& shaderManager() {
+        static ShaderManager manager("cache/shaders");
+        return manager;
+    }
+
+} // namespace game
@@ -0,0 +1,119 @@
+#include "game/ShadowMap.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace game {
+
+    // Depth-only render target; sampled with hardware comparison (sampler2DShadow)
+    static GLuint createDepthTarget(int width, int height, GLuint& texture) {
+        glGenTextures(1, &texture);
+        glState().BindTexture(0, GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0,
+            GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };    // outside the map is lit
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+        GLuint fbo = 0;
+        glGenFramebuffers(1, &fbo);
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            glDeleteFramebuffers(1, &fbo);
+            glState().DeleteTexture(texture);
+            throw std::runtime_error("shadow map framebuffer incomplete");
+        }
+        return fbo;
+    }
+
+    ShadowMap::ShadowMap(int width, int height)
+        : fbo_(0), depthMap_(0), staticFbo_(0), staticDepthMap_(0), width_(width), height_(height) {
+        fbo_ = createDepthTarget(width_, height_, depthMap_);
+        try {
+            staticFbo_ = createDepthTarget(width_, height_, staticDepthMap_);
+        }
+        catch (...) {
+            glDeleteFramebuffers(1, &fbo_);
+            glState().DeleteTexture(depthMap_);
+            throw;
+        }
+    }
+
+    ShadowMap::~ShadowMap() {
+        if (fbo_) glDeleteFramebuffers(1, &fbo_);
+        if (staticFbo_) glDeleteFramebuffers(1, &staticFbo_);
+        glState().DeleteTexture(depthMap_);
+        glState().DeleteTexture(staticDepthMap_);
+    }
+
+    bool ShadowMap::StaticDirty(const glm::mat4& lightSpaceMatrix) const {
+        return staticDirty_ || lightSpaceMatrix != staticMatrix_;
+    }
+
+    void ShadowMap::BeginPass(GLuint fbo) {
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, fbo);
+        renderDevice().Viewport(0, 0, width_, height_);
+
+        // Front faces are culled so the stored depth is the back of each caster, which keeps
+        // lit surfaces clear of acne without a large bias
+        glState().Enable(GL_DEPTH_TEST);
+        glState().DepthMask(true);
+        glState().CullFace(GL_FRONT);
+    }
+
+    void ShadowMap::BeginStaticPass(const glm::mat4& lightSpaceMatrix) {
+        BeginPass(staticFbo_);
+        renderDevice().Clear(GL_DEPTH_BUFFER_BIT);
+        staticMatrix_ = lightSpaceMatrix;
+        staticDirty_ = false;
+    }
+
+    void ShadowMap::BeginShadowPass(const glm::mat4& lightSpaceMatrix) {
+        (void)lightSpaceMatrix;    // must match the one the static pass used (see StaticDirty)
+
+        // The copy replaces the whole depth buffer, so no clear is needed
+        glState().Disable(GL_SCISSOR_TEST);
+        renderDevice().BindFramebuffer(GL_READ_FRAMEBUFFER, staticFbo_);
+        renderDevice().BindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo_);
+        renderDevice().BlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_,
+            GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        BeginPass(fbo_);
+    }
+
+    void ShadowMap::EndShadowPass() {
+        renderDevice().BindFramebuffer(GL_FRAMEBUFFER, 0);
+        glState().CullFace(GL_BACK);
+    }
+
+    void ShadowMap::BindForReading(int textureUnit) {
+        glState().BindTexture((GLuint)textureUnit, GL_TEXTURE_2D, depthMap_);
+    }
+
+    glm::mat4 ShadowMap::GetLightSpaceMatrix(const glm::vec3& lightPos,
+        const glm::vec3& targetPos, float radius) {
+        // Directional light looking from lightPos at targetPos; the ortho box encloses a sphere
+        // of the given radius around the target
+        glm::vec3 dir = targetPos - lightPos;
+        float distance = glm::length(dir);
+        glm::vec3 up = std::abs(dir.y) > 0.99f * distance ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+        glm::mat4 view = glm::lookAt(lightPos, targetPos, up);
+        glm::mat4 proj = glm::ortho(-radius, radius, -radius, radius,
+            std::max(0.1f, distance - radius), distance + radius);
+        return proj * view;
+    }
+
+} // namespace game
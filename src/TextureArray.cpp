@@ -0,0 +1,113 @@
+#include "game/TextureArray.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include <algorithm>
+
+namespace game {
+
+    TextureArray::TextureArray(int width, int height, int initialCapacity)
+        : width_(width), height_(height) {
+        levels_ = 1;
+        while ((std::max(width_, height_) >> levels_) > 0) levels_++;
+        Allocate(std::max(initialCapacity, 1));
+    }
+
+    TextureArray::~TextureArray() {
+        glState().DeleteTexture(id_);
+    }
+
+    void TextureArray::Allocate(int capacity) {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glState().BindTexture(0, GL_TEXTURE_2D_ARRAY, texture);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+        for (int level = 0; level < levels_; ++level) {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(width_ >> level, 1),
+                std::max(height_ >> level, 1), capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+
+        // GL 3.3 has no glCopyImageSubData: each old layer and level is attached to a read
+        // framebuffer and copied into the new storage
+        if (id_ && layers_ > 0) {
+            GLuint fbo = 0;
+            glGenFramebuffers(1, &fbo);
+            renderDevice().BindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            for (int level = 0; level < levels_; ++level) {
+                for (int layer = 0; layer < layers_; ++layer) {
+                    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, id_, level, layer);
+                    glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, 0, 0,
+                        std::max(width_ >> level, 1), std::max(height_ >> level, 1));
+                }
+            }
+            renderDevice().BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &fbo);
+        }
+
+        glState().DeleteTexture(id_);
+        id_ = texture;
+        capacity_ = capacity;
+    }
+
+    int TextureArray::Add(const std::string& name, const unsigned char* rgb) {
+        auto it = names_.find(name);
+        int layer = it != names_.end() ? it->second : layers_;
+        if (layer == layers_) {
+            if (layers_ == capacity_) Allocate(capacity_ * 2);
+            names_[name] = layers_++;
+        }
+        Upload(layer, rgb);
+        return layer;
+    }
+
+    int TextureArray::Layer(const std::string& name) const {
+        auto it = names_.find(name);
+        return it != names_.end() ? it->second : -1;
+    }
+
+    // RGBA rows are always 4-byte aligned, so the small mips need no unpack alignment change
+    void TextureArray::Upload(int layer, const unsigned char* rgb) {
+        std::vector<unsigned char>& current = mips_[0];
+        std::vector<unsigned char>& next = mips_[1];
+        current.resize((size_t)width_ * height_ * 4);
+        for (size_t i = 0, n = (size_t)width_ * height_; i < n; ++i) {
+            current[4 * i + 0] = rgb[3 * i + 0];
+            current[4 * i + 1] = rgb[3 * i + 1];
+            current[4 * i + 2] = rgb[3 * i + 2];
+            current[4 * i + 3] = 255;
+        }
+
+        glState().BindTexture(0, GL_TEXTURE_2D_ARRAY, id_);
+        int w = width_, h = height_;
+        for (int level = 0; level < levels_; ++level) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, current.data());
+            if (level + 1 == levels_) break;
+
+            // 2x2 box filter; an axis already at 1 texel repeats its row or column
+            int nw = std::max(w >> 1, 1), nh = std::max(h >> 1, 1);
+            next.resize((size_t)nw * nh * 4);
+            for (int y = 0; y < nh; ++y) {
+                int y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+                for (int x = 0; x < nw; ++x) {
+                    int x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+                    for (int c = 0; c < 4; ++c) {
+                        int sum = current[((size_t)y0 * w + x0) * 4 + c] + current[((size_t)y0 * w + x1) * 4 + c] +
+                            current[((size_t)y1 * w + x0) * 4 + c] + current[((size_t)y1 * w + x1) * 4 + c];
+                        next[((size_t)y * nw + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            current.swap(next);
+            w = nw;
+            h = nh;
+        }
+    }
+
+    void TextureArray::Bind(GLuint unit) const {
+        glState().BindTexture(unit, GL_TEXTURE_2D_ARRAY, id_);
+    }
+
+} // namespace game
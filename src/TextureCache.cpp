@@ -0,0 +1,73 @@
+#include "game/TextureCache.h"
+#include "game/MappedFile.h"
+#include "game/Hash.h"
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace game {
+
+    TextureCache::TextureCache(const std::string& directory, JobSystem* jobs)
+        : directory_(directory), jobs_(jobs) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+        if (ec) {
+            std::cerr << "  Texture cache: cannot create " << directory_ << " (" << ec.message() << ")\n";
+        }
+    }
+
+    uint64_t TextureCache::ComputeKey(const SurfaceParams& params) {
+        uint32_t versions[2] = { kTextureFileVersion, kTextureGeneratorVersion };
+        return hashString(describeSurface(params), hashBytes(versions, sizeof(versions)));
+    }
+
+    std::vector<unsigned char> TextureCache::Load(const std::string& name, const SurfaceParams& params) {
+        uint64_t key = ComputeKey(params);
+        std::string path = directory_ + "/" + name + ".gtex";
+
+        std::vector<unsigned char> pixels;
+        if (TryRead(path, key, params.size, pixels)) {
+            hits_++;
+            return pixels;
+        }
+
+        misses_++;
+        pixels = generateSurface(params, jobs_);
+        if (!Write(path, key, params.size, pixels)) {
+            std::cerr << "  Texture cache: failed to write " << path << "\n";
+        }
+        return pixels;
+    }
+
+    bool TextureCache::TryRead(const std::string& path, uint64_t key, int size, std::vector<unsigned char>& out) {
+        MappedFile file;
+        if (!file.Open(path)) return false;
+        if (file.Size() < sizeof(TextureFileHeader)) return false;
+
+        TextureFileHeader header;
+        std::memcpy(&header, file.Data(), sizeof(header));
+
+        if (header.magic != kTextureFileMagic || header.version != kTextureFileVersion) return false;
+        if (header.key != key) return false;
+        if (header.width != (uint32_t)size || header.height != (uint32_t)size || header.channels != 3) return false;
+
+        size_t bytes = (size_t)size * size * 3;
+        if (file.Size() < sizeof(header) + bytes) return false;
+        out.assign(file.Data() + sizeof(header), file.Data() + sizeof(header) + bytes);
+        return true;
+    }
+
+    bool TextureCache::Write(const std::string& path, uint64_t key, int size, const std::vector<unsigned char>& pixels) {
+        TextureFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = kTextureFileMagic;
+        header.version = kTextureFileVersion;
+        header.key = key;
+        header.width = (uint32_t)size;
+        header.height = (uint32_t)size;
+        header.channels = 3;
+
+        return writeFileAtomic(path, { { &header, sizeof(header) }, { pixels.data(), pixels.size() } });
+    }
+
+} // namespace game
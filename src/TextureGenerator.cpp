@@ -0,0 +1,151 @@
+#include "game/TextureGenerator.h"
+#include "game/JobSystem.h"
+#include "game/Noise.h"
+#include <algorithm>
+#include <cmath>
+
+namespace game {
+
+    // Rows per ParallelFor chunk
+    static const size_t kBandRows = 16;
+
+    struct Rgb {
+        float r, g, b;
+    };
+
+    static Rgb mix(const Rgb& a, const Rgb& b, float t) {
+        return { a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t };
+    }
+
+    static float saturate(float x) {
+        return std::min(std::max(x, 0.0f), 1.0f);
+    }
+
+    static float smoothstep(float edge0, float edge1, float x) {
+        float t = saturate((x - edge0) / (edge1 - edge0));
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    static void store(unsigned char* texel, const Rgb& c, float shade) {
+        texel[0] = (unsigned char)(saturate(c.r * shade) * 255.0f + 0.5f);
+        texel[1] = (unsigned char)(saturate(c.g * shade) * 255.0f + 0.5f);
+        texel[2] = (unsigned char)(saturate(c.b * shade) * 255.0f + 0.5f);
+    }
+
+    // Noise rows for one texel row; each band has its own
+    struct RowScratch {
+        std::vector<float> a, b, c;
+    };
+
+    // Patches of darker and lighter green under fine blade streaks running along v
+    static void grassRow(unsigned char* out, int size, float v, uint32_t seed, RowScratch& s) {
+        FractalParams patches;
+        patches.cellsX = patches.cellsY = 4;
+        patches.seed = seed;
+        FractalParams blades;
+        blades.cellsX = 64;
+        blades.cellsY = 8;
+        blades.octaves = 3;
+        blades.seed = seed + 100;
+        fbmRow(s.a.data(), size, v, patches);
+        ridgedRow(s.b.data(), size, v, blades);
+
+        const Rgb dark = { 0.12f, 0.35f, 0.10f }, light = { 0.30f, 0.56f, 0.16f };
+        for (int x = 0; x < size; ++x) {
+            Rgb c = mix(dark, light, saturate(0.5f + s.a[x] * 1.2f));
+            store(out + x * 3, c, 0.7f + 0.4f * s.b[x]);
+        }
+    }
+
+    // Irregular blocks (Worley cells) with dark mortar along the cell borders and mottled faces
+    static void stoneRow(unsigned char* out, int size, float v, uint32_t seed, RowScratch& s) {
+        FractalParams mottle;
+        mottle.cellsX = mottle.cellsY = 8;
+        mottle.seed = seed + 200;
+        worleyRow(s.a.data(), s.b.data(), size, v, 6, seed);
+        fbmRow(s.c.data(), size, v, mottle);
+
+        const Rgb tint = { 1.0f, 0.97f, 0.92f };
+        for (int x = 0; x < size; ++x) {
+            float mortar = smoothstep(0.02f, 0.12f, s.b[x] - s.a[x]);
+            float gray = 0.5f + 0.3f * s.c[x] - 0.08f * s.a[x];
+            store(out + x * 3, tint, gray * (0.35f + 0.65f * mortar));
+        }
+    }
+
+    // Brushed metal: long streaks along u over a faint large scale variation
+    static void metalRow(unsigned char* out, int size, float v, uint32_t seed, RowScratch& s) {
+        FractalParams streaks;
+        streaks.cellsX = 2;
+        streaks.cellsY = 64;
+        streaks.octaves = 3;
+        streaks.seed = seed + 300;
+        FractalParams cloud;
+        cloud.cellsX = cloud.cellsY = 4;
+        cloud.octaves = 4;
+        cloud.seed = seed + 400;
+        fbmRow(s.a.data(), size, v, streaks);
+        fbmRow(s.b.data(), size, v, cloud);
+
+        const Rgb steel = { 0.64f, 0.65f, 0.68f };
+        for (int x = 0; x < size; ++x) {
+            store(out + x * 3, steel, 1.0f + 0.25f * s.a[x] + 0.1f * s.b[x]);
+        }
+    }
+
+    // Eight planks across v with stretched grain, a shade per plank and dark seams between
+    static void woodRow(unsigned char* out, int size, float v, uint32_t seed, RowScratch& s) {
+        const int planks = 8;
+        FractalParams grain;
+        grain.cellsX = 2;
+        grain.cellsY = 48;
+        grain.octaves = 4;
+        grain.seed = seed + 500;
+        fbmRow(s.a.data(), size, v, grain);
+
+        float p = v * planks;
+        int plank = (int)p;
+        float across = p - (float)plank;
+        float seamTexels = std::min(across, 1.0f - across) * (float)size / planks;
+        float seam = seamTexels < 1.5f ? 0.55f : 1.0f;
+        float tint = (float)(hashCell((uint32_t)plank, 0, seed) & 0xFF) / 255.0f * 0.3f - 0.15f;
+
+        const Rgb dark = { 0.45f, 0.29f, 0.17f }, light = { 0.72f, 0.54f, 0.36f };
+        for (int x = 0; x < size; ++x) {
+            Rgb c = mix(dark, light, saturate(0.5f + s.a[x] * 1.6f + tint));
+            store(out + x * 3, c, seam);
+        }
+    }
+
+    std::string describeSurface(const SurfaceParams& params) {
+        static const char* names[] = { "grass", "stone", "metal", "wood" };
+        return std::string(names[(int)params.surface]) + " size=" + std::to_string(params.size) +
+            " seed=" + std::to_string(params.seed);
+    }
+
+    std::vector<unsigned char> generateSurface(const SurfaceParams& params, JobSystem* jobs) {
+        typedef void (*RowFn)(unsigned char*, int, float, uint32_t, RowScratch&);
+        static const RowFn rows[] = { grassRow, stoneRow, metalRow, woodRow };
+        const RowFn row = rows[(int)params.surface];
+        const int size = params.size;
+        std::vector<unsigned char> pixels((size_t)size * size * 3);
+
+        auto band = [&](size_t, size_t begin, size_t end) {
+            RowScratch scratch;
+            scratch.a.resize(size);
+            scratch.b.resize(size);
+            scratch.c.resize(size);
+            for (size_t y = begin; y < end; ++y) {
+                row(pixels.data() + y * size * 3, size, (float)y / (float)size, params.seed, scratch);
+            }
+            };
+        if (jobs) {
+            jobs->ParallelFor((size_t)size, kBandRows, band);
+        }
+        else {
+            band(0, 0, (size_t)size);
+        }
+        return pixels;
+    }
+
+} // namespace game
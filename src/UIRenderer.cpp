@@ -1,6 +1,10 @@
 ﻿#include "game/UIRenderer.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+#include "game/ShaderManager.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstddef>
 #include <iostream>
 
 namespace game {
@@ -78,128 +82,148 @@ namespace game {
 // 8 (34)
 {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0},
 // 9 (35)
-{0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,1, 0,0,0,0,1, 0,0,0,0,1, 0,1,1,1,0}, };
+{0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,1, 0,0,0,0,1, 0,0,0,0,1, 0,1,1,1,0},
+        // . (36)
+        {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,1,1,0,0, 0,1,1,0,0},
+        // : (37)
+        {0,0,0,0,0, 0,1,1,0,0, 0,1,1,0,0, 0,0,0,0,0, 0,1,1,0,0, 0,1,1,0,0, 0,0,0,0,0},
+        // - (38)
+        {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 1,1,1,1,1, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0},
+        // / (39)
+        {0,0,0,0,1, 0,0,0,0,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,0,0,0,0, 1,0,0,0,0},
+        // % (40)
+        {1,1,0,0,1, 1,1,0,0,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 1,0,0,1,1, 1,0,0,1,1}, };
+
+    static const int kGlyphCount = sizeof(FONT_DATA) / sizeof(FONT_DATA[0]);
 
     // Map characters to font indices
     static int GetFontIndex(char c) {
         if (c >= 'A' && c <= 'Z') return c - 'A';          // 0-25
         if (c >= 'a' && c <= 'z') return c - 'a';          // Use uppercase
         if (c >= '0' && c <= '9') return 26 + (c - '0');   // 26-35
-        if (c == ' ') return -1; // Space (don't render)
-        return -1; // Unknown character (don't render)
-    }    UIRenderer::UIRenderer()
-        : shader_(0), vao_(0), vbo_(0),
-        uProjection_(-1), uModel_(-1), uColor_(-1),
+        switch (c) {
+        case '.': return 36;
+        case ':': return 37;
+        case '-': return 38;
+        case '/': return 39;
+        case '%': return 40;
+        }
+        return -1; // Space or unknown character (don't render)
+    }
+
+    // Each glyph row as horizontal runs of lit pixels, so a character costs a handful of
+    // quads instead of one per pixel
+    struct GlyphRun {
+        uint8_t row, col, length;
+    };
+    static std::vector<GlyphRun> glyphRuns;
+    static int glyphFirstRun[kGlyphCount + 1];
+
+    UIRenderer::UIRenderer()
+        : shader_(0), vao_(0), vbo_(0), ebo_(0),
+        uProjection_(-1), quadsThisPass_(0),
         screenWidth_(1280), screenHeight_(720) {
     }
 
     UIRenderer::~UIRenderer() {
-        if (vao_) glDeleteVertexArrays(1, &vao_);
-        if (vbo_) glDeleteBuffers(1, &vbo_);
-        if (shader_) glDeleteProgram(shader_);
+        glState().DeleteVertexArray(vao_);
+        glState().DeleteBuffer(vbo_);
+        glState().DeleteBuffer(ebo_);
+        glState().DeleteProgram(shader_);
     }
 
     void UIRenderer::Init(int screenWidth, int screenHeight) {
-        screenWidth_ = screenWidth;
-        screenHeight_ = screenHeight;
-
         InitShaders();
+        InitHeadless(screenWidth, screenHeight);
+
+        std::cout << "  UI Renderer initialized with text support\n";
+    }
+
+    void UIRenderer::InitHeadless(int screenWidth, int screenHeight) {
         InitMesh();
         InitFont();
         SetScreenSize(screenWidth, screenHeight);
-
-        std::cout << "  UI Renderer initialized with text support\n";
     }
 
     void UIRenderer::InitShaders() {
         const char* vertSrc = R"(
         #version 330 core
         layout(location = 0) in vec2 aPos;
+        layout(location = 1) in vec4 aColor;
         
         uniform mat4 uProjection;
-        uniform mat4 uModel;
+        out vec4 vColor;
         
         void main() {
-            gl_Position = uProjection * uModel * vec4(aPos, 0.0, 1.0);
+            vColor = aColor;
+            gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
         }
     )";
 
         const char* fragSrc = R"(
         #version 330 core
-        uniform vec4 uColor;
+        in vec4 vColor;
         out vec4 FragColor;
         
         void main() {
-            FragColor = uColor;
+            FragColor = vColor;
         }
     )";
 
-        GLuint vert = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vert, 1, &vertSrc, nullptr);
-        glCompileShader(vert);
-
-        GLint success;
-        glGetShaderiv(vert, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(vert, 512, nullptr, log);
-            std::cerr << "UI vertex shader error: " << log << std::endl;
-        }
-
-        GLuint frag = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(frag, 1, &fragSrc, nullptr);
-        glCompileShader(frag);
-
-        glGetShaderiv(frag, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetShaderInfoLog(frag, 512, nullptr, log);
-            std::cerr << "UI fragment shader error: " << log << std::endl;
-        }
-
-        shader_ = glCreateProgram();
-        glAttachShader(shader_, vert);
-        glAttachShader(shader_, frag);
-        glLinkProgram(shader_);
-
-        glGetProgramiv(shader_, GL_LINK_STATUS, &success);
-        if (!success) {
-            char log[512];
-            glGetProgramInfoLog(shader_, 512, nullptr, log);
-            std::cerr << "UI shader link error: " << log << std::endl;
-        }
-
-        glDeleteShader(vert);
-        glDeleteShader(frag);
+        shader_ = shaderManager().Build("ui", vertSrc, fragSrc);
 
         uProjection_ = glGetUniformLocation(shader_, "uProjection");
-        uModel_ = glGetUniformLocation(shader_, "uModel");
-        uColor_ = glGetUniformLocation(shader_, "uColor");
     }
 
     void UIRenderer::InitMesh() {
-        float vertices[] = {
-            0.0f, 0.0f,
-            1.0f, 0.0f,
-            1.0f, 1.0f,
-            0.0f, 1.0f
-        };
+        // Quads share one static index pattern; vertices are streamed every flush
+        std::vector<uint16_t> indices((size_t)kMaxQuads * 6);
+        for (int q = 0; q < kMaxQuads; ++q) {
+            uint16_t v = (uint16_t)(q * 4);
+            uint16_t* i = &indices[(size_t)q * 6];
+            i[0] = v; i[1] = v + 1; i[2] = v + 2;
+            i[3] = v; i[4] = v + 2; i[5] = v + 3;
+        }
 
-        glGenVertexArrays(1, &vao_);
-        glGenBuffers(1, &vbo_);
+        vao_ = renderDevice().GenVertexArray();
+        vbo_ = renderDevice().GenBuffer();
+        ebo_ = renderDevice().GenBuffer();
 
-        glBindVertexArray(vao_);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glState().BindVertexArray(vao_);
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)kMaxQuads * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+        glState().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+        renderDevice().BufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint16_t)),
+            indices.data(), GL_STATIC_DRAW);
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        renderDevice().EnableVertexAttrib(0);
+        renderDevice().VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+        renderDevice().EnableVertexAttrib(1);
+        renderDevice().VertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, rgba));
 
-        glBindVertexArray(0);
+        glState().BindVertexArray(0);
+        batch_.reserve((size_t)kMaxQuads * 4);
     }
 
     void UIRenderer::InitFont() {
-        // Font data is already defined above
+        if (!glyphRuns.empty()) return;
+
+        for (int g = 0; g < kGlyphCount; ++g) {
+            glyphFirstRun[g] = (int)glyphRuns.size();
+            for (int row = 0; row < 7; ++row) {
+                int col = 0;
+                while (col < 5) {
+                    if (!FONT_DATA[g][row * 5 + col]) {
+                        col++;
+                        continue;
+                    }
+                    int start = col;
+                    while (col < 5 && FONT_DATA[g][row * 5 + col]) col++;
+                    glyphRuns.push_back({ (uint8_t)row, (uint8_t)start, (uint8_t)(col - start) });
+                }
+            }
+        }
+        glyphFirstRun[kGlyphCount] = (int)glyphRuns.size();
     }
 
     void UIRenderer::SetScreenSize(int width, int height) {
@@ -209,31 +233,48 @@ namespace game {
     }
 
     void UIRenderer::BeginUI() {
-        glUseProgram(shader_);
-        glUniformMatrix4fv(uProjection_, 1, GL_FALSE, glm::value_ptr(projection_));
+        glState().UseProgram(shader_);
+        renderDevice().UniformMatrix4fv(uProjection_, 1, GL_FALSE, glm::value_ptr(projection_));
 
-        glDisable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glState().Disable(GL_DEPTH_TEST);
+        glState().Enable(GL_BLEND);
+        glState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        quadsThisPass_ = 0;
     }
 
     void UIRenderer::EndUI() {
-        glEnable(GL_DEPTH_TEST);
-        glUseProgram(0);
+        Flush();
+        glState().Enable(GL_DEPTH_TEST);
     }
 
-    void UIRenderer::RenderRect(float x, float y, float width, float height,
-        const glm::vec4& color) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(x, y, 0.0f));
-        model = glm::scale(model, glm::vec3(width, height, 1.0f));
+    void UIRenderer::Flush() {
+        if (batch_.empty()) return;
 
-        glUniformMatrix4fv(uModel_, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform4fv(uColor_, 1, glm::value_ptr(color));
+        GLsizei quads = (GLsizei)(batch_.size() / 4);
+        glState().UseProgram(shader_);
+        glState().BindVertexArray(vao_);
+        glState().BindBuffer(GL_ARRAY_BUFFER, vbo_);
+        renderDevice().BufferData(GL_ARRAY_BUFFER, (GLsizeiptr)kMaxQuads * 4 * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+        renderDevice().BufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(batch_.size() * sizeof(Vertex)), batch_.data());
+        renderDevice().DrawElementsBaseVertex(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, nullptr, 0);
+
+        quadsThisPass_ += quads;
+        batch_.clear();
+    }
 
-        glBindVertexArray(vao_);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-        glBindVertexArray(0);
+    void UIRenderer::RenderRect(float x, float y, float width, float height,
+        const glm::vec4& color) {
+        if (batch_.size() >= (size_t)kMaxQuads * 4) Flush();
+
+        glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+        Vertex v{ x, y, { (uint8_t)c.r, (uint8_t)c.g, (uint8_t)c.b, (uint8_t)c.a } };
+        batch_.push_back(v);
+        v.x = x + width;
+        batch_.push_back(v);
+        v.y = y + height;
+        batch_.push_back(v);
+        v.x = x;
+        batch_.push_back(v);
     }
 
     void UIRenderer::RenderBorder(float x, float y, float width, float height,
@@ -260,41 +301,37 @@ namespace game {
 
     void UIRenderer::RenderChar(char c, float x, float y, float scale, const glm::vec4& color) {
         int idx = GetFontIndex(c);
-        if (idx < 0 || idx >= 36) return; // Fixed: array has 36 elements (0-35)
+        if (idx < 0 || idx >= kGlyphCount) return;
 
-        const bool* pattern = FONT_DATA[idx];
         float pixelSize = scale;
-
-        // Draw 5x7 grid
-        for (int row = 0; row < 7; row++) {
-            for (int col = 0; col < 5; col++) {
-                if (pattern[row * 5 + col]) {
-                    RenderRect(x + col * pixelSize, y + row * pixelSize,
-                        pixelSize, pixelSize, color);
-                }
-            }
+        for (int r = glyphFirstRun[idx]; r < glyphFirstRun[idx + 1]; ++r) {
+            const GlyphRun& run = glyphRuns[r];
+            RenderRect(x + run.col * pixelSize, y + run.row * pixelSize,
+                run.length * pixelSize, pixelSize, color);
         }
     }
 
     void UIRenderer::RenderText(const std::string& text, float x, float y,
         float scale, const glm::vec3& color) {
+        RenderText(text.c_str(), x, y, scale, glm::vec4(color, 1.0f));
+    }
+
+    // No std::string, so per-frame overlays (the perf HUD) can format into a stack buffer
+    void UIRenderer::RenderText(const char* text, float x, float y,
+        float scale, const glm::vec4& color) {
         float charWidth = 5.0f * scale;
         float spacing = 2.0f * scale;
-        glm::vec4 col4(color.r, color.g, color.b, 1.0f);
 
         float currentX = x;
-        for (char c : text) {
-            RenderChar(c, currentX, y, scale, col4);
+        for (const char* c = text; *c; ++c) {
+            RenderChar(*c, currentX, y, scale, color);
             currentX += charWidth + spacing;
         }
     }
 
     void UIRenderer::RenderCenteredText(const std::string& text, float y,
         float scale, const glm::vec3& color) {
-        float charWidth = 5.0f * scale;
-        float spacing = 2.0f * scale;
-        float totalWidth = text.length() * (charWidth + spacing) - spacing;
-        float x = (screenWidth_ - totalWidth) / 2.0f;
+        float x = (screenWidth_ - TextWidth(text.length(), scale)) / 2.0f;
 
         RenderText(text, x, y, scale, color);
     }
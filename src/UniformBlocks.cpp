@@ -0,0 +1,38 @@
+#include "game/UniformBlocks.h"
+#include "game/GLState.h"
+#include "game/RenderDevice.h"
+
+namespace game {
+
+    UniformBuffer::UniformBuffer(GLuint binding, size_t size)
+        : binding_(binding), size_(size) {
+        ubo_ = renderDevice().GenBuffer();
+        glState().BindBuffer(GL_UNIFORM_BUFFER, ubo_);
+        renderDevice().BufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)size_, nullptr, GL_DYNAMIC_DRAW);
+        glState().BindBuffer(GL_UNIFORM_BUFFER, 0);
+        glState().BindBufferBase(GL_UNIFORM_BUFFER, binding_, ubo_);
+    }
+
+    UniformBuffer::~UniformBuffer() {
+        glState().DeleteBuffer(ubo_);
+    }
+
+    void UniformBuffer::Update(const void* data, size_t size) {
+        if (size > size_) size = size_;
+        glState().BindBuffer(GL_UNIFORM_BUFFER, ubo_);
+        renderDevice().BufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)size_, nullptr, GL_DYNAMIC_DRAW);
+        renderDevice().BufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)size, data);
+    }
+
+    void bindUniformBlocks(GLuint program) {
+        GLuint frame = glGetUniformBlockIndex(program, "FrameData");
+        if (frame != GL_INVALID_INDEX) glUniformBlockBinding(program, frame, kFrameBlockBinding);
+
+        GLuint materials = glGetUniformBlockIndex(program, "MaterialTable");
+        if (materials != GL_INVALID_INDEX) glUniformBlockBinding(program, materials, kMaterialBlockBinding);
+
+        GLuint clusters = glGetUniformBlockIndex(program, "ClusterData");
+        if (clusters != GL_INVALID_INDEX) glUniformBlockBinding(program, clusters, kClusterBlockBinding);
+    }
+
+} // namespace game
@@ -1,5 +1,9 @@
 #include "game/Game.h"
+#include <cstdio>
+#include <exception>
 
 int main(){
-    game::Game g; g.Run(); return 0;
+    try { game::Game g; g.Run(); }
+    catch (const std::exception& e) { std::fprintf(stderr, "Fatal: %s\n", e.what()); return 1; }
+    return 0;
 }
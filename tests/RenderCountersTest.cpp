@@ -0,0 +1,181 @@
+// Headless render counter test: the render queue, the UI batch, the perf HUD, particles and
+// lightning run on a RecordingRenderDevice for a number of frames, and the draw/state/upload
+// counters they produce are checked. No window or GL context is created, so this runs on any
+// CI machine. Game::render itself is not covered: it needs a window, and its render targets
+// are still (re)allocated with raw GL (see RenderDevice.h).
+#include "game/RecordingRenderDevice.h"
+#include "game/GLState.h"
+#include "game/RenderQueue.h"
+#include "game/UIRenderer.h"
+#include "game/PerfHud.h"
+#include "game/MeshUtils.h"
+#include "game/ParticleSystem.h"
+#include "game/LightningSystem.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+
+using namespace game;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        long long a_ = (long long)(actual), e_ = (long long)(expected); \
+        if (a_ != e_) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s == %s (%lld vs %lld)\n", \
+                __FILE__, __LINE__, #actual, #expected, a_, e_); \
+            failures++; \
+        } \
+    } while (0)
+
+static const int kFrames = 8;
+static const int kBoxes = 200;          // opaque, textured, alternating between two array layers
+static const int kSpheres = 50;         // opaque, untextured
+static const int kOverlayBoxes = 10;    // overlay pass, untextured
+static const GLuint kTextureArray = 1000;
+static const int kParticles = 30;       // one explosion; every particle outlives the run
+static const float kFrameSeconds = 1.0f / 60.0f;
+
+static void printCounters(int frame, const RecordingRenderDevice::Counters& c) {
+    std::printf("  frame %d: %d draws, %zu instances, %zu vertices, %d state changes, %d uniforms, "
+        "%zu bytes uploaded, %d buffer allocations\n", frame, c.drawCalls, c.instances, c.vertices,
+        c.stateChanges, c.uniformCalls, c.uploadedBytes, c.bufferAllocations);
+}
+
+int main() {
+    RecordingRenderDevice device;
+    setRenderDevice(&device);
+    glState().Invalidate();
+
+    Mesh box = uploadMesh(buildBox());
+    Mesh sphere = uploadMesh(buildSphere(16, 8));
+    InstanceBuffer instances;
+    RenderQueue queue(instances);
+    UIRenderer ui;
+    ui.InitHeadless(1280, 720);
+    PerfHud hud;
+    hud.Toggle();
+    ParticleSystem particles;
+    particles.InitHeadless();
+    particles.CreateExplosion(glm::vec3(0.0f, 1.0f, -5.0f), glm::vec4(1.0f, 0.8f, 0.2f, 1.0f), kParticles);
+    LightningSystem lightning;
+    lightning.InitHeadless();
+    lightning.TriggerLightning(glm::vec3(0.0f, 10.0f, -5.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+    const glm::mat4 view(1.0f);
+    const glm::mat4 proj = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+    // Names only, nothing is compiled
+    SceneProgram program;
+    program.program = 900;
+    program.posScale = 0;
+    program.posOffset = 1;
+    program.octNormals = 2;
+
+    RecordingRenderDevice::Counters steady;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        device.BeginFrame();
+        size_t allocationsBefore = heapAllocationCount();
+        hud.BeginFrame();
+        FrameStats stats;
+
+        // Submitted interleaved, so only the sort brings each batch together
+        queue.Clear();
+        for (int i = 0; i < kBoxes; ++i) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, -5.0f));
+            queue.Submit(RenderPass::Opaque, program, SurfaceTexture{ kTextureArray, i % 2 }, box, 0,
+                0, model, glm::vec4(1.0f, 1.0f, 1.0f, 0.0f), 5.0f + (float)(i % 7));
+            if (i < kSpheres) {
+                queue.Submit(RenderPass::Opaque, program, SurfaceTexture{}, sphere, 0,
+                    1, model, glm::vec4(0.8f, 0.2f, 0.2f, 0.0f), 3.0f + (float)(i % 5));
+            }
+            if (i < kOverlayBoxes) {
+                queue.Submit(RenderPass::Overlay, program, SurfaceTexture{}, box, 0,
+                    0, model, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f), 1.0f);
+            }
+        }
+        queue.Sort();
+        queue.Execute(stats);
+
+        ui.BeginUI();
+        hud.Render(ui, 10.0f, 10.0f);
+        ui.EndUI();
+        hud.EndFrame(16.0, stats, 0, 0);
+
+        const RecordingRenderDevice::Counters& c = device.FrameCounters();
+        const size_t sceneInstances = kBoxes + kSpheres + kOverlayBoxes;
+        if (frame == 0 || frame == kFrames - 1) printCounters(frame, c);
+
+        // One instanced draw per (pass, texture array, mesh) run, plus one for the whole UI
+        CHECK_EQ(stats.drawCalls, 3);
+        CHECK_EQ(stats.programBinds, 1);
+        CHECK_EQ(stats.textureBinds, 1);
+        CHECK_EQ(stats.vaoBinds, 3);
+        CHECK(ui.QuadsThisPass() > 0);
+        CHECK_EQ(c.drawCalls, 4);
+        CHECK_EQ(c.instances, sceneInstances + 1);
+        CHECK_EQ(device.Count(RenderOp::DrawElementsInstanced), 3);
+        CHECK_EQ(c.vertices, (size_t)(kBoxes + kOverlayBoxes) * box.indexCount +
+            (size_t)kSpheres * sphere.indexCount + (size_t)ui.QuadsThisPass() * 6);
+
+        // Instances go up once per Sort; the UI streams its quads (x, y, rgba8) once per flush.
+        // Each is one orphaning BufferData and one BufferSubData.
+        size_t uiBytes = (size_t)ui.QuadsThisPass() * 4 * (2 * sizeof(float) + 4);
+        CHECK_EQ(c.uploadedBytes, sceneInstances * sizeof(InstanceData) + uiBytes);
+        CHECK_EQ(c.bufferAllocations, 2);
+        CHECK_EQ(device.Count(RenderOp::BufferSubData), 2);
+
+        // Nothing is created per frame
+        CHECK_EQ(device.Count(RenderOp::GenBuffer) + device.Count(RenderOp::GenVertexArray), 0);
+
+        // The first frame attaches the instance attributes to each VAO and finds the GL state
+        // unknown; after that every frame issues the same calls and allocates nothing
+        if (frame == 1) {
+            steady = c;
+        }
+        else if (frame > 1) {
+            CHECK_EQ(c.stateChanges, steady.stateChanges);
+            CHECK_EQ(c.uniformCalls, steady.uniformCalls);
+            CHECK_EQ(device.Count(RenderOp::EnableVertexAttrib), 0);
+            CHECK_EQ(heapAllocationCount() - allocationsBefore, 0);
+        }
+
+        // Particles: one point draw of every live particle (x, y, z, rgba, size), uploaded whole.
+        // Lightning: one line strip per bolt, each uploaded on its own.
+        RecordingRenderDevice::Counters before = device.FrameCounters();
+        CHECK_EQ(particles.AliveCount(), kParticles);
+        CHECK_EQ(lightning.BoltCount(), 1);
+        particles.Render(view, proj, glm::vec3(0.0f));
+        const RecordingRenderDevice::Counters& afterParticles = device.FrameCounters();
+        CHECK_EQ(afterParticles.drawCalls - before.drawCalls, 1);
+        CHECK_EQ(afterParticles.vertices - before.vertices, kParticles);
+        CHECK_EQ(afterParticles.uploadedBytes - before.uploadedBytes, kParticles * 8 * sizeof(float));
+        CHECK_EQ(afterParticles.uniformCalls - before.uniformCalls, 3);
+
+        before = device.FrameCounters();
+        lightning.Render(view, proj);
+        const RecordingRenderDevice::Counters& afterLightning = device.FrameCounters();
+        CHECK_EQ(afterLightning.drawCalls - before.drawCalls, lightning.BoltCount());
+        CHECK_EQ(afterLightning.bufferAllocations - before.bufferAllocations, lightning.BoltCount());
+        CHECK_EQ(afterLightning.uploadedBytes - before.uploadedBytes,
+            (afterLightning.vertices - before.vertices) * 3 * sizeof(float));
+        CHECK_EQ(device.Count(RenderOp::DrawArrays), 1 + lightning.BoltCount());
+
+        particles.Update(kFrameSeconds);
+        lightning.Update(kFrameSeconds);
+    }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("render counters: %d frames ok\n", kFrames);
+    return 0;
+}